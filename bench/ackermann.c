@@ -0,0 +1,11 @@
+int ack(int m, int n)
+{
+  if (m == 0) return n + 1; else;
+  if (n == 0) return ack(m - 1, 1); else;
+  return ack(m - 1, ack(m, n - 1));
+}
+
+int main()
+{
+  return ack(2, 9) * 100 + ack(3, 4);
+}
@@ -0,0 +1,16 @@
+int alternating(int n)
+{
+  int k = 1, sign = 0 - 1, s = 0;
+  while (k <= n)
+  {
+    s = s + sign * k * k + (0 - k) / 7;
+    sign = 0 - sign;
+    k = k + 1;
+  }
+  return s;
+}
+
+int main()
+{
+  return alternating(99);
+}
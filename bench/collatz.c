@@ -0,0 +1,32 @@
+int steps(int n)
+{
+  int s = 0;
+  while (n != 1)
+  {
+    if (n / 2 * 2 == n) n = n / 2; else n = 3 * n + 1;
+    s = s + 1;
+  }
+  return s;
+}
+
+int longest(int n)
+{
+  int i = 1, best = 0, arg = 0, s;
+  while (i < n)
+  {
+    s = steps(i);
+    if (s > best)
+    {
+      best = s;
+      arg = i;
+    }
+    else;
+    i = i + 1;
+  }
+  return arg * 1000 + best;
+}
+
+int main()
+{
+  return longest(1000);
+}
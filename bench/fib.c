@@ -0,0 +1,22 @@
+int fib(int n)
+{
+  if (n < 2) return n; else return fib(n - 1) + fib(n - 2);
+}
+
+int fib_iter(int n)
+{
+  int a = 0, b = 1, t;
+  while (n > 0)
+  {
+    t = a + b;
+    a = b;
+    b = t;
+    n = n - 1;
+  }
+  return a;
+}
+
+int main()
+{
+  return fib(20) - fib_iter(20) + fib(19) + fib_iter(30);
+}
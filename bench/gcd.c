@@ -0,0 +1,32 @@
+int gcd(int a, int b)
+{
+  int t;
+  while (b != 0)
+  {
+    t = b;
+    b = a - a / b * b;
+    a = t;
+  }
+  return a;
+}
+
+int gcd_sum(int n)
+{
+  int i = 1, j, s = 0;
+  while (i <= n)
+  {
+    j = 1;
+    while (j <= n)
+    {
+      s = s + gcd(i, j);
+      j = j + 1;
+    }
+    i = i + 1;
+  }
+  return s;
+}
+
+int main()
+{
+  return gcd_sum(60);
+}
@@ -0,0 +1,29 @@
+int powmod(int b, int e, int m)
+{
+  int r = 1;
+  b = b - b / m * m;
+  while (e > 0)
+  {
+    if (e - e / 2 * 2 == 1) r = r * b - r * b / m * m; else;
+    b = b * b - b * b / m * m;
+    e = e / 2;
+  }
+  return r;
+}
+
+int checksum(int n, int m)
+{
+  int i = 1, s = 0;
+  while (i <= n)
+  {
+    s = s + powmod(i, i * 7 + 3, m);
+    if (s >= m) s = s - m; else;
+    i = i + 1;
+  }
+  return s;
+}
+
+int main()
+{
+  return checksum(1500, 10007);
+}
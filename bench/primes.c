@@ -0,0 +1,27 @@
+int is_prime(int n)
+{
+  int d = 2;
+  if (n < 2) return 0; else;
+  while (d * d <= n)
+  {
+    if (n / d * d == n) return 0; else;
+    d = d + 1;
+  }
+  return 1;
+}
+
+int count_primes(int n)
+{
+  int i = 2, c = 0;
+  while (i < n)
+  {
+    c = c + is_prime(i);
+    i = i + 1;
+  }
+  return c;
+}
+
+int main()
+{
+  return count_primes(5000);
+}
@@ -0,0 +1,29 @@
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include "ast.h"
+
+typedef struct CallGraph CallGraph;
+
+/* call graph of the program, methods in program order */
+struct CallGraph {
+  size_t n_methods;
+  ASTNode **methods;
+  char *calls;     // calls[i * n + j]: method i calls method j
+  char *reaches;   // transitive closure of calls
+  size_t *order;   // callees before callers
+};
+
+/* build the call graph of the program, NULL on error. It refers to the
+   methods of root and is stale as soon as a call or method changes */
+CallGraph *callgraph_new(const ASTNode *root);
+
+/* index of the method in program order, -1 if there is none */
+long callgraph_find(const CallGraph *g, const char *name);
+
+/* method i calls method j, directly or not */
+int callgraph_reaches(const CallGraph *g, size_t i, size_t j);
+
+void callgraph_free(CallGraph *g);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include "inst.h"
+
+#include <stdio.h>
+
+/* split each method into basic blocks, make jumps skip blocks that are
+   empty or only jump on, remove the blocks never reached and lay the
+   others out so that the jumps to the next block can be removed */
+int cfg_optimize(InstList *l);
+
+/* print how many jumps, NOPs and blocks each transformation removed */
+void cfg_print_stats(FILE *f);
+
+#endif
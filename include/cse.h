@@ -0,0 +1,12 @@
+#ifndef CSE_H
+#define CSE_H
+
+#include "ast.h"
+
+/* value-number the expressions of each run of straight-line statements
+   and compute repeated ones only once: a value still held by a variable
+   is read from it, others are assigned to a new local before the first
+   statement that needs them */
+int cse_ast(ASTNode *root);
+
+#endif
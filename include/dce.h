@@ -0,0 +1,19 @@
+#ifndef DCE_H
+#define DCE_H
+
+#include "ast.h"
+#include "callgraph.h"
+
+#include <stdio.h>
+
+/* remove the methods main never reaches, the statements after a return
+   or break, the assignments whose value is never read and the locals
+   left unused */
+int dce_ast(ASTNode *root, const CallGraph *g);
+
+/* print what was removed from each method */
+void dce_print_report(FILE *f);
+
+void dce_free(void);
+
+#endif
@@ -1,17 +1,48 @@
 #ifndef EMIT_H
 #define EMIT_H
 
+#include "inst.h"
+
 #include <stdio.h>
 
+#ifndef ASCII
+#define ASCII 0
+#endif
+
+#if ASCII
+#define SYMB_ASSIGN "<-"
+#define SYMB_EQUIV ":="
+#else
+#define SYMB_ASSIGN "←"
+#define SYMB_EQUIV "≡"
+#endif
+
 extern FILE *mixout;
 
+// instructions generated so far, written out by emit_flush
+extern InstList mixcode;
+
+/* source location attached to subsequently emitted instructions */
+YYLTYPE emit_get_loc(void);
+void emit_set_loc(YYLTYPE loc);
+
+/* method attached to subsequently emitted instructions, NULL outside
+   methods; the name is not copied and must outlive emit_flush */
+void emit_set_method(const char *name);
+
 int emit_line(const char *fmt, ...);
 int emit_comment(const char *fmt, ...);
 int emit_label(const char *label);
+int emit_label_next(const char *label);
 
 int emit_inst(const char *label,
               const char *opcode,
               const char *address,
+              int index,
+              const char *field,
               const char *comment);
 
+/* write the generated code to mixout and clear the list */
+int emit_flush(void);
+
 #endif
@@ -0,0 +1,18 @@
+#ifndef EVAL_H
+#define EVAL_H
+
+#include "ast.h"
+
+/* run a method of the program on the given arguments with an AST
+   interpreter, on MIX words, evaluating at most `budget` nodes.
+   Returns 0 with the result, 1 if the run did not finish (budget
+   exhausted, division by zero, uninitialized local read, no value
+   returned) and -1 on error */
+int eval_call(const ASTNode *root, const char *name, const long long *args,
+              size_t n_args, unsigned long budget, long long *result);
+
+/* replace each call whose arguments are constants by the value the
+   method returns, when the interpreter computes it within the budget */
+int eval_ast(ASTNode *root);
+
+#endif
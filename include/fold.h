@@ -0,0 +1,10 @@
+#ifndef FOLD_H
+#define FOLD_H
+
+#include "ast.h"
+
+/* fold constant expressions, simplify algebraic identities and
+   prune if/while statements with constant conditions, in place */
+int fold_ast(ASTNode *root);
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "ast.h"
 #include "table.h"
+#include "inst.h"
 
 #define REG_SP 6
 #define REG_FP 5
@@ -16,6 +17,21 @@
 #define LD(reg)  "LD"  XSTR(reg)
 #define ST(reg)  "ST"  XSTR(reg)
 
+/* operands of register machine operations */
+enum OperandKind {
+  OPERAND_VAR,  // variable in the current frame
+  OPERAND_NUM,  // literal constant
+  OPERAND_STACK // spilled value on top of the stack
+};
+
+typedef struct {
+  enum OperandKind kind;
+  const char *name; // variable name (OPERAND_VAR)
+  int value;        // frame offset (OPERAND_VAR) or literal value (OPERAND_NUM)
+  int reg;          // index register holding the variable, 0 if in memory (OPERAND_VAR)
+  int reg_home;     // the frame word of a variable in a register is up to date
+} Operand;
+
 /* generate assembly from AST */
 int gen_mixal_from_ast(const ASTNode *root, const HashTable *gt);
 
@@ -23,21 +39,29 @@ int gen_mixal_from_ast(const ASTNode *root, const HashTable *gt);
 int gen_program_prologue(const char *entry_label, const char *main_label, unsigned int origin);
 int gen_program_epilogue(const char *entry_label);
 
+/* fail if the final code, after every pass, would run into the output buffer */
+int gen_check_code_size(const InstList *l);
+
 /* subroutine operations */
-int gen_method_entry(const char *method_name, const char *label, unsigned int n_locals);
+int gen_method_entry(const char *method_name, const char *label,
+                     unsigned int n_locals, unsigned int n_temps);
 int gen_method_exit(const char *method_name, unsigned int n_params);
 int gen_method_return();
-int gen_method_call(const char *method_name, const char *label);
+int gen_method_call(const char *method_name, const char *label, unsigned int n_params);
+int gen_tail_call(const char *method_name, const char *l_restart);
 
 /* branch operations */
 int gen_branch_label(const char *l_label);          // initialize branch label
 int gen_branch_entry(const char *l_break);          // set jump on condition fail
+int gen_branch_cmp(enum OpKind op, const char *l_break);  // jump unless A op B
+int gen_branch_zero(enum OpKind op, const char *l_break); // jump unless A op 0
 int gen_branch_jmp(const char *l_branch);           // set jump to branch continue
 int gen_branch_break(const char *l_done);           // set jump to loop break
+int gen_branch_negate(const char *l_true);          // last jump taken when the condition holds
 
 /* stack insertion, deletion operations */
-int gen_push_var(const char *var_name, int offset); // push variable to stack
-int gen_pop_var(const char *var_name, int offset);  // pop variable from stack
+int gen_push_var(const char *var_name, int offset, int reg); // push variable to stack
+int gen_pop_var(const char *var_name, int offset, int reg);  // pop variable from stack
 int gen_push_num(int value);                        // push number to stack
 
 /* numerical and logical operations */
@@ -46,6 +70,8 @@ int gen_binop_add(); // binary (+) operation
 int gen_binop_sub(); // binary (-) operation
 int gen_binop_mul(); // binary (*) operation
 int gen_binop_div(); // binary (/) operation
+int gen_binop_mul_const(int value); // binary (*) operation by a constant
+int gen_binop_div_const(int value); // binary (/) operation by a constant
 int gen_relop_leq(); // relation (<=) operation
 int gen_relop_lt();  // relation (<) operation
 int gen_relop_gt();  // relation (>) operation
@@ -53,4 +79,28 @@ int gen_relop_geq(); // relation (>=) operation
 int gen_relop_eq();  // relation (==) operation
 int gen_relop_neq(); // relation (!=) operation
 
+/* register operations (expression value in rA) */
+int gen_load_operand(const Operand *o);                // rA ← operand
+int gen_load_operand_neg(const Operand *o);            // rA ← -operand
+int gen_store_var(const char *var_name, int offset, int reg); // variable ← rA
+int gen_spill_reg();                                   // push rA to stack
+int gen_reg_unary_neg();                               // rA ← -rA
+int gen_reg_binop(enum OpKind op, const Operand *rhs); // rA ← rA op rhs
+int gen_reg_branch_entry(const char *l_break);         // jump on rA = 0
+int gen_reg_branch_cmp(enum OpKind op, const Operand *rhs,
+                       const char *l_break);            // jump unless rA op rhs
+int gen_reg_branch_zero(enum OpKind op, const char *l_break); // jump unless rA op 0
+
+/* variables held in index registers (reg is the register number) */
+int gen_load_operand_sum(const Operand *o, int value);               // rA ← o + value
+int gen_index_load(const char *var_name, int offset, int reg);       // rIreg ← frame word
+int gen_index_save(const char *var_name, int offset, int reg);       // frame word ← rIreg
+int gen_index_inc(const char *var_name, int reg, int value);         // rIreg ← rIreg + value
+int gen_index_set(const char *var_name, int reg, const Operand *src,
+                  int value);                                         // rIreg ← src + value
+int gen_index_branch_cmp(enum OpKind op, const Operand *lhs, const Operand *rhs,
+                         const char *l_break);                        // jump unless lhs op rhs
+int gen_index_branch_zero(enum OpKind op, const Operand *o,
+                          const char *l_break);                       // jump unless o op 0
+
 #endif
@@ -0,0 +1,12 @@
+#ifndef INLINE_H
+#define INLINE_H
+
+#include "ast.h"
+#include "callgraph.h"
+
+/* replace calls to small non-recursive methods by a copy of their body,
+   whose parameters and locals become locals of the caller. Callees are
+   processed before their callers, so inlined bodies are already inlined */
+int inline_ast(ASTNode *root, const CallGraph *g);
+
+#endif
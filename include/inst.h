@@ -0,0 +1,68 @@
+#ifndef INST_H
+#define INST_H
+
+#include "parser.tab.h"
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define INST_LABEL_LEN 10
+#define INST_OPCODE_LEN 4
+#define INST_ADDRESS_LEN 32
+#define INST_FIELD_LEN 8
+
+typedef struct MixInst MixInst;
+typedef struct InstList InstList;
+
+enum InstKind {
+  INST_OP,      // MIX instruction or assembler directive
+  INST_COMMENT, // comment line
+  INST_LINE     // verbatim line
+};
+
+struct MixInst {
+  enum InstKind kind;
+
+  char label[INST_LABEL_LEN + 1];
+  char opcode[INST_OPCODE_LEN + 1];
+  char address[INST_ADDRESS_LEN]; // address part: number, symbol, literal or expression
+  int index;                      // index register, 0 for none
+  char field[INST_FIELD_LEN];     // field specification, empty for the default field
+  char *comment;                  // comment text (or line text), may be NULL
+
+  YYLTYPE loc;                    // location of the AST node that generated it
+  const char *method;             // name of the method it belongs to, NULL outside methods
+
+  MixInst *prev;
+  MixInst *next;
+};
+
+struct InstList {
+  MixInst *head;
+  MixInst *tail;
+  size_t n_inst;
+};
+
+MixInst *inst_new(enum InstKind kind, const char *label, const char *opcode,
+                  const char *address, int index, const char *field,
+                  const char *comment, YYLTYPE loc);
+
+void inst_append(InstList *l, MixInst *i);
+void inst_insert_before(InstList *l, MixInst *pos, MixInst *i);
+void inst_remove(InstList *l, MixInst *i);
+
+/* take the instruction out of the list without freeing it */
+void inst_unlink(InstList *l, MixInst *i);
+
+/* true for INST_OP entries with the given opcode */
+int inst_is(const MixInst *i, const char *opcode);
+
+/* format the operand as address,index(field) */
+int inst_operand(const MixInst *i, char *buf, size_t len);
+
+/* print the whole list with a single write, annotate appends
+   @method:line (from method and loc) to the comment of each instruction */
+int inst_list_write(const InstList *l, FILE *f, int annotate);
+void inst_list_free(InstList *l);
+
+#endif
@@ -7,5 +7,8 @@ char *label_method(unsigned int index);
 char *label_loop(unsigned int index);
 char *label_else(unsigned int index);
 char *label_done(unsigned int index);
+char *label_test(unsigned int index);
+char *label_pool(unsigned int index);
+char *label_block(unsigned int index);
 
 #endif
@@ -0,0 +1,12 @@
+#ifndef LICM_H
+#define LICM_H
+
+#include "ast.h"
+
+/* evaluate the subexpressions of a while loop that only depend on
+   variables the loop never assigns once, before the loop, into new
+   locals of the method. Outer loops are processed before inner ones,
+   so an expression is hoisted as far out as it is invariant */
+int licm_ast(ASTNode *root);
+
+#endif
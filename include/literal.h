@@ -0,0 +1,14 @@
+#ifndef LITERAL_H
+#define LITERAL_H
+
+#include "inst.h"
+
+/* load or add the literals that fit the two byte address field as
+   immediate operands: LDA =n= becomes ENTA n, ADD =n= becomes INCA n */
+int literal_immediate(InstList *l);
+
+/* give each distinct literal left one word of a constant pool placed
+   after the data, and address it by the label of that word */
+int literal_pool(InstList *l);
+
+#endif
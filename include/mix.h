@@ -0,0 +1,33 @@
+#ifndef MIX_H
+#define MIX_H
+
+#define MIX_MEMORY_SIZE 4000
+#define MIX_WORD_BYTES 5
+#define MIX_INDEX_BYTES 2
+
+#ifndef MIX_BYTE_SIZE
+#define MIX_BYTE_SIZE 64
+#endif
+
+/* pseudo operations (EQU, ORIG, CON, ALF, END) have no machine code */
+#define MIX_PSEUDO 0xff
+
+typedef struct {
+  const char *name;
+  unsigned char code;  // operation code C
+  unsigned char field; // default field specification F
+  unsigned char time;  // execution time in units (u)
+} MixOpcode;
+
+/* reduce a value to a MIX word: the magnitude wraps modulo
+   MIX_BYTE_SIZE^5 like rA after an overflow, the sign is kept */
+long long mix_word_wrap(long long value);
+
+const MixOpcode *mix_opcode_find(const char *name);
+
+/* operation of an assembled instruction, NULL if the code is invalid */
+const MixOpcode *mix_opcode_decode(unsigned int code, unsigned int field);
+
+unsigned int mix_opcode_time(const MixOpcode *op, unsigned int field);
+
+#endif
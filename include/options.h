@@ -0,0 +1,50 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#define OPT_LEVEL_MAX 2
+
+struct Options {
+  int opt_level;      // -O<n>, selects the default for every flag below
+  int opt_size;       // -Os: -O2 without the flags that make code larger
+
+  int fold_constants; // fold constant expressions and prune constant branches
+  int fuse_compare;   // branch on the comparison indicator in if/while conditions
+  int register_expr;  // evaluate expressions in rA/rX instead of on the stack
+  int static_frame;   // address expression temporaries at fixed offsets from FP
+  int eval_calls;     // replace calls with constant arguments by their value
+  int eval_limit;     // AST nodes the interpreter evaluates per call (-feval-limit=<n>)
+  int inline_methods; // inline calls to small non-recursive methods
+  int inline_limit;   // largest inlined body, in AST nodes (-finline-limit=<n>)
+  int inline_growth;  // most a method grows by inlining, in % (-finline-growth=<n>)
+  int inline_unit_growth; // most the program grows by inlining, in % (-finline-unit-growth=<n>)
+  int tail_calls;     // turn self tail calls and accumulator recursion into loops
+  int tail_calls_report; // print the methods converted to loops
+  int sccp;           // propagate constants and copies through the SSA form of methods
+  int licm;           // evaluate loop-invariant expressions once, before the loop
+  int loop_rotate;    // test the condition of while loops after the body
+  int cse;            // compute repeated expressions of straight-line code once
+  int dce;            // remove unreachable methods and statements, dead stores
+  int dce_report;     // print what dead code elimination removed
+  int strength_reduce; // replace MUL/DIV by a constant with cheaper instructions
+  int immediate;      // use small constants as immediate operands (ENTA, INCA, ...)
+  int literal_pool;   // share one word per distinct literal in a constant pool
+  int register_alloc; // keep locals and parameters in the index registers rI1-rI4
+  int register_alloc_report; // print where each variable was allocated
+  int peephole;       // run the peephole optimizer over the generated code
+  int peephole_stats; // print what each peephole rule removed
+  int cfg;            // thread jumps and lay out the basic blocks of each method
+  int cfg_stats;      // print what the control flow optimizations removed
+  int iterate;        // run the cleanup passes again while they change the program
+  int pass_stats;     // print what each pass removed and how long it took
+  int profile;        // annotate each instruction with its method and source line
+};
+
+extern struct Options options;
+
+/* parse a single command line flag, returns -1 if unknown */
+int options_parse_flag(const char *flag);
+
+/* give every flag not set explicitly its default for the -O level */
+void options_finalize(void);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef PASS_H
+#define PASS_H
+
+#include "ast.h"
+#include "table.h"
+#include "callgraph.h"
+#include "inst.h"
+
+#include <stdio.h>
+
+typedef struct PassManager PassManager;
+
+/* analyses shared by the passes, computed when a pass requires them and
+   kept until a pass that does not preserve them changes the program */
+enum Analysis {
+  ANALYSIS_SYMBOLS    = 1 << 0, // function table built by ht_from_ast
+  ANALYSIS_CALL_GRAPH = 1 << 1  // calls between the methods
+};
+
+struct PassManager {
+  ASTNode *root;
+  InstList *code;
+
+  HashTable *symbols;
+  CallGraph *call_graph;
+  unsigned int valid; // analyses up to date with root
+};
+
+/* start from the program and its function table, which stays owned by
+   the pass manager (and may be rebuilt) from now on */
+void pass_manager_init(PassManager *pm, ASTNode *root, HashTable *symbols, InstList *code);
+
+/* run the AST passes enabled by the options, generate code and run the
+   enabled passes over the instructions */
+int pass_run_pipeline(PassManager *pm);
+
+/* print what each pass removed and how long it ran; only the passes over
+   the instructions report the cycles they removed */
+void pass_print_stats(FILE *f);
+
+/* free the analyses and what the passes kept for their reports */
+void pass_manager_free(PassManager *pm);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include "inst.h"
+
+#include <stdio.h>
+
+/* rewrite the instruction list with the peephole rules until none applies */
+int peephole_optimize(InstList *l);
+
+/* print how many instructions and cycles each rule removed */
+void peephole_print_stats(FILE *f);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef REGALLOC_H
+#define REGALLOC_H
+
+#include "ast.h"
+#include "table.h"
+
+#include <stdio.h>
+
+/* keep the most used locals and parameters of each method in the index
+   registers rI1-rI4, when a range analysis proves that every value they
+   take fits in two bytes. Variables whose live ranges do not overlap
+   share a register. Sets the register of the symbols in the tables of gt */
+int regalloc_ast(const ASTNode *root, HashTable *gt);
+
+/* variables in index registers that the callee may overwrite and that
+   are live across the call, to be saved to their frame word around it */
+const char *const *regalloc_call_saves(const ASTNode *call, size_t *n_saves);
+
+/* e is v + c, c + v or v - c, with v a variable and c small enough for the
+   address of an index register instruction: gives v and the signed c */
+int regalloc_index_sum(const ASTNode *e, const char **name, int *value);
+
+/* print where the variables of each method were allocated */
+void regalloc_print_report(FILE *f);
+
+void regalloc_free(void);
+
+#endif
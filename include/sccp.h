@@ -0,0 +1,14 @@
+#ifndef SCCP_H
+#define SCCP_H
+
+#include "ast.h"
+
+/* put each method in SSA form (φ-nodes where the branches of an if and
+   the iterations of a while join) and run sparse conditional constant
+   propagation over it: reads of a variable known to hold a constant
+   become the constant, reads of a copy still held by the variable it
+   was copied from read that variable, and the branches left with
+   constant conditions are pruned */
+int sccp_ast(ASTNode *root);
+
+#endif
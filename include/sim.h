@@ -0,0 +1,115 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "mix.h"
+
+#if MIX_BYTE_SIZE != 64
+#error "the simulator models a binary MIX, with 6-bit bytes"
+#endif
+
+/* a MIX word (byte size 64): sign in bit 30, five 6-bit bytes below */
+typedef uint32_t MixWord;
+
+#define WORD_SIGN ((MixWord)1 << 30)
+#define WORD_MAG  (WORD_SIGN - 1)
+#define INDEX_MAG ((MixWord)(1 << 12) - 1)
+
+#define SIM_OUTPUT_LEN 4096
+
+#define SIM_METHODS_MAX 256
+#define SIM_METHOD_LEN 31
+
+enum SimStatus { SIM_HALTED, SIM_ERROR, SIM_STEP_LIMIT };
+
+typedef struct {
+  MixWord mem[MIX_MEMORY_SIZE];
+  unsigned char loaded[MIX_MEMORY_SIZE]; // word assembled from the program
+  int line[MIX_MEMORY_SIZE];             // source line of each word
+  unsigned int start;                    // address given by END
+  unsigned int code_size;                // number of assembled words
+
+  // @method:line annotations of compiler -fprofile
+  int src_line[MIX_MEMORY_SIZE];         // C source line of each word, 0 if none
+  int method[MIX_MEMORY_SIZE];           // method of each word, -1 if none
+  char methods[SIM_METHODS_MAX][SIM_METHOD_LEN + 1];
+  unsigned int method_entry[SIM_METHODS_MAX]; // first word of each method
+  unsigned int n_methods;
+} MixProgram;
+
+typedef struct SimProfile SimProfile;
+
+/* a memory word translated by the threaded interpreter of sim_run: the
+   handler executing it and its decoded fields, or those of a pair of
+   words executed as one superinstruction */
+typedef struct {
+  const void *handler; // NULL until decoded, and again after a store into the words
+  MixWord *reg;        // register the operation reads or writes
+  int a, b;            // address fields of the first and second word, signed
+  MixWord w;           // register contents set by ENTr, ENNr without index
+  unsigned char i, l, r;
+  unsigned char negative; // sign of the first word
+  unsigned char cond;     // jump conditions, a bit for each of <, =, >
+  unsigned char ticks;    // cycles, of both words for a superinstruction
+} SimDecoded;
+
+typedef struct {
+  MixWord mem[MIX_MEMORY_SIZE];
+  MixWord rA, rX, rJ;
+  MixWord rI[7];       // rI1 to rI6, index 0 unused
+  int ci;              // comparison indicator: -1 (L), 0 (E), +1 (G)
+  int overflow;
+  unsigned long long overflows; // times the overflow toggle was turned on
+  unsigned int pc;
+
+  const MixProgram *prog;
+
+  enum SimStatus status;
+  char error[128];
+
+  unsigned long long cycles;
+  unsigned long long instructions;
+  int stack_high_water; // highest address written below the program, -1 if none
+  unsigned int stack_limit;
+
+  char output[SIM_OUTPUT_LEN];
+  size_t output_len;
+
+  SimProfile *profile; // NULL unless profiling, set after sim_load
+  int reference;       // run the plain fetch-decode-execute loop, set after sim_load
+
+  SimDecoded code[MIX_MEMORY_SIZE];
+} MixMachine;
+
+/* assemble MIXAL source into a memory image */
+int sim_assemble(FILE *f, const char *fname, MixProgram *prog);
+
+/* load an assembled program and run it until HLT, an error or max_steps;
+   unless profiling, the words are predecoded and run as threaded code,
+   which counts cycles and reports errors like the plain interpreter */
+void sim_load(MixMachine *m, const MixProgram *prog);
+enum SimStatus sim_run(MixMachine *m, unsigned long long max_steps);
+
+/* value of the integer printed last by the program, if any */
+int sim_result(const MixMachine *m, long long *result);
+
+/* the outcome of a run as a single line of JSON */
+void sim_report(FILE *out, const char *fname, const MixMachine *m);
+void sim_json_string(FILE *out, const char *s);
+
+/* MIX character codes, indexed by code */
+extern const char mix_chars[];
+
+/* word helpers */
+static inline long long word_value(MixWord w) {
+  long long v = w & WORD_MAG;
+  return (w & WORD_SIGN) ? -v : v;
+}
+
+static inline MixWord word_from(int negative, uint64_t mag) {
+  return (negative ? WORD_SIGN : 0) | (MixWord)(mag & WORD_MAG);
+}
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef SIM_BATCH_H
+#define SIM_BATCH_H
+
+#include <stdio.h>
+
+/* run every program of the manifest, one MIXAL file per line with an
+   optional step limit (max_steps if none), on a pool of threads that
+   steal runs from each other; each run has a machine of its own, and
+   its report (see sim_report) is written to out in manifest order.
+   Returns 0 if every program halted, 1 if not and -1 on errors of the
+   manifest itself */
+int sim_batch(FILE *manifest, const char *name, FILE *out, unsigned int threads,
+              unsigned long long max_steps, int reference);
+
+#endif
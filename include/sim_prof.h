@@ -0,0 +1,24 @@
+#ifndef SIM_PROF_H
+#define SIM_PROF_H
+
+#include "sim.h"
+
+#include <stdio.h>
+
+/* profile of a run: execution counts and cycles of each word, and the
+   cycles of each call path, from the method entries and call sites of
+   the @method:line annotations of compiler -fprofile */
+SimProfile *sim_profile_new(const MixProgram *prog);
+void sim_profile_free(SimProfile *p);
+
+/* account the instruction at m->pc, which took ticks and continues at next */
+void sim_profile_step(SimProfile *p, const MixMachine *m, unsigned int next, unsigned int ticks);
+
+/* cycles per method (inclusive and exclusive), per source line and per
+   instruction; mixal (and source, if not NULL) give the text of the lines */
+int sim_profile_report(const SimProfile *p, FILE *out, const char *mixal, const char *source);
+
+/* folded stacks for flame graphs, one call path per line: main;fact;fact 120 */
+int sim_profile_folded(const SimProfile *p, FILE *out);
+
+#endif
@@ -27,6 +27,7 @@ typedef struct {
       enum DataType return_type;
       unsigned int param_count;
       unsigned int local_count;
+      unsigned int temp_count; // stack words for expression temporaries
       HashTable *symbols;
       char *label;
     } method;
@@ -35,6 +36,8 @@ typedef struct {
       enum DataType symbol_type;
       enum SymKind kind;
       int offset; 
+      int reg;    // index register holding the symbol (-fregister-alloc), 0 in memory
+      int reg_home; // the frame word is kept up to date with the register
     } symbol;
   };
 } Payload;
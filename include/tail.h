@@ -0,0 +1,24 @@
+#ifndef TAIL_H
+#define TAIL_H
+
+#include "ast.h"
+
+#include <stdio.h>
+
+/* rewrite methods whose recursive calls are all of the form
+   return x op f(...) (op being + or *) to carry the pending operations
+   in an accumulator, so that every recursive call becomes a tail call */
+int tail_ast(ASTNode *root);
+
+/* return statement whose value is a call to the method itself */
+int tail_is_self_call(const ASTNode *ret, const char *method_name);
+
+/* method with at least one self tail call */
+int tail_has_self_call(const ASTNode *method);
+
+/* print which methods were converted to loops */
+void tail_print_report(FILE *f);
+
+void tail_free(void);
+
+#endif
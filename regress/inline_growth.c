@@ -0,0 +1,46 @@
+int f0(int p0, int p1)
+{
+  int v0 = 14;
+  int v1 = p1;
+  int v2 = -(475);
+  if (v1)
+    if (((10 * (v1 - p1)) > -((v1 > 8))))
+      p0 = p0;
+    else
+      v1 = (19 * 15);
+  else
+    ;
+  return ((20 - 356) - -(965));
+}
+
+int f1(int p0, int p1)
+{
+  int v0 = (p0 * (7 + 12));
+  int v1 = ((p0 + 19) != f0(428, p1));
+  int v2 = (-(v0) + f0(2, v0));
+  int c0 = 0;
+  v0 = ((13 - v1) / 9);
+  if ((11 > (6 * (p0 - 0))))
+    v2 = 743;
+  else
+    ;
+  p0 = f0(14, v1);
+  {
+    c0 = 0;
+    while ((c0 < 3))
+      {
+        return (4 != (0 == v1));
+        c0 = (c0 + 1);
+      }
+  }
+  return ((v2 / 3) + (v0 + v2));
+}
+
+int main()
+{
+  int v0 = true;
+  int v1 = (f0(v0, v0) - (v0 - v0));
+  v0 = 12;
+  v1 = 10;
+  return v0;
+}
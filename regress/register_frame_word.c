@@ -0,0 +1,19 @@
+int f1(int p0, int p1)
+{
+  int v0 = -((p0 * p1));
+  int v1 = ((v0 == p1) + -(8));
+  p1 = ((3 * p1) / 7);
+  if ((p0 <= 0))
+  {
+    return 13;
+  }
+  else
+  {
+    return ((v1 + p1) - f1((p0 - 1), (p1 >= 8)));
+  }
+}
+
+int main()
+{
+  return f1(4, 0 - 678);
+}
@@ -0,0 +1,17 @@
+int f(int n)
+{
+  int s = 0;
+  while (n)
+  {
+    s = s + 1;
+    break;
+  }
+  return s + 5;
+}
+
+int main()
+{
+  int a;
+  a = f(0);
+  return a;
+}
@@ -0,0 +1,135 @@
+#include "callgraph.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+long callgraph_find(const CallGraph *g, const char *name) {
+  for (size_t i = 0 ; i < g->n_methods ; i++) {
+    if (strcmp(g->methods[i]->method.name, name) == 0) return (long)i;
+  }
+
+  return -1;
+}
+
+int callgraph_reaches(const CallGraph *g, size_t i, size_t j) {
+  return g->reaches[i * g->n_methods + j];
+}
+
+/* record the calls made by an expression or statement of method i */
+static void graph_calls(CallGraph *g, size_t i, const ASTNode *n);
+
+static void graph_calls_list(CallGraph *g, size_t i, const ASTList *l) {
+  for ( ; l != NULL ; l = l->list) graph_calls(g, i, l->node);
+}
+
+static void graph_calls(CallGraph *g, size_t i, const ASTNode *n) {
+  long j;
+
+  if (n == NULL) return;
+
+  switch (n->kind) {
+    case N_BODY:
+      graph_calls_list(g, i, n->body.decls);
+      graph_calls_list(g, i, n->body.stmts);
+      break;
+
+    case N_DECL:  graph_calls_list(g, i, n->decl.vars); break;
+    case N_VAR:   graph_calls(g, i, n->var.expr); break;
+    case N_BLOCK: graph_calls_list(g, i, n->block.stmts); break;
+    case N_ASSIGN: graph_calls(g, i, n->assign.rhs); break;
+    case N_RETURN: graph_calls(g, i, n->ret.expr); break;
+
+    case N_IF:
+    case N_WHILE:
+      graph_calls(g, i, n->branch.cond);
+      graph_calls(g, i, n->branch.then_branch);
+      graph_calls(g, i, n->branch.else_branch);
+      break;
+
+    case N_BINOP:
+      graph_calls(g, i, n->binop.lhs);
+      graph_calls(g, i, n->binop.rhs);
+      break;
+
+    case N_UNARY:
+      graph_calls(g, i, n->unary.expr);
+      break;
+
+    case N_CALL:
+      j = callgraph_find(g, n->call.fname);
+      if (j >= 0) g->calls[i * g->n_methods + j] = 1;
+      graph_calls_list(g, i, n->call.args);
+      break;
+
+    default:
+      break;
+  }
+}
+
+static void graph_postorder(CallGraph *g, size_t i, char *visited, size_t *k) {
+  visited[i] = 1;
+
+  for (size_t j = 0 ; j < g->n_methods ; j++) {
+    if (g->calls[i * g->n_methods + j] && !visited[j]) graph_postorder(g, j, visited, k);
+  }
+
+  g->order[(*k)++] = i;
+}
+
+CallGraph *callgraph_new(const ASTNode *root) {
+  if (root == NULL || root->kind != N_PROGRAM) return NULL;
+
+  size_t n = ast_list_size(root->prog.methods);
+  CallGraph *g = calloc(1, sizeof(CallGraph));
+  char *visited = calloc(n + 1, 1);
+
+  if (g != NULL) {
+    g->n_methods = n;
+    g->methods = calloc(n + 1, sizeof(ASTNode *));
+    g->calls = calloc(n * n + 1, 1);
+    g->reaches = calloc(n * n + 1, 1);
+    g->order = calloc(n + 1, sizeof(size_t));
+  }
+
+  if (!g || !g->methods || !g->calls || !g->reaches || !g->order || !visited) {
+    callgraph_free(g);
+    free(visited);
+    return NULL;
+  }
+
+  size_t i = 0;
+  for (const ASTList *l = root->prog.methods ; l != NULL ; l = l->list) {
+    g->methods[i++] = l->node;
+  }
+
+  for (i = 0 ; i < n ; i++) graph_calls(g, i, g->methods[i]->method.body);
+
+  // a method is recursive if it reaches itself
+  memcpy(g->reaches, g->calls, n * n);
+  for (size_t k = 0 ; k < n ; k++) {
+    for (i = 0 ; i < n ; i++) {
+      if (!g->reaches[i * n + k]) continue;
+      for (size_t j = 0 ; j < n ; j++) {
+        if (g->reaches[k * n + j]) g->reaches[i * n + j] = 1;
+      }
+    }
+  }
+
+  size_t k = 0;
+  for (i = 0 ; i < n ; i++) {
+    if (!visited[i]) graph_postorder(g, i, visited, &k);
+  }
+
+  free(visited);
+  return g;
+}
+
+void callgraph_free(CallGraph *g) {
+  if (g == NULL) return;
+
+  free(g->methods);
+  free(g->calls);
+  free(g->reaches);
+  free(g->order);
+  free(g);
+}
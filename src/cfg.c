@@ -0,0 +1,592 @@
+#include "cfg.h"
+#include "label.h"
+#include "mix.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// numbers the labels given to blocks a local label no longer reaches
+static unsigned int block_index = 1;
+
+typedef struct Block Block;
+
+struct Block {
+  InstList insts;                 // instructions of the block, comments included
+  char label[INST_LABEL_LEN + 1]; // label of the first instruction
+  size_t n_ops;                   // instructions other than NOP
+
+  MixInst *jump;                  // jump ending the block, NULL if none
+  Block *target;                  // block the jump lands on, NULL for a return
+  int falls_through;              // control may go on to the next block
+  int threaded;                   // the jump was moved past a block that only jumps
+
+  int reachable;
+  int placed;
+  int targeted;
+  size_t pos;                     // position in the new layout
+};
+
+struct Method {
+  Block *blocks; // in the order of the generated code
+  size_t n;
+  Block **order; // reachable blocks in their new layout
+  size_t n_order;
+};
+
+/* labels of the method entries, a jump to one of them is a call */
+struct Entries {
+  const char **labels;
+  size_t n;
+};
+
+struct CfgStat {
+  const char *name;
+  unsigned long applied;
+  unsigned long insts;  // instructions removed
+  unsigned long cycles; // execution time of the removed instructions
+};
+
+enum { STAT_THREAD, STAT_EMPTY, STAT_UNREACHABLE, STAT_FALLTHROUGH };
+
+static struct CfgStat stats[] = {
+  {"jump-thread", 0, 0, 0},
+  {"empty-block", 0, 0, 0},
+  {"unreachable", 0, 0, 0},
+  {"fallthrough", 0, 0, 0},
+};
+
+#define N_STATS (sizeof(stats) / sizeof(stats[0]))
+
+static void count_removed(int stat, const MixInst *i) {
+  const MixOpcode *op = mix_opcode_find(i->opcode);
+
+  stats[stat].insts += 1;
+  stats[stat].cycles += mix_opcode_time(op, op ? op->field : 0);
+}
+
+static int has_label(const MixInst *i) {
+  return i->label[0] != '\0';
+}
+
+/* JBUS and JRED wait for a device, they are not part of the control flow */
+static int is_jump(const MixInst *i) {
+  return i->kind == INST_OP && i->opcode[0] == 'J'
+      && strcmp(i->opcode, "JBUS") != 0 && strcmp(i->opcode, "JRED") != 0;
+}
+
+static int is_unconditional(const MixInst *i) {
+  return inst_is(i, "JMP") || inst_is(i, "JSJ");
+}
+
+/* local symbol dH, dF or dB */
+static int is_local(const char *s, char kind) {
+  return s[0] >= '0' && s[0] <= '9' && s[1] == kind && s[2] == '\0';
+}
+
+/* every method starts by saving rJ */
+static int is_entry(const MixInst *i) {
+  return inst_is(i, "STJ") && has_label(i);
+}
+
+static int is_call(const MixInst *i, const struct Entries *e) {
+  if (!inst_is(i, "JMP") || i->index != 0) return 0;
+
+  for (size_t k = 0 ; k < e->n ; k++) {
+    if (strcmp(e->labels[k], i->address) == 0) return 1;
+  }
+
+  return 0;
+}
+
+/* a method ends where the next one starts, or at the data */
+static int ends_method(const MixInst *i) {
+  if (i->kind == INST_LINE) return 1;
+  if (i->kind != INST_OP) return 0;
+  if (is_entry(i)) return 1;
+
+  const MixOpcode *op = mix_opcode_find(i->opcode);
+  return op != NULL && op->code == MIX_PSEUDO;
+}
+
+static MixInst *first_op(const Block *b) {
+  MixInst *i = b->insts.head;
+
+  while (i != NULL && i->kind != INST_OP) i = i->next;
+  return i;
+}
+
+static void move_all(InstList *l, MixInst *pos, InstList *from) {
+  while (from->head != NULL) {
+    MixInst *i = from->head;
+
+    inst_unlink(from, i);
+    inst_insert_before(l, pos, i);
+  }
+}
+
+/* move the instructions from start up to end into basic blocks: a block
+   starts at a label and after a jump, comments go with the instruction
+   that follows them */
+static int build_blocks(InstList *l, MixInst *start, MixInst *end,
+                        const struct Entries *e, struct Method *m) {
+  InstList comments = { NULL, NULL, 0 };
+  Block *cur = NULL;
+
+  for (MixInst *i = start, *next ; i != end ; i = next) {
+    next = i->next;
+
+    if (i->kind == INST_OP && (cur == NULL || has_label(i) || cur->jump != NULL)) {
+      Block *blocks = realloc(m->blocks, (m->n + 1) * sizeof(Block));
+      if (blocks == NULL) {
+        inst_list_free(&comments);
+        return -1;
+      }
+
+      m->blocks = blocks;
+      cur = &m->blocks[m->n++];
+      memset(cur, 0, sizeof(Block));
+      strcpy(cur->label, i->label);
+    }
+
+    inst_unlink(l, i);
+
+    if (i->kind != INST_OP) {
+      inst_append(&comments, i);
+      continue;
+    }
+
+    move_all(&cur->insts, NULL, &comments);
+    inst_append(&cur->insts, i);
+
+    if (!inst_is(i, "NOP")) cur->n_ops += 1;
+    if (is_jump(i) && !is_call(i, e)) cur->jump = i;
+  }
+
+  if (cur != NULL) move_all(&cur->insts, NULL, &comments);
+
+  return 0;
+}
+
+/* the block a jump of block k lands on, NULL if it is outside the method */
+static Block *find_target(struct Method *m, size_t k, const char *address) {
+  char label[INST_LABEL_LEN + 1];
+
+  if (!is_local(address, 'F') && !is_local(address, 'B')) {
+    for (size_t t = 0 ; t < m->n ; t++) {
+      if (strcmp(m->blocks[t].label, address) == 0) return &m->blocks[t];
+    }
+    return NULL;
+  }
+
+  snprintf(label, sizeof(label), "%cH", address[0]);
+
+  if (address[1] == 'F') {
+    for (size_t t = k + 1 ; t < m->n ; t++) {
+      if (strcmp(m->blocks[t].label, label) == 0) return &m->blocks[t];
+    }
+    return NULL;
+  }
+
+  // dB finds the label of the block itself, unless the jump carries it
+  Block *b = &m->blocks[k];
+  if (strcmp(b->label, label) == 0 && first_op(b) != b->jump) return b;
+
+  for (size_t t = k ; t-- > 0 ; ) {
+    if (strcmp(m->blocks[t].label, label) == 0) return &m->blocks[t];
+  }
+  return NULL;
+}
+
+/* the edges of each block, 1 if a jump cannot be followed */
+static int resolve_jumps(struct Method *m) {
+  for (size_t k = 0 ; k < m->n ; k++) {
+    Block *b = &m->blocks[k];
+    MixInst *j = b->jump;
+
+    b->falls_through = (j == NULL || !is_unconditional(j));
+    if (j == NULL) continue;
+
+    if (j->field[0]) return 1;
+
+    if (j->index != 0) {
+      // JMP 0,4 returns to the caller
+      if (is_unconditional(j)) continue;
+      return 1;
+    }
+
+    b->target = find_target(m, k, j->address);
+    if (b->target == NULL) return 1;
+  }
+
+  // control must not run off the end of the method
+  for (size_t k = m->n ; k-- > 0 ; ) {
+    if (m->blocks[k].n_ops > 0) return m->blocks[k].falls_through;
+  }
+
+  return 0;
+}
+
+/* first block from b that executes an instruction */
+static Block *skip_empty(struct Method *m, Block *b) {
+  while (b != NULL && b->n_ops == 0) {
+    b = (b + 1 < m->blocks + m->n) ? b + 1 : NULL;
+  }
+
+  return b;
+}
+
+static int only_jumps(const Block *b) {
+  return b->n_ops == 1 && b->jump != NULL && is_unconditional(b->jump) && b->target != NULL;
+}
+
+/* the block a jump to b ends up executing first */
+static Block *thread(struct Method *m, Block *b, int *threaded) {
+  b = skip_empty(m, b);
+
+  // blocks that jump to each other forever: any of them will do
+  for (size_t steps = 0 ; b != NULL && only_jumps(b) && steps < m->n ; steps++) {
+    b = skip_empty(m, b->target);
+    *threaded = 1;
+  }
+
+  return b;
+}
+
+static int thread_jumps(struct Method *m) {
+  for (size_t k = 0 ; k < m->n ; k++) {
+    Block *b = &m->blocks[k];
+
+    if (b->target == NULL) continue;
+
+    b->target = thread(m, b->target, &b->threaded);
+    if (b->target == NULL) return 1;
+  }
+
+  return 0;
+}
+
+static int mark_reachable(struct Method *m) {
+  Block **stack = malloc(m->n * sizeof(Block *));
+  size_t top = 0;
+
+  if (stack == NULL) return -1;
+
+  m->blocks[0].reachable = 1;
+  stack[top++] = &m->blocks[0];
+
+  while (top > 0) {
+    Block *b = stack[--top];
+    Block *succ[2] = { NULL, b->target };
+
+    if (b->falls_through && b + 1 < m->blocks + m->n) succ[0] = b + 1;
+
+    for (size_t s = 0 ; s < 2 ; s++) {
+      if (succ[s] == NULL || succ[s]->reachable) continue;
+
+      succ[s]->reachable = 1;
+      stack[top++] = succ[s];
+    }
+  }
+
+  free(stack);
+  return 0;
+}
+
+/* first block of a chain of blocks falling through to each other */
+static int is_head(const struct Method *m, const Block *b) {
+  return b == m->blocks || !b[-1].reachable || !b[-1].falls_through;
+}
+
+/* lay out the chain starting at b, returns its last block */
+static Block *place_chain(struct Method *m, Block *b) {
+  for ( ; ; b++) {
+    b->placed = 1;
+    b->pos = m->n_order;
+    m->order[m->n_order++] = b;
+
+    if (!b->falls_through || b + 1 == m->blocks + m->n) return b;
+  }
+}
+
+/* chains keep their order, except that a chain ending with a JMP is
+   followed by the chain the JMP lands on, if it starts there */
+static int layout(struct Method *m) {
+  Block *last = NULL;
+  size_t next = 0;
+
+  m->order = malloc(m->n * sizeof(Block *));
+  if (m->order == NULL) return -1;
+
+  for (;;) {
+    Block *head = NULL;
+
+    if (last != NULL && last->jump != NULL && is_unconditional(last->jump)
+        && last->target != NULL) {
+      Block *t = last->target;
+
+      while (!is_head(m, t) && t[-1].n_ops == 0) t--;
+      if (is_head(m, t) && !t->placed) head = t;
+    }
+
+    if (head == NULL) {
+      while (next < m->n && (m->blocks[next].placed || !m->blocks[next].reachable
+                             || !is_head(m, &m->blocks[next]))) next++;
+      if (next == m->n) return 0;
+
+      head = &m->blocks[next];
+    }
+
+    last = place_chain(m, head);
+  }
+}
+
+/* jumps to the block laid out next. From the end, so that a block left
+   empty by the removal is skipped by the jumps before it */
+static void remove_jumps_to_next(struct Method *m) {
+  for (size_t k = m->n_order ; k-- > 0 ; ) {
+    Block *b = m->order[k];
+    Block *next = NULL;
+
+    if (b->jump == NULL || b->target == NULL) continue;
+
+    for (size_t t = k + 1 ; t < m->n_order && next == NULL ; t++) {
+      if (m->order[t]->n_ops > 0) next = m->order[t];
+    }
+    if (b->target != next) continue;
+
+    stats[STAT_FALLTHROUGH].applied += 1;
+    count_removed(STAT_FALLTHROUGH, b->jump);
+
+    inst_remove(&b->insts, b->jump);
+    b->jump = NULL;
+    b->target = NULL;
+    b->n_ops -= 1;
+    b->falls_through = 1;
+
+    // an empty block has no instruction left to carry its label
+    if (b->n_ops > 0) continue;
+    for (size_t t = 0 ; t < m->n_order ; t++) {
+      if (m->order[t]->target == b) m->order[t]->target = next;
+    }
+  }
+}
+
+static int fresh_label(Block *b) {
+  char *label = label_block(block_index++);
+  if (label == NULL) return -1;
+
+  strcpy(b->label, label);
+  free(label);
+
+  return 0;
+}
+
+/* the local label of t is the nearest one in the direction of the jump */
+static int local_reaches(const struct Method *m, const Block *from, const Block *t) {
+  if (!is_local(t->label, 'H')) return 1;
+
+  if (t->pos > from->pos) {
+    for (size_t p = from->pos + 1 ; p < t->pos ; p++) {
+      if (strcmp(m->order[p]->label, t->label) == 0) return 0;
+    }
+    return 1;
+  }
+
+  if (t == from) return 0;
+
+  for (size_t p = t->pos + 1 ; p <= from->pos ; p++) {
+    if (strcmp(m->order[p]->label, t->label) == 0) return 0;
+  }
+  return 1;
+}
+
+/* only the entry and the blocks still jumped to keep their label */
+static int assign_labels(struct Method *m) {
+  for (size_t k = 0 ; k < m->n_order ; k++) {
+    Block *b = m->order[k];
+    if (b->jump != NULL && b->target != NULL) b->target->targeted = 1;
+  }
+
+  for (size_t k = 0 ; k < m->n_order ; k++) {
+    Block *b = m->order[k];
+    if (b != m->blocks && !b->targeted) b->label[0] = '\0';
+  }
+
+  for (size_t k = 0 ; k < m->n_order ; k++) {
+    Block *b = m->order[k];
+    Block *t = b->target;
+
+    if (b->jump == NULL || t == NULL) continue;
+    if (t->label[0] != '\0' && local_reaches(m, b, t)) continue;
+
+    if (fresh_label(t)) return -1;
+  }
+
+  return 0;
+}
+
+static int ends_with(const char *s, const char *suffix) {
+  size_t n = strlen(s), k = strlen(suffix);
+  return n >= k && strcmp(s + n - k, suffix) == 0;
+}
+
+/* point the jump at the label of its target, updating the comment */
+static int retarget(Block *b) {
+  MixInst *j = b->jump;
+  const Block *t = b->target;
+  char address[INST_ADDRESS_LEN];
+
+  strcpy(address, t->label);
+  if (is_local(address, 'H')) address[1] = (t->pos > b->pos) ? 'F' : 'B';
+
+  if (strcmp(address, j->address) == 0) return 0;
+
+  if (j->comment != NULL && j->address[0] != '\0' && ends_with(j->comment, j->address)) {
+    size_t keep = strlen(j->comment) - strlen(j->address);
+    char *c = malloc(keep + strlen(address) + 1);
+    if (c == NULL) return -1;
+
+    memcpy(c, j->comment, keep);
+    strcpy(c + keep, address);
+
+    free(j->comment);
+    j->comment = c;
+  }
+
+  strcpy(j->address, address);
+  return 0;
+}
+
+/* NOPs only hold labels, which move to the next instruction */
+static void remove_nops(Block *b) {
+  for (MixInst *i = b->insts.head, *next ; i != NULL ; i = next) {
+    next = i->next;
+
+    if (!inst_is(i, "NOP")) continue;
+    // a label on no other instruction keeps its NOP
+    if (b->n_ops == 0 && b->label[0] != '\0' && first_op(b) == i) continue;
+
+    stats[STAT_EMPTY].applied += 1;
+    count_removed(STAT_EMPTY, i);
+    inst_remove(&b->insts, i);
+  }
+
+  MixInst *i = first_op(b);
+  if (i != NULL) strcpy(i->label, b->label);
+}
+
+static void remove_block(Block *b) {
+  stats[STAT_UNREACHABLE].applied += 1;
+
+  for (MixInst *i = b->insts.head ; i != NULL ; i = i->next) {
+    if (i->kind == INST_OP) count_removed(STAT_UNREACHABLE, i);
+  }
+
+  inst_list_free(&b->insts);
+}
+
+static int rewrite(InstList *l, MixInst *end, struct Method *m) {
+  for (size_t k = 0 ; k < m->n_order ; k++) {
+    if (m->order[k]->threaded) stats[STAT_THREAD].applied += 1;
+  }
+
+  remove_jumps_to_next(m);
+  if (assign_labels(m)) return -1;
+
+  for (size_t k = 0 ; k < m->n_order ; k++) {
+    Block *b = m->order[k];
+
+    if (b->jump != NULL && b->target != NULL && retarget(b)) return -1;
+    remove_nops(b);
+    move_all(l, end, &b->insts);
+  }
+
+  for (size_t k = 0 ; k < m->n ; k++) {
+    if (!m->blocks[k].reachable) remove_block(&m->blocks[k]);
+  }
+
+  return 0;
+}
+
+static int cfg_method(InstList *l, MixInst *start, MixInst *end, const struct Entries *e) {
+  struct Method m = { NULL, 0, NULL, 0 };
+  int status = build_blocks(l, start, end, e, &m);
+
+  if (status == 0 && m.n > 0) {
+    status = resolve_jumps(&m);
+    if (status == 0) status = thread_jumps(&m);
+    if (status == 0) status = mark_reachable(&m);
+    if (status == 0) status = layout(&m);
+    if (status == 0) status = rewrite(l, end, &m);
+
+    // a method with a jump that cannot be followed is left as it was
+    if (status == 1) {
+      for (size_t k = 0 ; k < m.n ; k++) move_all(l, end, &m.blocks[k].insts);
+      status = 0;
+    }
+  }
+
+  for (size_t k = 0 ; k < m.n ; k++) inst_list_free(&m.blocks[k].insts);
+  free(m.blocks);
+  free(m.order);
+
+  return status;
+}
+
+int cfg_optimize(InstList *l) {
+  struct Entries e = { NULL, 0 };
+  int status = 0;
+
+  for (MixInst *i = l->head ; i != NULL ; i = i->next) {
+    if (!is_entry(i)) continue;
+
+    const char **labels = realloc(e.labels, (e.n + 1) * sizeof(const char *));
+    if (labels == NULL) {
+      free(e.labels);
+      return -1;
+    }
+
+    e.labels = labels;
+    e.labels[e.n++] = i->label;
+  }
+
+  MixInst *i = l->head;
+  while (i != NULL && status == 0) {
+    if (!is_entry(i)) {
+      i = i->next;
+      continue;
+    }
+
+    // the comments before a method go with it
+    MixInst *start = i;
+    while (start->prev != NULL && start->prev->kind == INST_COMMENT) start = start->prev;
+
+    MixInst *end = i->next;
+    while (end != NULL && !ends_method(end)) end = end->next;
+    if (end != NULL) {
+      while (end->prev != i && end->prev->kind == INST_COMMENT) end = end->prev;
+    }
+
+    status = cfg_method(l, start, end, &e);
+    i = end;
+  }
+
+  free(e.labels);
+  return status;
+}
+
+void cfg_print_stats(FILE *f) {
+  unsigned long applied = 0, insts = 0, cycles = 0;
+
+  fprintf(f, "%-20s %8s %8s %8s\n", "cfg transformation", "applied", "insts", "cycles");
+  for (size_t k = 0 ; k < N_STATS ; k++) {
+    fprintf(f, "%-20s %8lu %8lu %8lu\n",
+            stats[k].name, stats[k].applied, stats[k].insts, stats[k].cycles);
+
+    applied += stats[k].applied;
+    insts += stats[k].insts;
+    cycles += stats[k].cycles;
+  }
+  fprintf(f, "%-20s %8lu %8lu %8lu\n", "total", applied, insts, cycles);
+}
@@ -0,0 +1,538 @@
+#include "cse.h"
+#include "mix.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// numbers the locals holding common subexpressions
+static unsigned int cse_index = 1;
+
+#define HASH_SIZE 256
+#define MAX_ROUNDS 4
+
+/* a new local costs a store and a load (STA and LDA, 2 units each) */
+#define TEMP_COST 4
+
+enum ValueKind { V_VAR, V_NUM, V_UNARY, V_BINOP, V_CALL, V_ARGS };
+
+/* value computed in a block: variable before its first assignment,
+   number, or operation on other values (value numbers a and b) */
+struct Value {
+  enum ValueKind kind;
+  int op;
+  int a, b;
+  const char *name; // variable or called method
+  int next;         // next value in the same hash bucket, -1 for none
+};
+
+/* current value of a variable of the block */
+struct VarValue {
+  const char *name;
+  int vn;
+};
+
+/* expression node of a statement, in preorder */
+struct Occurrence {
+  ASTNode **slot;
+  size_t stmt;        // statement of the block holding it
+  size_t end;         // first occurrence after its subtree
+  int vn;
+  const char *holder; // variable holding the value when the statement starts
+};
+
+/* position of a statement, the new locals are assigned right before it */
+struct Stmt {
+  ASTList **pos;
+  int insert;         // 0 for declarations, that cannot be preceded by statements
+};
+
+struct Block {
+  struct Value *values;
+  size_t n_values;
+  int buckets[HASH_SIZE];
+
+  struct VarValue *vars;
+  size_t n_vars;
+
+  struct Occurrence *occs;
+  size_t n_occs;
+
+  struct Stmt *stmts;
+  size_t n_stmts;
+};
+
+struct Method {
+  ASTList *locals; // N_VARs added to the method
+  int changed;
+};
+
+static unsigned int inst_time(const char *name) {
+  return mix_opcode_time(mix_opcode_find(name), 5);
+}
+
+static unsigned int value_hash(enum ValueKind kind, int op, int a, int b, const char *name) {
+  unsigned int h = (unsigned int)kind * 31u + (unsigned int)op;
+
+  h = h * 131u + (unsigned int)a;
+  h = h * 131u + (unsigned int)b;
+  for ( ; name != NULL && *name != '\0' ; name++) h = h * 33u + (unsigned char)*name;
+
+  return h % HASH_SIZE;
+}
+
+static int same_name(const char *x, const char *y) {
+  return (x == NULL && y == NULL) || (x != NULL && y != NULL && strcmp(x, y) == 0);
+}
+
+/* value number of an operation, the same for equal operations */
+static int value_number(struct Block *b, enum ValueKind kind, int op, int x, int y,
+                        const char *name) {
+  unsigned int h = value_hash(kind, op, x, y, name);
+
+  for (int i = b->buckets[h] ; i >= 0 ; i = b->values[i].next) {
+    const struct Value *v = &b->values[i];
+    if (v->kind == kind && v->op == op && v->a == x && v->b == y && same_name(v->name, name)) {
+      return i;
+    }
+  }
+
+  struct Value *values = realloc(b->values, (b->n_values + 1) * sizeof(struct Value));
+  if (values == NULL) return -1;
+
+  b->values = values;
+  b->values[b->n_values] = (struct Value) {
+    .kind = kind, .op = op, .a = x, .b = y, .name = name, .next = b->buckets[h]
+  };
+  b->buckets[h] = (int)b->n_values;
+
+  return (int)b->n_values++;
+}
+
+static struct VarValue *find_var(struct Block *b, const char *name) {
+  for (size_t i = 0 ; i < b->n_vars ; i++) {
+    if (strcmp(b->vars[i].name, name) == 0) return &b->vars[i];
+  }
+
+  return NULL;
+}
+
+static int var_value(struct Block *b, const char *name) {
+  struct VarValue *v = find_var(b, name);
+  if (v != NULL) return v->vn;
+
+  // the value of a variable on entry to the block is unknown
+  return value_number(b, V_VAR, 0, 0, 0, name);
+}
+
+static int set_var_value(struct Block *b, const char *name, int vn) {
+  struct VarValue *v = find_var(b, name);
+
+  if (v == NULL) {
+    v = realloc(b->vars, (b->n_vars + 1) * sizeof(struct VarValue));
+    if (v == NULL) return -1;
+
+    b->vars = v;
+    v = &b->vars[b->n_vars++];
+    v->name = name;
+  }
+
+  v->vn = vn;
+  return 0;
+}
+
+/* variable holding the value, the first one assigned it */
+static const char *value_holder(const struct Block *b, int vn) {
+  for (size_t i = 0 ; i < b->n_vars ; i++) {
+    if (b->vars[i].vn == vn) return b->vars[i].name;
+  }
+
+  return NULL;
+}
+
+static int add_occurrence(struct Block *b, ASTNode **slot, size_t *index) {
+  struct Occurrence *o = realloc(b->occs, (b->n_occs + 1) * sizeof(struct Occurrence));
+  if (o == NULL) return -1;
+
+  b->occs = o;
+  b->occs[b->n_occs] = (struct Occurrence) {
+    .slot = slot, .stmt = b->n_stmts - 1, .end = 0, .vn = -1, .holder = NULL
+  };
+  *index = b->n_occs++;
+
+  return 0;
+}
+
+static int is_commutative(enum OpKind op) {
+  return op == OP_ADDOP_ADD || op == OP_MULOP_MUL || op == OP_RELOP_EQ || op == OP_RELOP_NEQ;
+}
+
+/* value number of an expression, recording its operations in preorder */
+static int number_expr(struct Block *b, ASTNode **slot) {
+  ASTNode *e = *slot;
+  size_t k = 0;
+  int vn = -1, x, y;
+
+  switch (e->kind) {
+    case N_NUMBER:
+      return value_number(b, V_NUM, 0, e->number.val, 0, NULL);
+
+    case N_IDENTIFIER:
+      return var_value(b, e->identifier.name);
+
+    default:
+      break;
+  }
+
+  if (add_occurrence(b, slot, &k)) return -1;
+
+  switch (e->kind) {
+    case N_UNARY:
+      if ((x = number_expr(b, &e->unary.expr)) < 0) return -1;
+      vn = value_number(b, V_UNARY, e->unary.op, x, 0, NULL);
+      break;
+
+    case N_BINOP:
+      if ((x = number_expr(b, &e->binop.lhs)) < 0) return -1;
+      if ((y = number_expr(b, &e->binop.rhs)) < 0) return -1;
+
+      if (is_commutative(e->binop.op) && x > y) {
+        int t = x;
+        x = y;
+        y = t;
+      }
+      vn = value_number(b, V_BINOP, e->binop.op, x, y, NULL);
+      break;
+
+    case N_CALL:
+      // methods only see their arguments, so equal calls return equal values
+      y = 0;
+      x = value_number(b, V_ARGS, 0, -1, -1, NULL);
+      for (ASTList *l = e->call.args ; l != NULL && x >= 0 ; l = l->list, y++) {
+        int arg = number_expr(b, &l->node);
+        x = (arg < 0) ? -1 : value_number(b, V_ARGS, y, arg, x, NULL);
+      }
+      if (x < 0) return -1;
+      vn = value_number(b, V_CALL, 0, x, 0, e->call.fname);
+      break;
+
+    default:
+      return -1;
+  }
+
+  if (vn < 0) return -1;
+
+  b->occs[k].vn = vn;
+  b->occs[k].holder = value_holder(b, vn);
+  b->occs[k].end = b->n_occs;
+
+  return vn;
+}
+
+static int add_stmt(struct Block *b, ASTList **pos, int insert) {
+  struct Stmt *s = realloc(b->stmts, (b->n_stmts + 1) * sizeof(struct Stmt));
+  if (s == NULL) return -1;
+
+  b->stmts = s;
+  b->stmts[b->n_stmts++] = (struct Stmt) { .pos = pos, .insert = insert };
+
+  return 0;
+}
+
+/* execution time of an expression, by the MIX timing table */
+static unsigned int expr_cost(const ASTNode *e) {
+  unsigned int cost = 0;
+
+  switch (e->kind) {
+    case N_UNARY:
+      return inst_time("LDAN") + expr_cost(e->unary.expr);
+
+    case N_BINOP:
+      switch (e->binop.op) {
+        case OP_MULOP_MUL: cost = inst_time("MUL"); break;
+        case OP_MULOP_DIV: cost = inst_time("DIV") + inst_time("SRAX"); break;
+        default:           cost = inst_time("ADD"); break;
+      }
+      return cost + expr_cost(e->binop.lhs) + expr_cost(e->binop.rhs);
+
+    case N_CALL:
+      // at least the jump, the frame setup and the return
+      cost = inst_time("JMP") + inst_time("ST6") + inst_time("ENT5") + inst_time("LD4")
+             + inst_time("JMP");
+      for (const ASTList *l = e->call.args ; l != NULL ; l = l->list) {
+        cost += inst_time("STA") + expr_cost(l->node);
+      }
+      return cost;
+
+    default:
+      return 0;
+  }
+}
+
+/* variable plus or minus a number: a single ADD/SUB after the load, or
+   INC/DEC on an index register, no faster when read from the variable
+   holding it, whose live range would only get longer */
+static int is_var_offset(const ASTNode *e) {
+  return e->kind == N_BINOP && (e->binop.op == OP_ADDOP_ADD || e->binop.op == OP_ADDOP_SUB)
+         && ((e->binop.lhs->kind == N_IDENTIFIER && e->binop.rhs->kind == N_NUMBER)
+             || (e->binop.lhs->kind == N_NUMBER && e->binop.rhs->kind == N_IDENTIFIER));
+}
+
+/* fresh local for a common subexpression: .cseN */
+static char *fresh_name(void) {
+  char buf[32];
+
+  if (snprintf(buf, sizeof(buf), ".cse%u", cse_index++)
+      >= (int)sizeof(buf)) return NULL;
+
+  return strdup(buf);
+}
+
+static int replace_by_var(ASTNode **slot, const char *name) {
+  YYLTYPE loc = (*slot)->loc;
+  char *copy = strdup(name);
+  if (copy == NULL) return -1;
+
+  ast_free(*slot);
+  *slot = ast_new_identifier(copy, loc);
+
+  return 0;
+}
+
+/* assign the expression to a new local before its statement */
+static int move_to_temp(struct Block *b, struct Method *m, const struct Occurrence *o,
+                        const char **temp) {
+  ASTNode *e = *o->slot;
+  char *name = fresh_name();
+  char *decl_name = name ? strdup(name) : NULL;
+  char *use_name = name ? strdup(name) : NULL;
+
+  if (name == NULL || decl_name == NULL || use_name == NULL) {
+    free(name);
+    free(decl_name);
+    free(use_name);
+    return -1;
+  }
+
+  m->locals = ast_list_prepend(m->locals, ast_new_var(decl_name, NULL, e->loc));
+
+  ASTList **pos = b->stmts[o->stmt].pos;
+  *pos = ast_list_prepend(*pos, ast_new_assign(name, e, e->loc));
+  *o->slot = ast_new_identifier(use_name, e->loc);
+
+  *temp = name;
+  return 0;
+}
+
+/* replace the repeated values of the block, largest expressions first */
+static int rewrite_block(struct Block *b, struct Method *m) {
+  unsigned int *count = calloc(b->n_values + 1, sizeof(unsigned int));
+  const char **temps = calloc(b->n_values + 1, sizeof(const char *));
+  int status = -1;
+
+  if (count == NULL || temps == NULL) goto done;
+
+  // occurrences outside of the subtrees that are replaced as a whole
+  unsigned int *raw = calloc(b->n_values + 1, sizeof(unsigned int));
+  if (raw == NULL) goto done;
+
+  for (size_t i = 0 ; i < b->n_occs ; i++) raw[b->occs[i].vn]++;
+  for (size_t i = 0 ; i < b->n_occs ; ) {
+    const struct Occurrence *o = &b->occs[i];
+
+    count[o->vn]++;
+    i = (o->holder != NULL || raw[o->vn] > 1) ? o->end : i + 1;
+  }
+  free(raw);
+
+  for (size_t i = 0 ; i < b->n_occs ; ) {
+    const struct Occurrence *o = &b->occs[i];
+    unsigned int cost = expr_cost(*o->slot);
+
+    if (o->holder != NULL && !is_var_offset(*o->slot)) {
+      if (replace_by_var(o->slot, o->holder)) goto done;
+    } else if (temps[o->vn] != NULL) {
+      if (replace_by_var(o->slot, temps[o->vn])) goto done;
+    } else if (count[o->vn] > 1 && cost * (count[o->vn] - 1) > TEMP_COST
+               && b->stmts[o->stmt].insert) {
+      if (move_to_temp(b, m, o, &temps[o->vn])) goto done;
+    } else {
+      i++;
+      continue;
+    }
+
+    m->changed = 1;
+    i = o->end;
+  }
+
+  status = 0;
+
+done:
+  free(count);
+  free(temps);
+  return status;
+}
+
+static void block_reset(struct Block *b) {
+  b->n_values = 0;
+  b->n_vars = 0;
+  b->n_occs = 0;
+  b->n_stmts = 0;
+  for (size_t i = 0 ; i < HASH_SIZE ; i++) b->buckets[i] = -1;
+}
+
+static void block_free(struct Block *b) {
+  free(b->values);
+  free(b->vars);
+  free(b->occs);
+  free(b->stmts);
+}
+
+/* statement of the current block: its expression is evaluated, then the
+   assignment takes place */
+static int number_stmt(struct Block *b, ASTList **pos, ASTNode **expr, const char *assigned,
+                       int insert) {
+  int vn = -1;
+
+  if (add_stmt(b, pos, insert)) return -1;
+  if (*expr != NULL && (vn = number_expr(b, expr)) < 0) return -1;
+  if (assigned != NULL && set_var_value(b, assigned, vn)) return -1;
+
+  return 0;
+}
+
+static int end_block(struct Block *b, struct Method *m) {
+  int status = rewrite_block(b, m);
+
+  block_reset(b);
+  return status;
+}
+
+static int _cse_list(ASTList **l, struct Block *b, struct Method *m);
+
+static int as_block(ASTNode *s);
+
+static int _cse_stmt_block(ASTNode *s, struct Block *b, struct Method *m) {
+  return (s == NULL) ? 0 : _cse_list(&s->block.stmts, b, m);
+}
+
+static int _cse_stmt(ASTList **pos, struct Block *b, struct Method *m) {
+  ASTNode *s = (*pos)->node;
+
+  if (s == NULL) return 0;
+
+  switch (s->kind) {
+    case N_BLOCK:
+      return _cse_list(&s->block.stmts, b, m);
+
+    case N_ASSIGN:
+      return number_stmt(b, pos, &s->assign.rhs, s->assign.location, 1);
+
+    case N_RETURN:
+      if (number_stmt(b, pos, &s->ret.expr, NULL, 1)) return -1;
+      return end_block(b, m);
+
+    case N_BREAK:
+      return end_block(b, m);
+
+    case N_IF:
+      // the condition is the last expression of the block
+      if (number_stmt(b, pos, &s->branch.cond, NULL, 1)) return -1;
+      if (end_block(b, m)) return -1;
+
+      if (as_block(s->branch.then_branch) || as_block(s->branch.else_branch)) return -1;
+      if (_cse_stmt_block(s->branch.then_branch, b, m) || end_block(b, m)) return -1;
+      if (_cse_stmt_block(s->branch.else_branch, b, m) || end_block(b, m)) return -1;
+      return 0;
+
+    case N_WHILE:
+      // the condition and the body run many times, each is a block apart
+      if (end_block(b, m)) return -1;
+
+      if (as_block(s->branch.then_branch)) return -1;
+      if (_cse_stmt_block(s->branch.then_branch, b, m)) return -1;
+      return end_block(b, m);
+
+    default:
+      return 0;
+  }
+}
+
+static int _cse_list(ASTList **l, struct Block *b, struct Method *m) {
+  for ( ; *l != NULL ; l = &(*l)->list) {
+    const ASTNode *s = (*l)->node;
+
+    if (_cse_stmt(l, b, m)) return -1;
+
+    // skip the assignments inserted before the statement
+    while ((*l)->node != s) l = &(*l)->list;
+  }
+
+  return 0;
+}
+
+/* a branch or loop body that is a single statement becomes a block, so
+   that assignments can be placed before the statement */
+static int as_block(ASTNode *s) {
+  if (s == NULL || s->kind == N_BLOCK) return 0;
+
+  ASTNode *copy = malloc(sizeof(ASTNode));
+  if (copy == NULL) return -1;
+  *copy = *s;
+
+  s->kind = N_BLOCK;
+  s->block.stmts = ast_list_prepend(NULL, copy);
+
+  return (s->block.stmts == NULL) ? -1 : 0;
+}
+
+static int cse_method(ASTNode *method) {
+  struct Method m = { NULL, 0 };
+  struct Block b = { 0 };
+  ASTNode *body = method->method.body;
+  int status = -1;
+
+  block_reset(&b);
+
+  for (int round = 0 ; round < MAX_ROUNDS ; round++) {
+    m.changed = 0;
+
+    // initializers start the first block, nothing can be placed before them
+    for (ASTList *d = body->body.decls ; d != NULL ; d = d->list) {
+      for (ASTList *l = d->node->decl.vars ; l != NULL ; l = l->list) {
+        ASTNode *v = l->node;
+        if (v->var.expr != NULL && number_stmt(&b, &l, &v->var.expr, v->var.name, 0)) goto done;
+      }
+    }
+
+    if (_cse_list(&body->body.stmts, &b, &m) || end_block(&b, &m)) goto done;
+    if (!m.changed) break;
+  }
+
+  status = 0;
+
+  if (m.locals != NULL) {
+    // declare the new locals after those of the method
+    ASTList **tail = &body->body.decls;
+    while (*tail != NULL) tail = &(*tail)->list;
+
+    *tail = ast_list_prepend(NULL, ast_new_decl(TYPE_INT, ast_list_reverse(m.locals), body->loc));
+    m.locals = NULL;
+    if (*tail == NULL) status = -1;
+  }
+
+done:
+  ast_list_free(m.locals);
+  block_free(&b);
+  return status;
+}
+
+int cse_ast(ASTNode *root) {
+  if (root == NULL || root->kind != N_PROGRAM) return -1;
+
+  for (ASTList *l = root->prog.methods ; l != NULL ; l = l->list) {
+    if (cse_method(l->node)) return -1;
+  }
+
+  return 0;
+}
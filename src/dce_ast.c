@@ -0,0 +1,563 @@
+#include "dce.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* what was removed from a method, or the method itself */
+struct DceMethod {
+  char *name;
+  int removed;
+  unsigned int stmts;  // unreachable statements
+  unsigned int stores; // assignments and initializers never read
+  unsigned int locals; // locals left unused
+};
+
+// methods with something removed, in program order
+static struct DceMethod *report = NULL;
+static size_t n_report = 0;
+
+/* variables of a method and the pass state over its statements */
+struct DceCtx {
+  const char **vars;
+  size_t n_vars;
+  const char *breaks;  // live variables after the innermost loop
+  int remove;          // remove dead stores, off while a loop iterates
+  unsigned int stores;
+};
+
+static struct DceMethod *record_method(const char *name) {
+  struct DceMethod *r = realloc(report, (n_report + 1) * sizeof(struct DceMethod));
+  if (r == NULL) return NULL;
+
+  report = r;
+  report[n_report] = (struct DceMethod) { .name = strdup(name) };
+  if (report[n_report].name == NULL) return NULL;
+
+  return &report[n_report++];
+}
+
+/* calls may not terminate, so expressions containing one are never dropped */
+static int has_call(const ASTNode *n) {
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_CALL:
+      return 1;
+
+    case N_BINOP:
+      return has_call(n->binop.lhs) || has_call(n->binop.rhs);
+
+    case N_UNARY:
+      return has_call(n->unary.expr);
+
+    default:
+      return 0;
+  }
+}
+
+/* free everything below n and leave an empty block in its place */
+static int set_empty(ASTNode *n) {
+  ASTNode *old = malloc(sizeof(ASTNode));
+  if (old == NULL) return -1;
+
+  *old = *n;
+  ast_free(old);
+
+  n->kind = N_BLOCK;
+  n->block.stmts = NULL;
+
+  return 0;
+}
+
+/* ------------------------------------------------------------------ */
+/* unreachable statements                                              */
+/* ------------------------------------------------------------------ */
+
+/* break that leaves the loop whose body is n */
+static int has_break(const ASTNode *n) {
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_BREAK:
+      return 1;
+
+    case N_BLOCK:
+      for (const ASTList *l = n->block.stmts ; l != NULL ; l = l->list) {
+        if (has_break(l->node)) return 1;
+      }
+      return 0;
+
+    case N_IF:
+      return has_break(n->branch.then_branch) || has_break(n->branch.else_branch);
+
+    default:
+      // a break in a nested loop leaves that loop
+      return 0;
+  }
+}
+
+/* control can reach the statement after s */
+static int falls_through(const ASTNode *s) {
+  if (s == NULL) return 1;
+
+  switch (s->kind) {
+    case N_RETURN:
+    case N_BREAK:
+      return 0;
+
+    case N_BLOCK:
+      for (const ASTList *l = s->block.stmts ; l != NULL ; l = l->list) {
+        if (!falls_through(l->node)) return 0;
+      }
+      return 1;
+
+    case N_IF:
+      return falls_through(s->branch.then_branch) || falls_through(s->branch.else_branch);
+
+    case N_WHILE:
+      // a loop on a nonzero constant is only left by a break
+      if (s->branch.cond->kind == N_NUMBER && s->branch.cond->number.val != 0) {
+        return has_break(s->branch.then_branch);
+      }
+      return 1;
+
+    default:
+      return 1;
+  }
+}
+
+static unsigned int prune_stmt(ASTNode *s);
+
+/* drop the statements that follow one control never comes back from */
+static unsigned int prune_list(ASTList *l) {
+  unsigned int removed = 0;
+
+  for ( ; l != NULL ; l = l->list) {
+    removed += prune_stmt(l->node);
+
+    if (!falls_through(l->node) && l->list != NULL) {
+      removed += ast_list_size(l->list);
+      ast_list_free(l->list);
+      l->list = NULL;
+    }
+  }
+
+  return removed;
+}
+
+static unsigned int prune_stmt(ASTNode *s) {
+  if (s == NULL) return 0;
+
+  switch (s->kind) {
+    case N_BODY:
+      return prune_list(s->body.stmts);
+
+    case N_BLOCK:
+      return prune_list(s->block.stmts);
+
+    case N_IF:
+      return prune_stmt(s->branch.then_branch) + prune_stmt(s->branch.else_branch);
+
+    case N_WHILE:
+      return prune_stmt(s->branch.then_branch);
+
+    default:
+      return 0;
+  }
+}
+
+/* ------------------------------------------------------------------ */
+/* dead stores                                                         */
+/* ------------------------------------------------------------------ */
+
+static long var_index(const struct DceCtx *c, const char *name) {
+  for (size_t k = 0 ; k < c->n_vars ; k++) {
+    if (strcmp(c->vars[k], name) == 0) return (long)k;
+  }
+
+  return -1;
+}
+
+/* add the variables read by an expression to the live set */
+static void live_uses(const struct DceCtx *c, const ASTNode *e, char *live) {
+  long k;
+
+  if (e == NULL) return;
+
+  switch (e->kind) {
+    case N_IDENTIFIER:
+      if ((k = var_index(c, e->identifier.name)) >= 0) live[k] = 1;
+      break;
+
+    case N_BINOP:
+      live_uses(c, e->binop.lhs, live);
+      live_uses(c, e->binop.rhs, live);
+      break;
+
+    case N_UNARY:
+      live_uses(c, e->unary.expr, live);
+      break;
+
+    case N_CALL:
+      for (const ASTList *l = e->call.args ; l != NULL ; l = l->list) live_uses(c, l->node, live);
+      break;
+
+    default:
+      break;
+  }
+}
+
+static int live_stmt(struct DceCtx *c, ASTNode *s, char *live);
+
+/* statements of a list, last first */
+static int live_list(struct DceCtx *c, ASTList *l, char *live) {
+  if (l == NULL) return 0;
+  if (live_list(c, l->list, live)) return -1;
+  return live_stmt(c, l->node, live);
+}
+
+/* the set of variables live at the loop condition is iterated to a fixed
+   point, then the body is walked once more to remove its dead stores */
+static int live_while(struct DceCtx *c, ASTNode *s, char *live) {
+  size_t n = c->n_vars;
+  const char *saved_breaks = c->breaks;
+  int saved_remove = c->remove;
+  char *out = malloc(n + 1), *head = malloc(n + 1), *body = malloc(n + 1);
+  int status = -1;
+
+  if (out == NULL || head == NULL || body == NULL) goto done;
+
+  memcpy(out, live, n);
+  memcpy(head, live, n);
+  live_uses(c, s->branch.cond, head);
+
+  c->breaks = out;
+  c->remove = 0;
+  for (;;) {
+    memcpy(body, head, n);
+    if (live_stmt(c, s->branch.then_branch, body)) goto done;
+
+    int changed = 0;
+    for (size_t k = 0 ; k < n ; k++) {
+      if (body[k] && !head[k]) head[k] = changed = 1;
+    }
+    if (!changed) break;
+  }
+
+  c->remove = saved_remove;
+  if (c->remove) {
+    memcpy(body, head, n);
+    if (live_stmt(c, s->branch.then_branch, body)) goto done;
+  }
+
+  memcpy(live, head, n);
+  status = 0;
+
+done:
+  c->breaks = saved_breaks;
+  c->remove = saved_remove;
+  free(out);
+  free(head);
+  free(body);
+  return status;
+}
+
+/* turn the live set after s into the live set before it */
+static int live_stmt(struct DceCtx *c, ASTNode *s, char *live) {
+  size_t n = c->n_vars;
+  char *other = NULL;
+  long k;
+
+  if (s == NULL) return 0;
+
+  switch (s->kind) {
+    case N_BLOCK:
+      return live_list(c, s->block.stmts, live);
+
+    case N_ASSIGN:
+      k = var_index(c, s->assign.location);
+      if (k < 0) return 0;
+
+      if (!live[k] && c->remove && !has_call(s->assign.rhs)) {
+        c->stores++;
+        return set_empty(s);
+      }
+
+      live[k] = 0;
+      live_uses(c, s->assign.rhs, live);
+      return 0;
+
+    case N_IF:
+      if ((other = malloc(n + 1)) == NULL) return -1;
+      memcpy(other, live, n);
+
+      if (live_stmt(c, s->branch.then_branch, live) ||
+          live_stmt(c, s->branch.else_branch, other)) {
+        free(other);
+        return -1;
+      }
+
+      for (size_t i = 0 ; i < n ; i++) live[i] |= other[i];
+      free(other);
+
+      live_uses(c, s->branch.cond, live);
+      return 0;
+
+    case N_WHILE:
+      return live_while(c, s, live);
+
+    case N_RETURN:
+      memset(live, 0, n);
+      live_uses(c, s->ret.expr, live);
+      return 0;
+
+    case N_BREAK:
+      if (c->breaks != NULL) memcpy(live, c->breaks, n);
+      return 0;
+
+    default:
+      return 0;
+  }
+}
+
+static int add_var(struct DceCtx *c, const char *name) {
+  const char **vars = realloc(c->vars, (c->n_vars + 1) * sizeof(const char *));
+  if (vars == NULL) return -1;
+
+  c->vars = vars;
+  c->vars[c->n_vars++] = name;
+
+  return 0;
+}
+
+/* initializers run in order before the statements, last first here */
+static void live_inits(struct DceCtx *c, ASTList *vars, char *live) {
+  if (vars == NULL) return;
+  live_inits(c, vars->list, live);
+
+  ASTNode *v = vars->node;
+  long k = var_index(c, v->var.name);
+
+  if (v->var.expr == NULL || k < 0) return;
+
+  if (!live[k] && !has_call(v->var.expr)) {
+    ast_free(v->var.expr);
+    v->var.expr = NULL;
+    c->stores++;
+    return;
+  }
+
+  live[k] = 0;
+  live_uses(c, v->var.expr, live);
+}
+
+static void live_decls(struct DceCtx *c, ASTList *decls, char *live) {
+  if (decls == NULL) return;
+  live_decls(c, decls->list, live);
+  live_inits(c, decls->node->decl.vars, live);
+}
+
+/* remove dead stores until none is left, each may have been the only
+   reader of another variable */
+static int dead_stores(ASTNode *m, struct DceCtx *c) {
+  ASTNode *body = m->method.body;
+  char *live = NULL;
+  unsigned int before;
+
+  for (const ASTList *p = m->method.params ; p != NULL ; p = p->list) {
+    if (add_var(c, p->node->param.name)) return -1;
+  }
+  for (const ASTList *d = body->body.decls ; d != NULL ; d = d->list) {
+    for (const ASTList *l = d->node->decl.vars ; l != NULL ; l = l->list) {
+      if (add_var(c, l->node->var.name)) return -1;
+    }
+  }
+
+  if ((live = calloc(c->n_vars + 1, 1)) == NULL) return -1;
+
+  do {
+    before = c->stores;
+    memset(live, 0, c->n_vars);
+
+    c->remove = 1;
+    c->breaks = NULL;
+    if (live_list(c, body->body.stmts, live)) {
+      free(live);
+      return -1;
+    }
+    live_decls(c, body->body.decls, live);
+  } while (c->stores != before);
+
+  free(live);
+  return 0;
+}
+
+/* ------------------------------------------------------------------ */
+/* unused locals                                                       */
+/* ------------------------------------------------------------------ */
+
+static int is_used(const ASTNode *n, const char *name);
+
+static int is_used_list(const ASTList *l, const char *name) {
+  for ( ; l != NULL ; l = l->list) {
+    if (is_used(l->node, name)) return 1;
+  }
+
+  return 0;
+}
+
+/* the variable is read or assigned */
+static int is_used(const ASTNode *n, const char *name) {
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_BODY:
+      return is_used_list(n->body.decls, name) || is_used_list(n->body.stmts, name);
+
+    case N_DECL:   return is_used_list(n->decl.vars, name);
+    case N_VAR:    return is_used(n->var.expr, name);
+    case N_BLOCK:  return is_used_list(n->block.stmts, name);
+    case N_RETURN: return is_used(n->ret.expr, name);
+    case N_UNARY:  return is_used(n->unary.expr, name);
+    case N_CALL:   return is_used_list(n->call.args, name);
+
+    case N_ASSIGN:
+      return strcmp(n->assign.location, name) == 0 || is_used(n->assign.rhs, name);
+
+    case N_IF:
+    case N_WHILE:
+      return is_used(n->branch.cond, name) || is_used(n->branch.then_branch, name)
+             || is_used(n->branch.else_branch, name);
+
+    case N_BINOP:
+      return is_used(n->binop.lhs, name) || is_used(n->binop.rhs, name);
+
+    case N_IDENTIFIER:
+      return strcmp(n->identifier.name, name) == 0;
+
+    default:
+      return 0;
+  }
+}
+
+/* drop the declarations of locals nothing reads or assigns any more,
+   so that they take no word in the frame */
+static unsigned int unused_locals(ASTNode *body) {
+  unsigned int removed = 0;
+
+  for (ASTList **d = &body->body.decls ; *d != NULL ; ) {
+    for (ASTList **l = &(*d)->node->decl.vars ; *l != NULL ; ) {
+      ASTNode *v = (*l)->node;
+
+      if (v->var.expr != NULL || is_used(body, v->var.name)) {
+        l = &(*l)->list;
+        continue;
+      }
+
+      ASTList *dead = *l;
+      *l = dead->list;
+      dead->list = NULL;
+      ast_list_free(dead);
+      removed++;
+    }
+
+    if ((*d)->node->decl.vars != NULL) {
+      d = &(*d)->list;
+      continue;
+    }
+
+    ASTList *dead = *d;
+    *d = dead->list;
+    dead->list = NULL;
+    ast_list_free(dead);
+  }
+
+  return removed;
+}
+
+static int dce_method(ASTNode *m) {
+  struct DceCtx c = { NULL, 0, NULL, 1, 0 };
+  unsigned int stmts, locals;
+
+  stmts = prune_stmt(m->method.body);
+
+  if (dead_stores(m, &c)) {
+    free(c.vars);
+    return -1;
+  }
+  free(c.vars);
+
+  locals = unused_locals(m->method.body);
+
+  if (stmts == 0 && c.stores == 0 && locals == 0) return 0;
+
+  struct DceMethod *r = record_method(m->method.name);
+  if (r == NULL) return -1;
+
+  r->stmts = stmts;
+  r->stores = c.stores;
+  r->locals = locals;
+
+  return 0;
+}
+
+/* ------------------------------------------------------------------ */
+/* unreachable methods                                                 */
+/* ------------------------------------------------------------------ */
+
+/* remove the methods that main does not call, directly or not */
+static int unreachable_methods(ASTNode *root, const CallGraph *g) {
+  long main_index = callgraph_find(g, "main");
+  if (main_index < 0) return 0;
+
+  size_t i = 0;
+  for (ASTList **l = &root->prog.methods ; *l != NULL ; i++) {
+    if (i == (size_t)main_index || callgraph_reaches(g, (size_t)main_index, i)) {
+      l = &(*l)->list;
+      continue;
+    }
+
+    struct DceMethod *r = record_method((*l)->node->method.name);
+    if (r == NULL) return -1;
+    r->removed = 1;
+
+    ASTList *dead = *l;
+    *l = dead->list;
+    dead->list = NULL;
+    ast_list_free(dead);
+  }
+
+  return 0;
+}
+
+int dce_ast(ASTNode *root, const CallGraph *g) {
+  if (root == NULL || root->kind != N_PROGRAM) return -1;
+
+  if (unreachable_methods(root, g)) return -1;
+
+  for (ASTList *l = root->prog.methods ; l != NULL ; l = l->list) {
+    if (dce_method(l->node)) return -1;
+  }
+
+  return 0;
+}
+
+void dce_print_report(FILE *f) {
+  fprintf(f, "%-20s %s\n", "method", "removed");
+  for (size_t k = 0 ; k < n_report ; k++) {
+    if (report[k].removed) {
+      fprintf(f, "%-20s the method, never reached from main\n", report[k].name);
+    } else {
+      fprintf(f, "%-20s %u unreachable statement(s), %u dead store(s), %u unused local(s)\n",
+              report[k].name, report[k].stmts, report[k].stores, report[k].locals);
+    }
+  }
+}
+
+void dce_free(void) {
+  for (size_t k = 0 ; k < n_report ; k++) free(report[k].name);
+  free(report);
+  report = NULL;
+  n_report = 0;
+}
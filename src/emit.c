@@ -1,60 +1,119 @@
 #include "emit.h"
+#include "options.h"
 
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
 
-#define COL_LABEL 10
-#define COL_OPCODE 4
-#define COL_ADDR 22
+#define LINE_LEN 256
 
 FILE *mixout = NULL;
+InstList mixcode = { NULL, NULL, 0 };
 
-int emit_line(const char *fmt, ...) {
-  if (!mixout) return -1;
+// label to attach to the next emitted instruction
+static char pending_label[INST_LABEL_LEN + 1] = "";
+
+static YYLTYPE current_loc = { 0, 0, 0, 0 };
+static const char *current_method = NULL;
+
+YYLTYPE emit_get_loc(void) {
+  return current_loc;
+}
+
+void emit_set_loc(YYLTYPE loc) {
+  current_loc = loc;
+}
+
+void emit_set_method(const char *name) {
+  current_method = name;
+}
 
+static int emit_text(enum InstKind kind, const char *fmt, va_list args) {
+  char text[LINE_LEN];
+
+  int len = vsnprintf(text, LINE_LEN, fmt, args);
+  if (len < 0 || len >= LINE_LEN) return -1;
+
+  MixInst *i = inst_new(kind, NULL, NULL, NULL, 0, NULL, text, current_loc);
+  if (i == NULL) return -1;
+
+  i->method = current_method;
+
+  inst_append(&mixcode, i);
+  return 0;
+}
+
+int emit_line(const char *fmt, ...) {
   va_list args;
 
   va_start(args, fmt);
-  vfprintf(mixout, fmt, args);
+  int status = emit_text(INST_LINE, fmt, args);
   va_end(args);
 
-  fputc('\n', mixout);
-  return 0;
+  return status;
 }
 
 int emit_comment(const char *fmt, ...) {
-  if (!mixout) return -1;
-
   va_list args;
 
-  fprintf(mixout, "* ");
   va_start(args, fmt);
-  vfprintf(mixout, fmt, args);
+  int status = emit_text(INST_COMMENT, fmt, args);
   va_end(args);
-  fputc('\n', mixout);
 
-  return 0;
+  return status;
 }
 
 int emit_label(const char *label) {
-  return emit_inst(label, "NOP", NULL, NULL);
+  return emit_inst(label, "NOP", NULL, 0, NULL, NULL);
+}
+
+int emit_label_next(const char *label) {
+  // a previously pending label still needs a location of its own
+  if (pending_label[0] && emit_label(NULL)) return -1;
+
+  strncpy(pending_label, label, INST_LABEL_LEN);
+  pending_label[INST_LABEL_LEN] = '\0';
+
+  return 0;
 }
 
 int emit_inst(const char *label,
               const char *opcode,
               const char *address,
+              int index,
+              const char *field,
               const char *comment) {
 
-  if (!mixout) return -1;
+  char l[INST_LABEL_LEN + 1];
 
-  fprintf(mixout, "%-*s", COL_LABEL, label ? label : "");
-  fprintf(mixout, " %-*s", COL_OPCODE, opcode);
-  fprintf(mixout, " %-*s", COL_ADDR, address ? address : "");
-  if (comment && comment[0]) {
-    fprintf(mixout, " ; %s", comment);
+  if (pending_label[0]) {
+    strcpy(l, pending_label);
+    pending_label[0] = '\0';
+
+    if (label == NULL) {
+      label = l;
+    } else if (emit_inst(l, "NOP", NULL, 0, NULL, NULL)) {
+      return -1;
+    }
   }
-  fputc('\n', mixout);
 
+  MixInst *i = inst_new(INST_OP, label, opcode, address, index, field, comment, current_loc);
+  if (i == NULL) return -1;
+
+  i->method = current_method;
+
+  inst_append(&mixcode, i);
   return 0;
 }
+
+int emit_flush(void) {
+  if (!mixout) return -1;
+
+  // a label still pending at the end gets its own location
+  if (pending_label[0] && emit_label(NULL)) return -1;
+
+  int status = inst_list_write(&mixcode, mixout, options.profile);
+  inst_list_free(&mixcode);
+
+  return status;
+}
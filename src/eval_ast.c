@@ -0,0 +1,384 @@
+#include "eval.h"
+#include "options.h"
+#include "mix.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// methods nested deeper than this are left to run time
+#define EVAL_DEPTH_MAX 1000
+
+struct Eval {
+  const ASTNode *root;
+  unsigned long budget; // nodes left to evaluate
+  unsigned int depth;   // methods being run
+};
+
+/* parameters and locals of a running method */
+struct Frame {
+  const char **names;
+  long long *values;
+  char *defined;
+  size_t n;
+};
+
+enum Flow {
+  FLOW_NEXT,   // go on with the next statement
+  FLOW_BREAK,  // leave the innermost loop
+  FLOW_RETURN  // leave the method
+};
+
+static int eval_method(struct Eval *ev, const char *name, const long long *args,
+                       size_t n_args, long long *result);
+
+static long long *slot(struct Frame *f, const char *name, char **defined) {
+  for (size_t k = 0 ; k < f->n ; k++) {
+    if (strcmp(f->names[k], name) == 0) {
+      *defined = &f->defined[k];
+      return &f->values[k];
+    }
+  }
+
+  return NULL;
+}
+
+static int eval_expr(struct Eval *ev, struct Frame *f, const ASTNode *e, long long *v) {
+  long long a, b;
+  char *defined;
+
+  if (ev->budget == 0) return 1;
+  ev->budget -= 1;
+
+  switch (e->kind) {
+    case N_NUMBER:
+      *v = mix_word_wrap(e->number.val);
+      return 0;
+
+    case N_IDENTIFIER: {
+      long long *s = slot(f, e->identifier.name, &defined);
+      if (s == NULL || !*defined) return 1;
+
+      *v = *s;
+      return 0;
+    }
+
+    case N_UNARY: {
+      int status = eval_expr(ev, f, e->unary.expr, &a);
+      if (status) return status;
+
+      *v = (e->unary.op == OP_ADDOP_SUB) ? -a : a;
+      return 0;
+    }
+
+    case N_BINOP: {
+      int status = eval_expr(ev, f, e->binop.lhs, &a);
+      if (status == 0) status = eval_expr(ev, f, e->binop.rhs, &b);
+      if (status) return status;
+
+      switch (e->binop.op) {
+        case OP_RELOP_LEQ: *v = a <= b; break;
+        case OP_RELOP_LT:  *v = a < b; break;
+        case OP_RELOP_GT:  *v = a > b; break;
+        case OP_RELOP_GEQ: *v = a >= b; break;
+        case OP_RELOP_EQ:  *v = a == b; break;
+        case OP_RELOP_NEQ: *v = a != b; break;
+        case OP_ADDOP_ADD: *v = mix_word_wrap(a + b); break;
+        case OP_ADDOP_SUB: *v = mix_word_wrap(a - b); break;
+        case OP_MULOP_MUL: *v = mix_word_wrap(a * b); break;
+
+        case OP_MULOP_DIV:
+          // DIV by zero sets the overflow toggle and leaves rA undefined
+          if (b == 0) return 1;
+          *v = a / b;
+          break;
+
+        default:
+          return -1;
+      }
+      return 0;
+    }
+
+    case N_CALL: {
+      size_t n_args = ast_list_size(e->call.args);
+      long long *args = malloc((n_args + 1) * sizeof(long long));
+      size_t k = 0;
+      int status = 0;
+
+      if (args == NULL) return -1;
+
+      for (const ASTList *l = e->call.args ; l != NULL && status == 0 ; l = l->list) {
+        status = eval_expr(ev, f, l->node, &args[k++]);
+      }
+      if (status == 0) status = eval_method(ev, e->call.fname, args, n_args, v);
+
+      free(args);
+      return status;
+    }
+
+    default:
+      return -1;
+  }
+}
+
+static int eval_stmt(struct Eval *ev, struct Frame *f, const ASTNode *s,
+                     enum Flow *flow, long long *result);
+
+static int eval_stmt_list(struct Eval *ev, struct Frame *f, const ASTList *l,
+                          enum Flow *flow, long long *result) {
+  for ( ; l != NULL && *flow == FLOW_NEXT ; l = l->list) {
+    int status = eval_stmt(ev, f, l->node, flow, result);
+    if (status) return status;
+  }
+
+  return 0;
+}
+
+static int eval_stmt(struct Eval *ev, struct Frame *f, const ASTNode *s,
+                     enum Flow *flow, long long *result) {
+  long long v;
+  int status;
+
+  if (s == NULL) return 0;
+
+  if (ev->budget == 0) return 1;
+  ev->budget -= 1;
+
+  switch (s->kind) {
+    case N_BLOCK:
+      return eval_stmt_list(ev, f, s->block.stmts, flow, result);
+
+    case N_ASSIGN: {
+      char *defined;
+      long long *dst = slot(f, s->assign.location, &defined);
+
+      if (dst == NULL) return 1;
+      if ((status = eval_expr(ev, f, s->assign.rhs, &v))) return status;
+
+      *dst = v;
+      *defined = 1;
+      return 0;
+    }
+
+    case N_IF:
+      if ((status = eval_expr(ev, f, s->branch.cond, &v))) return status;
+      return eval_stmt(ev, f, v ? s->branch.then_branch : s->branch.else_branch, flow, result);
+
+    case N_WHILE:
+      for (;;) {
+        if ((status = eval_expr(ev, f, s->branch.cond, &v))) return status;
+        if (!v) return 0;
+
+        if ((status = eval_stmt(ev, f, s->branch.then_branch, flow, result))) return status;
+
+        if (*flow == FLOW_BREAK) {
+          *flow = FLOW_NEXT;
+          return 0;
+        }
+        if (*flow == FLOW_RETURN) return 0;
+      }
+
+    case N_RETURN:
+      // a return without a value leaves whatever rA holds
+      if (s->ret.expr == NULL) return 1;
+      if ((status = eval_expr(ev, f, s->ret.expr, result))) return status;
+
+      *flow = FLOW_RETURN;
+      return 0;
+
+    case N_BREAK:
+      *flow = FLOW_BREAK;
+      return 0;
+
+    default:
+      return -1;
+  }
+}
+
+static const ASTNode *find_method(const ASTNode *root, const char *name) {
+  for (const ASTList *l = root->prog.methods ; l != NULL ; l = l->list) {
+    if (strcmp(l->node->method.name, name) == 0) return l->node;
+  }
+
+  return NULL;
+}
+
+static int frame_add(struct Frame *f, const char *name) {
+  const char **names = realloc(f->names, (f->n + 1) * sizeof(const char *));
+  if (names == NULL) return -1;
+  f->names = names;
+
+  long long *values = realloc(f->values, (f->n + 1) * sizeof(long long));
+  if (values == NULL) return -1;
+  f->values = values;
+
+  char *defined = realloc(f->defined, f->n + 1);
+  if (defined == NULL) return -1;
+  f->defined = defined;
+
+  f->names[f->n] = name;
+  f->values[f->n] = 0;
+  f->defined[f->n] = 0;
+  f->n += 1;
+
+  return 0;
+}
+
+static int eval_method(struct Eval *ev, const char *name, const long long *args,
+                       size_t n_args, long long *result) {
+  const ASTNode *m = find_method(ev->root, name);
+  struct Frame f = { NULL, NULL, NULL, 0 };
+  enum Flow flow = FLOW_NEXT;
+  int status = 0;
+
+  if (m == NULL || ast_list_size(m->method.params) != n_args) return 1;
+  if (ev->depth >= EVAL_DEPTH_MAX) return 1;
+
+  ev->depth += 1;
+
+  size_t k = 0;
+  for (const ASTList *l = m->method.params ; l != NULL && status == 0 ; l = l->list, k++) {
+    status = frame_add(&f, l->node->param.name);
+    if (status == 0) {
+      f.values[k] = args[k];
+      f.defined[k] = 1;
+    }
+  }
+
+  // locals are initialized in order, the others hold whatever the stack held
+  for (const ASTList *d = m->method.body->body.decls ; d != NULL && status == 0 ; d = d->list) {
+    for (const ASTList *l = d->node->decl.vars ; l != NULL && status == 0 ; l = l->list) {
+      const ASTNode *var = l->node;
+
+      status = frame_add(&f, var->var.name);
+      if (status == 0 && var->var.expr != NULL) {
+        status = eval_expr(ev, &f, var->var.expr, &f.values[f.n - 1]);
+        f.defined[f.n - 1] = 1;
+      }
+    }
+  }
+
+  if (status == 0) status = eval_stmt_list(ev, &f, m->method.body->body.stmts, &flow, result);
+
+  // falling off the end returns whatever rA holds
+  if (status == 0 && flow != FLOW_RETURN) status = 1;
+
+  ev->depth -= 1;
+
+  free(f.names);
+  free(f.values);
+  free(f.defined);
+
+  return status;
+}
+
+int eval_call(const ASTNode *root, const char *name, const long long *args,
+              size_t n_args, unsigned long budget, long long *result) {
+  struct Eval ev = { root, budget, 0 };
+
+  if (root == NULL || root->kind != N_PROGRAM) return -1;
+
+  return eval_method(&ev, name, args, n_args, result);
+}
+
+static int _eval_ast_node(const ASTNode *root, ASTNode *n);
+
+static int _eval_ast_list(const ASTNode *root, ASTList *l) {
+  for ( ; l != NULL ; l = l->list) {
+    if (_eval_ast_node(root, l->node)) return -1;
+  }
+
+  return 0;
+}
+
+/* the call becomes its value when every argument is a constant */
+static int eval_call_site(const ASTNode *root, ASTNode *n) {
+  size_t n_args = ast_list_size(n->call.args);
+  long long *args = malloc((n_args + 1) * sizeof(long long));
+  long long value;
+  size_t k = 0;
+
+  if (args == NULL) return -1;
+
+  for (const ASTList *l = n->call.args ; l != NULL ; l = l->list) {
+    if (l->node->kind != N_NUMBER) {
+      free(args);
+      return 0;
+    }
+    args[k++] = mix_word_wrap(l->node->number.val);
+  }
+
+  int status = eval_call(root, n->call.fname, args, n_args,
+                         (unsigned long)options.eval_limit, &value);
+  free(args);
+
+  if (status != 0) return (status < 0) ? -1 : 0;
+
+  ASTNode *old = malloc(sizeof(ASTNode));
+  if (old == NULL) return -1;
+
+  *old = *n;
+  ast_free(old);
+
+  n->kind = N_NUMBER;
+  n->number.val = (int)value;
+
+  return 0;
+}
+
+static int _eval_ast_node(const ASTNode *root, ASTNode *n) {
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_PROGRAM:
+      return _eval_ast_list(root, n->prog.methods);
+
+    case N_METHOD:
+      return _eval_ast_node(root, n->method.body);
+
+    case N_BODY:
+      if (_eval_ast_list(root, n->body.decls)) return -1;
+      return _eval_ast_list(root, n->body.stmts);
+
+    case N_DECL:
+      return _eval_ast_list(root, n->decl.vars);
+
+    case N_VAR:
+      return _eval_ast_node(root, n->var.expr);
+
+    case N_BLOCK:
+      return _eval_ast_list(root, n->block.stmts);
+
+    case N_ASSIGN:
+      return _eval_ast_node(root, n->assign.rhs);
+
+    case N_IF:
+    case N_WHILE:
+      if (_eval_ast_node(root, n->branch.cond)) return -1;
+      if (_eval_ast_node(root, n->branch.then_branch)) return -1;
+      return _eval_ast_node(root, n->branch.else_branch);
+
+    case N_RETURN:
+      return _eval_ast_node(root, n->ret.expr);
+
+    case N_BINOP:
+      if (_eval_ast_node(root, n->binop.lhs)) return -1;
+      return _eval_ast_node(root, n->binop.rhs);
+
+    case N_UNARY:
+      return _eval_ast_node(root, n->unary.expr);
+
+    case N_CALL:
+      // arguments first, a call on them may become a constant
+      if (_eval_ast_list(root, n->call.args)) return -1;
+      return eval_call_site(root, n);
+
+    default:
+      return 0;
+  }
+}
+
+int eval_ast(ASTNode *root) {
+  if (root == NULL || root->kind != N_PROGRAM) return -1;
+
+  return _eval_ast_node(root, root);
+}
@@ -0,0 +1,259 @@
+#include "fold.h"
+#include "mix.h"
+
+#include <stdlib.h>
+
+static int _fold_ast_node(ASTNode *n);
+static int _fold_ast_list(ASTList *l);
+
+int fold_ast(ASTNode *root) {
+  return _fold_ast_node(root);
+}
+
+static int is_number(const ASTNode *n, int val) {
+  return n != NULL && n->kind == N_NUMBER && n->number.val == val;
+}
+
+/* calls may not terminate, so expressions containing one are never dropped */
+static int has_call(const ASTNode *n) {
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_CALL:
+      return 1;
+
+    case N_BINOP:
+      return has_call(n->binop.lhs) || has_call(n->binop.rhs);
+
+    case N_UNARY:
+      return has_call(n->unary.expr);
+
+    default:
+      return 0;
+  }
+}
+
+/* free everything below n, keeping the node itself */
+static int clear_node(ASTNode *n) {
+  ASTNode *old = malloc(sizeof(ASTNode));
+  if (old == NULL) return -1;
+
+  *old = *n;
+  ast_free(old);
+
+  return 0;
+}
+
+static int set_number(ASTNode *n, long long val) {
+  if (clear_node(n)) return -1;
+
+  n->kind = N_NUMBER;
+  n->number.val = (int)mix_word_wrap(val);
+
+  return 0;
+}
+
+/* an empty block stands in for a pruned statement */
+static int set_empty(ASTNode *n) {
+  if (clear_node(n)) return -1;
+
+  n->kind = N_BLOCK;
+  n->block.stmts = NULL;
+
+  return 0;
+}
+
+/* replace n by one of its children, freeing the rest of the subtree */
+static int replace_node(ASTNode *n, ASTNode **child) {
+  ASTNode *c = *child;
+  *child = NULL;
+
+  if (clear_node(n)) {
+    *child = c;
+    return -1;
+  }
+
+  *n = *c;
+  free(c);
+
+  return 0;
+}
+
+/* replace n by the negation of one of its children */
+static int set_negation(ASTNode *n, ASTNode **child) {
+  ASTNode *c = *child;
+  *child = NULL;
+
+  if (clear_node(n)) {
+    *child = c;
+    return -1;
+  }
+
+  n->kind = N_UNARY;
+  n->unary.op = OP_ADDOP_SUB;
+  n->unary.expr = c;
+
+  return _fold_ast_node(n);
+}
+
+static int fold_binop(ASTNode *n) {
+  ASTNode *lhs = n->binop.lhs;
+  ASTNode *rhs = n->binop.rhs;
+
+  if (lhs->kind == N_NUMBER && rhs->kind == N_NUMBER) {
+    // operands are reduced to MIX words first, as they would be by the assembler
+    long long a = mix_word_wrap(lhs->number.val);
+    long long b = mix_word_wrap(rhs->number.val);
+
+    switch (n->binop.op) {
+      case OP_RELOP_LEQ: return set_number(n, a <= b);
+      case OP_RELOP_LT:  return set_number(n, a < b);
+      case OP_RELOP_GT:  return set_number(n, a > b);
+      case OP_RELOP_GEQ: return set_number(n, a >= b);
+      case OP_RELOP_EQ:  return set_number(n, a == b);
+      case OP_RELOP_NEQ: return set_number(n, a != b);
+      case OP_ADDOP_ADD: return set_number(n, a + b);
+      case OP_ADDOP_SUB: return set_number(n, a - b);
+      case OP_MULOP_MUL: return set_number(n, a * b);
+
+      case OP_MULOP_DIV:
+        // division by zero is left to fail at run time
+        if (b == 0) return 0;
+        return set_number(n, a / b);
+
+      default:
+        return -1;
+    }
+  }
+
+  switch (n->binop.op) {
+    case OP_ADDOP_ADD:
+      if (is_number(rhs, 0)) return replace_node(n, &n->binop.lhs);
+      if (is_number(lhs, 0)) return replace_node(n, &n->binop.rhs);
+      break;
+
+    case OP_ADDOP_SUB:
+      if (is_number(rhs, 0)) return replace_node(n, &n->binop.lhs);
+      if (is_number(lhs, 0)) return set_negation(n, &n->binop.rhs);
+      break;
+
+    case OP_MULOP_MUL:
+      if (is_number(rhs, 1)) return replace_node(n, &n->binop.lhs);
+      if (is_number(lhs, 1)) return replace_node(n, &n->binop.rhs);
+      if (is_number(rhs, -1)) return set_negation(n, &n->binop.lhs);
+      if (is_number(lhs, -1)) return set_negation(n, &n->binop.rhs);
+      if (is_number(rhs, 0) && !has_call(lhs)) return set_number(n, 0);
+      if (is_number(lhs, 0) && !has_call(rhs)) return set_number(n, 0);
+      break;
+
+    case OP_MULOP_DIV:
+      if (is_number(rhs, 1)) return replace_node(n, &n->binop.lhs);
+      if (is_number(rhs, -1)) return set_negation(n, &n->binop.lhs);
+      break;
+
+    default:
+      break;
+  }
+
+  return 0;
+}
+
+static int fold_unary(ASTNode *n) {
+  ASTNode *expr = n->unary.expr;
+
+  if (n->unary.op != OP_ADDOP_SUB) return 0;
+
+  if (expr->kind == N_NUMBER) {
+    return set_number(n, -(long long)expr->number.val);
+  }
+
+  // -(-x) is x
+  if (expr->kind == N_UNARY && expr->unary.op == OP_ADDOP_SUB) {
+    return replace_node(n, &expr->unary.expr);
+  }
+
+  return 0;
+}
+
+static int _fold_ast_node(ASTNode *n) {
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_PROGRAM:
+      return _fold_ast_list(n->prog.methods);
+
+    case N_METHOD:
+      return _fold_ast_node(n->method.body);
+
+    case N_BODY:
+      if (_fold_ast_list(n->body.decls)) return -1;
+      return _fold_ast_list(n->body.stmts);
+
+    case N_DECL:
+      return _fold_ast_list(n->decl.vars);
+
+    case N_VAR:
+      return _fold_ast_node(n->var.expr);
+
+    case N_BLOCK:
+      return _fold_ast_list(n->block.stmts);
+
+    case N_ASSIGN:
+      return _fold_ast_node(n->assign.rhs);
+
+    case N_IF:
+      if (_fold_ast_node(n->branch.cond)) return -1;
+      if (_fold_ast_node(n->branch.then_branch)) return -1;
+      if (_fold_ast_node(n->branch.else_branch)) return -1;
+
+      if (n->branch.cond->kind == N_NUMBER) {
+        ASTNode **taken = n->branch.cond->number.val ? &n->branch.then_branch
+                                                     : &n->branch.else_branch;
+
+        if (*taken == NULL) return set_empty(n);
+        return replace_node(n, taken);
+      }
+
+      return 0;
+
+    case N_WHILE:
+      if (_fold_ast_node(n->branch.cond)) return -1;
+      if (_fold_ast_node(n->branch.then_branch)) return -1;
+
+      if (is_number(n->branch.cond, 0)) return set_empty(n);
+
+      return 0;
+
+    case N_RETURN:
+      return _fold_ast_node(n->ret.expr);
+
+    case N_BINOP:
+      if (_fold_ast_node(n->binop.lhs)) return -1;
+      if (_fold_ast_node(n->binop.rhs)) return -1;
+      return fold_binop(n);
+
+    case N_UNARY:
+      if (_fold_ast_node(n->unary.expr)) return -1;
+      return fold_unary(n);
+
+    case N_CALL:
+      return _fold_ast_list(n->call.args);
+
+    case N_PARAM:
+    case N_BREAK:
+    case N_IDENTIFIER:
+    case N_NUMBER:
+      return 0;
+
+    default:
+      return -1;
+  }
+}
+
+static int _fold_ast_list(ASTList *l) {
+  for ( ; l != NULL ; l = l->list) {
+    if (_fold_ast_node(l->node)) return -1;
+  }
+
+  return 0;
+}
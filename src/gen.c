@@ -1,45 +1,104 @@
 #include "gen.h"
 #include "emit.h"
+#include "options.h"
+#include "mix.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the result is printed from a buffer above the code
+#define BUFFER_ADDR 3800
+
+/* with -fstatic-frame the temporaries of a method live in its frame
+   above the locals, so the stack depth is tracked here instead of SP */
+static int frame_static = 0;         // generating a method with a static frame
+static unsigned int frame_base = 0;  // FP offset of the word below the first temporary
+static unsigned int frame_depth = 0; // temporaries in use
+
+/* address of the word `offset` words above the top of the stack */
+static int gen_stack_top(int offset, char *address, size_t addr_len, int *index,
+                         char *desc, size_t desc_len) {
+  if (frame_static) {
+    unsigned int k = frame_base + frame_depth + offset;
+
+    *index = REG_FP;
+    if (snprintf(address, addr_len, "STACK+%u", k)
+        >= (int)addr_len) return -1;
+    if (snprintf(desc, desc_len, "STACK[FP+%u]", k)
+        >= (int)desc_len) return -1;
+  } else if (offset != 0) {
+    *index = REG_SP;
+    if (snprintf(address, addr_len, "STACK%+d", offset)
+        >= (int)addr_len) return -1;
+    if (snprintf(desc, desc_len, "STACK[SP%+d]", offset)
+        >= (int)desc_len) return -1;
+  } else {
+    *index = REG_SP;
+    if (snprintf(address, addr_len, "STACK")
+        >= (int)addr_len) return -1;
+    if (snprintf(desc, desc_len, "STACK[SP]")
+        >= (int)desc_len) return -1;
+  }
 
-#ifndef ASCII
-#define ASCII 0
-#endif
+  return 0;
+}
+
+/* emit an instruction on a word at the top of the stack,
+   the comment format takes the description of that word */
+static int gen_top_inst(const char *label, const char *opcode, int offset,
+                        const char *comment_fmt) {
+  char address[32];
+  int index;
+  char desc[32];
+  char comment[64];
+
+  if (gen_stack_top(offset, address, sizeof(address), &index, desc, sizeof(desc))) return -1;
+  if (snprintf(comment, sizeof(comment), comment_fmt, desc)
+      >= (int)sizeof(comment)) return -1;
+  if (emit_inst(label, opcode, address, index, NULL, comment)) return -1;
+
+  return 0;
+}
 
-#if ASCII
-#define SYMB_ASSIGN "<-"
-#define SYMB_EQUIV ":="
-#else
-#define SYMB_ASSIGN "←"
-#define SYMB_EQUIV "≡"
-#endif
+/* drop the top of the stack */
+static int gen_stack_release() {
+  if (frame_static) {
+    frame_depth -= 1;
+    return 0;
+  }
+
+  return emit_inst(NULL, DEC(REG_SP), "1", 0, NULL, "SP " SYMB_ASSIGN " SP - 1");
+}
 
 static int gen_push_reg(char reg) {
   char inst[4];
-  char address[32];
   char comment[64];
 
   const char *reg_str = (reg >= '1' && reg <= '6') ? "rI" : "r";
 
-  // increment SP
-  if (emit_inst(NULL, INC(REG_SP), "1", "SP " SYMB_ASSIGN " SP + 1")) return -1;
+  if (frame_static) {
+    // the word is reserved in the frame
+    frame_depth += 1;
+  } else {
+    // increment SP
+    if (emit_inst(NULL, INC(REG_SP), "1", 0, NULL, "SP " SYMB_ASSIGN " SP + 1")) return -1;
+  }
 
   // TODO: handle stack overflow
 
   // push register to stack (store at top of stack)
   if (snprintf(inst, sizeof(inst), "ST%c", reg)
       >= (int)sizeof(inst)) return -1;
-  if (snprintf(address, sizeof(address), "STACK,%u", REG_SP) 
-      >= (int)sizeof(address)) return -1;
-  if (snprintf(comment, sizeof(comment), "STACK[SP] " SYMB_ASSIGN " %s%c", reg_str, reg) 
+  if (snprintf(comment, sizeof(comment), "%%s " SYMB_ASSIGN " %s%c", reg_str, reg) 
       >= (int)sizeof(comment)) return -1;
-  if (emit_inst(NULL, inst, address, comment)) return -1;
+  if (gen_top_inst(NULL, inst, 0, comment)) return -1;
 
   return 0;
 }
 
 static int gen_pop_reg(char reg) {
   char inst[4];
-  char address[32];
   char comment[64];
 
   const char *reg_str = (reg >= '1' && reg <= '6') ? "rI" : "r";
@@ -49,30 +108,31 @@ static int gen_pop_reg(char reg) {
   // pop register from stack (load from top of stack)
   if (snprintf(inst, sizeof(inst), "LD%c", reg)
       >= (int)sizeof(inst)) return -1;
-  if (snprintf(address, sizeof(address), "STACK,%u", REG_SP) 
-      >= (int)sizeof(address)) return -1;
-  if (snprintf(comment, sizeof(comment), "%s%c " SYMB_ASSIGN " STACK[SP]", reg_str, reg) 
+  if (snprintf(comment, sizeof(comment), "%s%c " SYMB_ASSIGN " %%s", reg_str, reg) 
       >= (int)sizeof(comment)) return -1;
-  if (emit_inst(NULL, inst, address, comment)) return -1;
+  if (gen_top_inst(NULL, inst, 0, comment)) return -1;
 
   // decrement SP
-  if (emit_inst(NULL, DEC(REG_SP), "1", "SP " SYMB_ASSIGN " SP - 1")) return -1;
+  if (gen_stack_release()) return -1;
 
   return 0;
 }
 
-int gen_push_var(const char *var_name, int offset) {
+int gen_push_var(const char *var_name, int offset, int reg) {
   char address[32];
   char comment[64];
 
   emit_comment("Push %s to stack", var_name);
+
+  // push the index register holding the variable
+  if (reg) return gen_push_reg(CHAR(reg));
   
   // load STACK[FP + offset] to rA
-  if (snprintf(address, sizeof(address), "STACK%+d,%u", offset, REG_FP)
+  if (snprintf(address, sizeof(address), "STACK%+d", offset)
       >= (int)sizeof(address)) return -1;
   if (snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " %s " SYMB_EQUIV " STACK[FP%+d]", var_name, offset)
       >= (int)sizeof(comment)) return -1;
-  if (emit_inst(NULL, "LDA", address, comment)) return -1;
+  if (emit_inst(NULL, "LDA", address, REG_FP, NULL, comment)) return -1;
 
   // push rA to stack
   if (gen_push_reg('A')) return -1;
@@ -91,7 +151,7 @@ int gen_push_num(int value) {
       >= (int)sizeof(address)) return -1;
   if (snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " %d", value)
       >= (int)sizeof(comment)) return -1;
-  if (emit_inst(NULL, "LDA", address, comment)) return -1;
+  if (emit_inst(NULL, "LDA", address, 0, NULL, comment)) return -1;
 
   // push rA to stack
   if (gen_push_reg('A')) return -1;
@@ -99,47 +159,51 @@ int gen_push_num(int value) {
   return 0;
 }
 
-int gen_pop_var(const char *var_name, int offset) {
+int gen_pop_var(const char *var_name, int offset, int reg) {
   char address[32];
   char comment[64];
 
   emit_comment("Pop %s from stack", var_name);
+
+  // pop to the index register holding the variable, and keep its frame
+  // word up to date as gen_store_var does: the register may be reloaded
+  // from it after a call that does not save it
+  if (reg) {
+    if (gen_pop_reg(CHAR(reg))) return -1;
+    return gen_index_save(var_name, offset, reg);
+  }
   
   // pop rA from stack
   if (gen_pop_reg('A')) return -1;
 
   // store rA to STACK[FP + offset]
-  if (snprintf(address, sizeof(address), "STACK%+d,%u", offset, REG_FP)
+  if (snprintf(address, sizeof(address), "STACK%+d", offset)
       >= (int)sizeof(address)) return -1;
   if (snprintf(comment, sizeof(comment), "STACK[FP%+d] " SYMB_EQUIV " %s " SYMB_ASSIGN " rA", offset, var_name)
       >= (int)sizeof(comment)) return -1;
-  if (emit_inst(NULL, "STA", address, comment)) return -1;
+  if (emit_inst(NULL, "STA", address, REG_FP, NULL, comment)) return -1;
   
   return 0;
 }
 
 int gen_unary_neg() {
-  char address[32];
 
   emit_comment("Negation operation on stack (pop A, push -A)");
 
-  if (snprintf(address, sizeof(address), "STACK,%u", REG_SP) 
-      >= (int)sizeof(address)) return -1;
   // pop rA from stack negated
-  if (emit_inst(NULL, "LDAN", address, "rA " SYMB_ASSIGN " -STACK[SP]")) return -1;
+  if (gen_top_inst(NULL, "LDAN", 0, "rA " SYMB_ASSIGN " -%s")) return -1;
 
   /* if this were a real stack machine, 
      it would decrement then increment SP by 1 here. 
      But that would be pointless to emulate and waste instruction cycles. */
 
   // store rA to STACK[SP]
-  if (emit_inst(NULL, "STA", address, "STACK[SP] " SYMB_ASSIGN " rA")) return -1;
+  if (gen_top_inst(NULL, "STA", 0, "%s " SYMB_ASSIGN " rA")) return -1;
 
   return 0;
 }
 
 int gen_binop_add() {
-  char address[32];
 
   emit_comment("Addition operation on stack (pop A, pop B, push A + B)");
 
@@ -147,22 +211,19 @@ int gen_binop_add() {
   if (gen_pop_reg('A')) return -1;
 
   // pop from stack and add to rA
-  if (snprintf(address, sizeof(address), "STACK,%u", REG_SP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(NULL, "ADD", address, "rA " SYMB_ASSIGN " rA + STACK[SP]")) return -1;
+  if (gen_top_inst(NULL, "ADD", 0, "rA " SYMB_ASSIGN " rA + %s")) return -1;
 
   /* if this were a real stack machine, 
      it would decrement then increment SP by 1 here. 
      But that would be pointless to emulate and waste instruction cycles. */
   
   // write rA back to the stack
-  if (emit_inst(NULL, "STA", address, "STACK[SP] " SYMB_ASSIGN " rA")) return -1;
+  if (gen_top_inst(NULL, "STA", 0, "%s " SYMB_ASSIGN " rA")) return -1;
 
   return 0;
 }
 
 int gen_binop_sub() {
-  char address[32];
 
   emit_comment("Subtraction operation on stack (pop A, pop B, push A - B)");
 
@@ -170,22 +231,19 @@ int gen_binop_sub() {
   if (gen_pop_reg('A')) return -1;
 
   // pop from stack and subtract from rA
-  if (snprintf(address, sizeof(address), "STACK,%u", REG_SP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(NULL, "SUB", address, "rA " SYMB_ASSIGN " rA - STACK[SP]")) return -1;
+  if (gen_top_inst(NULL, "SUB", 0, "rA " SYMB_ASSIGN " rA - %s")) return -1;
 
   /* if this were a real stack machine, 
      it would decrement then increment SP by 1 here. 
      But that would be pointless to emulate and waste instruction cycles. */
   
   // write rA back to the stack
-  if (emit_inst(NULL, "STA", address, "STACK[SP] " SYMB_ASSIGN " rA")) return -1;
+  if (gen_top_inst(NULL, "STA", 0, "%s " SYMB_ASSIGN " rA")) return -1;
 
   return 0;
 }
 
 int gen_binop_mul() {
-  char address[32];
 
   emit_comment("Multiplication operation on stack (pop A, pop B, push A * B)");
 
@@ -193,46 +251,323 @@ int gen_binop_mul() {
   if (gen_pop_reg('A')) return -1;
 
   // pop from stack and multiply with rA
-  if (snprintf(address, sizeof(address), "STACK,%u", REG_SP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(NULL, "MUL", address, "rAX " SYMB_ASSIGN " rA * STACK[SP]")) return -1;
+  if (gen_top_inst(NULL, "MUL", 0, "rAX " SYMB_ASSIGN " rA * %s")) return -1;
 
   /* if this were a real stack machine, 
      it would decrement then increment SP by 1 here. 
      But that would be pointless to emulate and waste instruction cycles. */
 
   // write rX (low word of rAX) back to the stack
-  if (emit_inst(NULL, "STX", address, "STACK[SP] " SYMB_ASSIGN " rX")) return -1;
+  if (gen_top_inst(NULL, "STX", 0, "%s " SYMB_ASSIGN " rX")) return -1;
 
   return 0;
 }
 
 int gen_binop_div() {
-  char address[32];
 
   emit_comment("Division operation on stack (pop A, pop B, push A / B)");
 
-  // pop rAX from stack
-  if (emit_inst(NULL, "ENTA", "0", "rA <- 0")) return -1;
-  if (gen_pop_reg('X')) return -1;
+  // pop rAX from stack (rA keeps the sign of the dividend)
+  if (gen_pop_reg('A')) return -1;
+  if (emit_inst(NULL, "SRAX", "5", 0, NULL, "rAX " SYMB_ASSIGN " rA")) return -1;
 
   // pop from stack and divide rAX
-  if (snprintf(address, sizeof(address), "STACK,%u", REG_SP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(NULL, "DIV", address, "rA " SYMB_ASSIGN " rAX / STACK[SP]")) return -1;
+  if (gen_top_inst(NULL, "DIV", 0, "rA " SYMB_ASSIGN " rAX / %s")) return -1;
 
   /* if this were a real stack machine, 
      it would decrement then increment SP by 1 here. 
      But that would be pointless to emulate and waste instruction cycles. */
 
   // write rA (division result) back to the stack
-  if (emit_inst(NULL, "STA", address, "STACK[SP] " SYMB_ASSIGN " rA")) return -1;
+  if (gen_top_inst(NULL, "STA", 0, "%s " SYMB_ASSIGN " rA")) return -1;
 
   return 0;
 }
 
-int gen_relop_leq() {
+/* multiplication and division by a constant are compiled to the cheapest
+   of several candidate sequences, as measured by the MIX timing table */
+#define CONST_SEQ_MAX 16
+
+typedef struct {
+  const char *opcode;
   char address[32];
+  int index;
+  char comment[64];
+} ConstInst;
+
+typedef struct {
+  unsigned int n;
+  int invalid; // did not fit or could not be formatted
+  ConstInst inst[CONST_SEQ_MAX];
+} ConstSeq;
+
+static ConstInst *const_seq_next(ConstSeq *s) {
+  if (s->n >= CONST_SEQ_MAX) {
+    s->invalid = 1;
+    return NULL;
+  }
+
+  return &s->inst[s->n++];
+}
+
+static void const_seq_inst(ConstSeq *s, const char *opcode, long long value,
+                           const char *comment) {
+  ConstInst *i = const_seq_next(s);
+  if (i == NULL) return;
+
+  i->opcode = opcode;
+  i->index = 0;
+  if (snprintf(i->address, sizeof(i->address), "%lld", value)
+      >= (int)sizeof(i->address)) s->invalid = 1;
+  if (snprintf(i->comment, sizeof(i->comment), "%s", comment)
+      >= (int)sizeof(i->comment)) s->invalid = 1;
+}
+
+static void const_seq_literal(ConstSeq *s, const char *opcode, long long value,
+                              const char *comment) {
+  ConstInst *i = const_seq_next(s);
+  if (i == NULL) return;
+
+  i->opcode = opcode;
+  i->index = 0;
+  if (snprintf(i->address, sizeof(i->address), "=%lld=", value)
+      >= (int)sizeof(i->address)) s->invalid = 1;
+  if (snprintf(i->comment, sizeof(i->comment), "%s", comment)
+      >= (int)sizeof(i->comment)) s->invalid = 1;
+}
+
+/* instruction on a scratch word above the top of the stack,
+   the comment format takes the description of that word */
+static void const_seq_top(ConstSeq *s, const char *opcode, int offset,
+                          const char *comment_fmt) {
+  char desc[32];
+  ConstInst *i = const_seq_next(s);
+  if (i == NULL) return;
+
+  i->opcode = opcode;
+  if (gen_stack_top(offset, i->address, sizeof(i->address), &i->index,
+                    desc, sizeof(desc))) s->invalid = 1;
+  if (snprintf(i->comment, sizeof(i->comment), comment_fmt, desc)
+      >= (int)sizeof(i->comment)) s->invalid = 1;
+}
+
+static unsigned int const_seq_time(const ConstSeq *s) {
+  unsigned int time = 0;
+
+  for (unsigned int k = 0 ; k < s->n ; k++) {
+    const MixOpcode *op = mix_opcode_find(s->inst[k].opcode);
+    time += mix_opcode_time(op, op ? op->field : 0);
+  }
+
+  return time;
+}
+
+/* keep the candidate when it is strictly faster than the best one so far */
+static void const_seq_choose(ConstSeq *best, unsigned int *best_time, const ConstSeq *s) {
+  if (s->invalid) return;
+
+  unsigned int time = const_seq_time(s);
+  if (time < *best_time) {
+    *best = *s;
+    *best_time = time;
+  }
+}
+
+static int const_seq_emit(const ConstSeq *s) {
+  for (unsigned int k = 0 ; k < s->n ; k++) {
+    const ConstInst *i = &s->inst[k];
+    if (emit_inst(NULL, i->opcode, i->address, i->index, NULL, i->comment)) return -1;
+  }
+
+  return 0;
+}
+
+static long long gen_byte_power(unsigned int k) {
+  long long p = 1;
+  while (k-- > 0) p *= MIX_BYTE_SIZE;
+  return p;
+}
+
+/* |c| = MIX_BYTE_SIZE^k for some k, which is stored in *k */
+static int gen_is_byte_power(long long c, unsigned int *k) {
+  if (c < 0) c = -c;
+  if (c == 0) return 0;
+
+  *k = 0;
+  while (c % MIX_BYTE_SIZE == 0) {
+    c /= MIX_BYTE_SIZE;
+    *k += 1;
+  }
+
+  return c == 1 && *k < MIX_WORD_BYTES;
+}
+
+static void const_seq_negate(ConstSeq *s) {
+  const_seq_top(s, "STA", 1, "%s " SYMB_ASSIGN " rA");
+  const_seq_top(s, "LDAN", 1, "rA " SYMB_ASSIGN " -%s");
+}
+
+/* rA ← rA * c as additions of rA to itself, followed by a shift by the
+   powers of the byte size in c. With doubling the multiplier is taken
+   bit by bit, otherwise x is added |c| / MIX_BYTE_SIZE^k - 1 times.
+   The low word of the product wraps like the additions, so both agree */
+static void const_seq_mul_chain(ConstSeq *s, long long c, int doubling) {
+  char comment[64];
+  long long m = c < 0 ? -c : c;
+  unsigned int k = 0;
+
+  while (m % MIX_BYTE_SIZE == 0) {
+    m /= MIX_BYTE_SIZE;
+    k += 1;
+  }
+  if (k >= MIX_WORD_BYTES) {
+    s->invalid = 1;
+    return;
+  }
+
+  if (m > 1) {
+    const_seq_top(s, "STA", 1, "%s " SYMB_ASSIGN " x");
+
+    if (doubling) {
+      int high = 62;
+      while (!((m >> high) & 1)) high--;
+
+      long long acc = 1;
+      for (int bit = high - 1 ; bit >= 0 ; bit--) {
+        if (acc == 1) {
+          const_seq_top(s, "ADD", 1, "rA " SYMB_ASSIGN " 2x");
+        } else {
+          snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " %lldx", 2 * acc);
+          const_seq_top(s, "STA", 2, "%s " SYMB_ASSIGN " rA");
+          const_seq_top(s, "ADD", 2, comment);
+        }
+        acc *= 2;
+
+        if ((m >> bit) & 1) {
+          acc += 1;
+          snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " %lldx", acc);
+          const_seq_top(s, "ADD", 1, comment);
+        }
+      }
+    } else {
+      for (long long acc = 2 ; acc <= m && !s->invalid ; acc++) {
+        snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " %lldx", acc);
+        const_seq_top(s, "ADD", 1, comment);
+      }
+    }
+  }
+
+  if (k > 0) {
+    snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " rA * %lld", gen_byte_power(k));
+    const_seq_inst(s, "SLA", k, comment);
+  }
+
+  if (c < 0) const_seq_negate(s);
+}
+
+/* rA ← rA * c */
+static int gen_reg_mul_const(int c) {
+  char comment[64];
+  ConstSeq best = {0}, s;
+  unsigned int best_time;
+
+  snprintf(comment, sizeof(comment), "rAX " SYMB_ASSIGN " rA * %d", c);
+  const_seq_literal(&best, "MUL", c, comment);
+  const_seq_inst(&best, "SLAX", 5, "rA " SYMB_ASSIGN " rX");
+  if (best.invalid) return -1;
+  best_time = const_seq_time(&best);
+
+  if (c != 0 && (c < 0 ? -(long long)c : c) < gen_byte_power(MIX_WORD_BYTES)) {
+    for (int doubling = 0 ; doubling <= 1 ; doubling++) {
+      s = (ConstSeq){0};
+      const_seq_mul_chain(&s, c, doubling);
+      const_seq_choose(&best, &best_time, &s);
+    }
+  }
+
+  return const_seq_emit(&best);
+}
+
+/* rA ← rA / c, truncated towards zero like DIV */
+static int gen_reg_div_const(int c) {
+  char comment[64];
+  ConstSeq best = {0}, s;
+  unsigned int best_time;
+  unsigned int k;
+  long long word = gen_byte_power(MIX_WORD_BYTES);
+  long long d = c < 0 ? -(long long)c : c;
+
+  const_seq_inst(&best, "SRAX", 5, "rAX " SYMB_ASSIGN " rA");
+  snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " rAX / %d", c);
+  const_seq_literal(&best, "DIV", c, comment);
+  if (best.invalid) return -1;
+  best_time = const_seq_time(&best);
+
+  if (d == 0 || d >= word) return const_seq_emit(&best);
+
+  /* the magnitude is shifted and the sign kept, which is exactly
+     the truncated quotient of sign-magnitude division */
+  if (gen_is_byte_power(d, &k)) {
+    s = (ConstSeq){0};
+    if (k > 0) {
+      snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " rA / %lld", d);
+      const_seq_inst(&s, "SRA", k, comment);
+    }
+    if (c < 0) const_seq_negate(&s);
+    const_seq_choose(&best, &best_time, &s);
+  }
+
+  /* reciprocal multiplication: with m = ceil(B^(5+k) / d) the high word of
+     x * m shifted right by k bytes is floor(x / d) for every |x| < B^5 as
+     long as the rounding error e = m * d - B^(5+k) satisfies
+     e * (B^5 - 1) < B^(5+k). The sign of c is carried by m */
+  for (k = 0 ; k <= 2 ; k++) {
+    long long scale = word * gen_byte_power(k);
+    long long m = (scale + d - 1) / d;
+    long long e = m * d - scale;
+
+    if (m >= word) continue;
+    if (e > (scale - 1) / (word - 1)) continue;
+
+    s = (ConstSeq){0};
+    snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " rA * %lld / %lld",
+             c < 0 ? -m : m, word);
+    const_seq_literal(&s, "MUL", c < 0 ? -m : m, comment);
+    if (k > 0) {
+      snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " rA / %lld", gen_byte_power(k));
+      const_seq_inst(&s, "SRA", k, comment);
+    }
+    const_seq_choose(&best, &best_time, &s);
+  }
+
+  return const_seq_emit(&best);
+}
+
+int gen_binop_mul_const(int value) {
+
+  emit_comment("Multiplication by %d on stack (pop A, push A * %d)", value, value);
+
+  // operate on the top of the stack in place
+  if (gen_top_inst(NULL, "LDA", 0, "rA " SYMB_ASSIGN " %s")) return -1;
+  if (gen_reg_mul_const(value)) return -1;
+  if (gen_top_inst(NULL, "STA", 0, "%s " SYMB_ASSIGN " rA")) return -1;
+
+  return 0;
+}
+
+int gen_binop_div_const(int value) {
+
+  emit_comment("Division by %d on stack (pop A, push A / %d)", value, value);
+
+  // operate on the top of the stack in place
+  if (gen_top_inst(NULL, "LDA", 0, "rA " SYMB_ASSIGN " %s")) return -1;
+  if (gen_reg_div_const(value)) return -1;
+  if (gen_top_inst(NULL, "STA", 0, "%s " SYMB_ASSIGN " rA")) return -1;
+
+  return 0;
+}
+
+int gen_relop_leq() {
 
   emit_comment("Comparison operation (<=) on stack (pop A, pop B, push A <= B)");
 
@@ -240,27 +575,24 @@ int gen_relop_leq() {
   if (gen_pop_reg('A')) return -1;
 
   // pop from stack and compare with rA
-  if (snprintf(address, sizeof(address), "STACK,%u", REG_SP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(NULL, "CMPA", address, "CI " SYMB_ASSIGN " rA ? STACK[SP]")) return -1;
+  if (gen_top_inst(NULL, "CMPA", 0, "CI " SYMB_ASSIGN " rA ? %s")) return -1;
 
   /* if this were a real stack machine, 
      it would decrement SP by 1 here (...) */   
 
-  if (emit_inst(NULL, "ENTX", "1", "rX " SYMB_ASSIGN " 1")) return -1;
-  if (emit_inst(NULL, "JLE", "1F", "lhs <= rhs? continue")) return -1;
-  if (emit_inst(NULL, "ENTX", "0", "else, overwrite rX " SYMB_ASSIGN " 0")) return -1;
+  if (emit_inst(NULL, "ENTX", "1", 0, NULL, "rX " SYMB_ASSIGN " 1")) return -1;
+  if (emit_inst(NULL, "JLE", "1F", 0, NULL, "lhs <= rhs? continue")) return -1;
+  if (emit_inst(NULL, "ENTX", "0", 0, NULL, "else, overwrite rX " SYMB_ASSIGN " 0")) return -1;
 
   /* (...) then increment SP by 1 here.
      But that would be pointless to emulate and waste instruction cycles. */
 
-  if (emit_inst("1H", "STX", address, "STACK[SP] " SYMB_ASSIGN " rX")) return -1;
+  if (gen_top_inst("1H", "STX", 0, "%s " SYMB_ASSIGN " rX")) return -1;
 
   return 0;
 }
 
 int gen_relop_lt() {
-  char address[32];
 
   emit_comment("Comparison operation (<) on stack (pop A, pop B, push A < B)");
 
@@ -268,27 +600,24 @@ int gen_relop_lt() {
   if (gen_pop_reg('A')) return -1;
 
   // pop from stack and compare with rA
-  if (snprintf(address, sizeof(address), "STACK,%u", REG_SP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(NULL, "CMPA", address, "CI " SYMB_ASSIGN " rA ? STACK[SP]")) return -1;
+  if (gen_top_inst(NULL, "CMPA", 0, "CI " SYMB_ASSIGN " rA ? %s")) return -1;
 
   /* if this were a real stack machine, 
      it would decrement SP by 1 here (...) */   
 
-  if (emit_inst(NULL, "ENTX", "1", "rX " SYMB_ASSIGN " 1")) return -1;
-  if (emit_inst(NULL, "JL",  "1F", "lhs < rhs? continue")) return -1;
-  if (emit_inst(NULL, "ENTX", "0", "else, overwrite rX " SYMB_ASSIGN " 0")) return -1;
+  if (emit_inst(NULL, "ENTX", "1", 0, NULL, "rX " SYMB_ASSIGN " 1")) return -1;
+  if (emit_inst(NULL, "JL", "1F", 0, NULL, "lhs < rhs? continue")) return -1;
+  if (emit_inst(NULL, "ENTX", "0", 0, NULL, "else, overwrite rX " SYMB_ASSIGN " 0")) return -1;
 
   /* (...) then increment SP by 1 here.
      But that would be pointless to emulate and waste instruction cycles. */
 
-  if (emit_inst("1H", "STX", address, "STACK[SP] " SYMB_ASSIGN " rX")) return -1;
+  if (gen_top_inst("1H", "STX", 0, "%s " SYMB_ASSIGN " rX")) return -1;
 
   return 0;
 }
 
 int gen_relop_gt() {
-  char address[32];
 
   emit_comment("Comparison operation (>) on stack (pop A, pop B, push A > B)");
 
@@ -296,27 +625,24 @@ int gen_relop_gt() {
   if (gen_pop_reg('A')) return -1;
 
   // pop from stack and compare with rA
-  if (snprintf(address, sizeof(address), "STACK,%u", REG_SP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(NULL, "CMPA", address, "CI " SYMB_ASSIGN " rA ? STACK[SP]")) return -1;
+  if (gen_top_inst(NULL, "CMPA", 0, "CI " SYMB_ASSIGN " rA ? %s")) return -1;
 
   /* if this were a real stack machine, 
      it would decrement SP by 1 here (...) */   
 
-  if (emit_inst(NULL, "ENTX", "1", "rX " SYMB_ASSIGN " 1")) return -1;
-  if (emit_inst(NULL, "JG",  "1F", "lhs > rhs? continue")) return -1;
-  if (emit_inst(NULL, "ENTX", "0", "else, overwrite rX " SYMB_ASSIGN " 0")) return -1;
+  if (emit_inst(NULL, "ENTX", "1", 0, NULL, "rX " SYMB_ASSIGN " 1")) return -1;
+  if (emit_inst(NULL, "JG", "1F", 0, NULL, "lhs > rhs? continue")) return -1;
+  if (emit_inst(NULL, "ENTX", "0", 0, NULL, "else, overwrite rX " SYMB_ASSIGN " 0")) return -1;
 
   /* (...) then increment SP by 1 here.
      But that would be pointless to emulate and waste instruction cycles. */
 
-  if (emit_inst("1H", "STX", address, "STACK[SP] " SYMB_ASSIGN " rX")) return -1;
+  if (gen_top_inst("1H", "STX", 0, "%s " SYMB_ASSIGN " rX")) return -1;
 
   return 0;
 }
 
 int gen_relop_geq() {
-  char address[32];
 
   emit_comment("Comparison operation (>=) on stack (pop A, pop B, push A >= B)");
 
@@ -324,27 +650,24 @@ int gen_relop_geq() {
   if (gen_pop_reg('A')) return -1;
 
   // pop from stack and compare with rA
-  if (snprintf(address, sizeof(address), "STACK,%u", REG_SP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(NULL, "CMPA", address, "CI " SYMB_ASSIGN " rA ? STACK[SP]")) return -1;
+  if (gen_top_inst(NULL, "CMPA", 0, "CI " SYMB_ASSIGN " rA ? %s")) return -1;
 
   /* if this were a real stack machine, 
      it would decrement SP by 1 here (...) */   
 
-  if (emit_inst(NULL, "ENTX", "1", "rX " SYMB_ASSIGN " 1")) return -1;
-  if (emit_inst(NULL, "JGE", "1F", "lhs >= rhs? continue")) return -1;
-  if (emit_inst(NULL, "ENTX", "0", "else, overwrite rX " SYMB_ASSIGN " 0")) return -1;
+  if (emit_inst(NULL, "ENTX", "1", 0, NULL, "rX " SYMB_ASSIGN " 1")) return -1;
+  if (emit_inst(NULL, "JGE", "1F", 0, NULL, "lhs >= rhs? continue")) return -1;
+  if (emit_inst(NULL, "ENTX", "0", 0, NULL, "else, overwrite rX " SYMB_ASSIGN " 0")) return -1;
 
   /* (...) then increment SP by 1 here.
      But that would be pointless to emulate and waste instruction cycles. */
 
-  if (emit_inst("1H", "STX", address, "STACK[SP] " SYMB_ASSIGN " rX")) return -1;
+  if (gen_top_inst("1H", "STX", 0, "%s " SYMB_ASSIGN " rX")) return -1;
 
   return 0;
 }
 
 int gen_relop_eq() {
-  char address[32];
 
   emit_comment("Comparison operation (==) on stack (pop A, pop B, push A == B)");
 
@@ -352,27 +675,24 @@ int gen_relop_eq() {
   if (gen_pop_reg('A')) return -1;
 
   // pop from stack and compare with rA
-  if (snprintf(address, sizeof(address), "STACK,%u", REG_SP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(NULL, "CMPA", address, "CI " SYMB_ASSIGN " rA ? STACK[SP]")) return -1;
+  if (gen_top_inst(NULL, "CMPA", 0, "CI " SYMB_ASSIGN " rA ? %s")) return -1;
 
   /* if this were a real stack machine, 
      it would decrement SP by 1 here (...) */   
 
-  if (emit_inst(NULL, "ENTX", "1", "rX " SYMB_ASSIGN " 1")) return -1;
-  if (emit_inst(NULL, "JE",  "1F", "lhs == rhs? continue")) return -1;
-  if (emit_inst(NULL, "ENTX", "0", "else, overwrite rX " SYMB_ASSIGN " 0")) return -1;
+  if (emit_inst(NULL, "ENTX", "1", 0, NULL, "rX " SYMB_ASSIGN " 1")) return -1;
+  if (emit_inst(NULL, "JE", "1F", 0, NULL, "lhs == rhs? continue")) return -1;
+  if (emit_inst(NULL, "ENTX", "0", 0, NULL, "else, overwrite rX " SYMB_ASSIGN " 0")) return -1;
 
   /* (...) then increment SP by 1 here.
      But that would be pointless to emulate and waste instruction cycles. */
 
-  if (emit_inst("1H", "STX", address, "STACK[SP] " SYMB_ASSIGN " rX")) return -1;
+  if (gen_top_inst("1H", "STX", 0, "%s " SYMB_ASSIGN " rX")) return -1;
 
   return 0;
 }
 
 int gen_relop_neq() {
-  char address[32];
 
   emit_comment("Comparison operation (!=) on stack (pop A, pop B, push A != B)");
 
@@ -380,25 +700,436 @@ int gen_relop_neq() {
   if (gen_pop_reg('A')) return -1;
 
   // pop from stack and compare with rA
-  if (snprintf(address, sizeof(address), "STACK,%u", REG_SP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(NULL, "CMPA", address, "CI " SYMB_ASSIGN " rA ? STACK[SP]")) return -1;
+  if (gen_top_inst(NULL, "CMPA", 0, "CI " SYMB_ASSIGN " rA ? %s")) return -1;
 
   /* if this were a real stack machine, 
      it would decrement SP by 1 here (...) */   
 
-  if (emit_inst(NULL, "ENTX", "1", "rX " SYMB_ASSIGN " 1")) return -1;
-  if (emit_inst(NULL, "JNE", "1F", "lhs != rhs? continue")) return -1;
-  if (emit_inst(NULL, "ENTX", "0", "else, overwrite rX " SYMB_ASSIGN " 0")) return -1;
+  if (emit_inst(NULL, "ENTX", "1", 0, NULL, "rX " SYMB_ASSIGN " 1")) return -1;
+  if (emit_inst(NULL, "JNE", "1F", 0, NULL, "lhs != rhs? continue")) return -1;
+  if (emit_inst(NULL, "ENTX", "0", 0, NULL, "else, overwrite rX " SYMB_ASSIGN " 0")) return -1;
 
   /* (...) then increment SP by 1 here.
      But that would be pointless to emulate and waste instruction cycles. */
 
-  if (emit_inst("1H", "STX", address, "STACK[SP] " SYMB_ASSIGN " rX")) return -1;
+  if (gen_top_inst("1H", "STX", 0, "%s " SYMB_ASSIGN " rX")) return -1;
+
+  return 0;
+}
+
+static int gen_operand_address(const Operand *o, char *address, size_t addr_len, int *index,
+                               char *desc, size_t desc_len) {
+  switch (o->kind) {
+    case OPERAND_VAR:
+      *index = REG_FP;
+      if (snprintf(address, addr_len, "STACK%+d", o->value)
+          >= (int)addr_len) return -1;
+      if (snprintf(desc, desc_len, "%s", o->name)
+          >= (int)desc_len) return -1;
+      break;
+
+    case OPERAND_NUM:
+      *index = 0;
+      if (snprintf(address, addr_len, "=%d=", o->value)
+          >= (int)addr_len) return -1;
+      if (snprintf(desc, desc_len, "%d", o->value)
+          >= (int)desc_len) return -1;
+      break;
+
+    case OPERAND_STACK:
+      if (gen_stack_top(0, address, addr_len, index, desc, desc_len)) return -1;
+      break;
+  }
+
+  return 0;
+}
+
+/* a variable in an index register is stored to its frame word
+   before being used as the memory operand of an instruction */
+static int gen_operand_to_memory(const Operand *o) {
+  if (o->kind != OPERAND_VAR || o->reg == 0 || o->reg_home) return 0;
+  return gen_index_save(o->name, o->value, o->reg);
+}
+
+int gen_load_operand(const Operand *o) {
+  char address[32];
+  int index;
+  char desc[32];
+  char comment[64];
+
+  if (o->kind == OPERAND_VAR && o->reg) return gen_load_operand_sum(o, 0);
+
+  if (gen_operand_address(o, address, sizeof(address), &index, desc, sizeof(desc))) return -1;
+  if (snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " %s", desc)
+      >= (int)sizeof(comment)) return -1;
+  if (emit_inst(NULL, "LDA", address, index, NULL, comment)) return -1;
 
   return 0;
 }
 
+int gen_load_operand_neg(const Operand *o) {
+  char address[32];
+  int index;
+  char desc[32];
+  char comment[64];
+
+  if (o->kind == OPERAND_VAR && o->reg) {
+    if (snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " -%s " SYMB_EQUIV " -rI%d", o->name, o->reg)
+        >= (int)sizeof(comment)) return -1;
+    return emit_inst(NULL, "ENNA", "0", o->reg, NULL, comment);
+  }
+
+  if (gen_operand_address(o, address, sizeof(address), &index, desc, sizeof(desc))) return -1;
+  if (snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " -%s", desc)
+      >= (int)sizeof(comment)) return -1;
+  if (emit_inst(NULL, "LDAN", address, index, NULL, comment)) return -1;
+
+  return 0;
+}
+
+int gen_store_var(const char *var_name, int offset, int reg) {
+  char address[32];
+  char comment[64];
+
+  if (snprintf(address, sizeof(address), "STACK%+d", offset)
+      >= (int)sizeof(address)) return -1;
+  if (snprintf(comment, sizeof(comment), "STACK[FP%+d] " SYMB_EQUIV " %s " SYMB_ASSIGN " rA", offset, var_name)
+      >= (int)sizeof(comment)) return -1;
+  if (emit_inst(NULL, "STA", address, REG_FP, NULL, comment)) return -1;
+
+  // there is no move from rA to an index register, it goes through the frame word
+  if (reg) return gen_index_load(var_name, offset, reg);
+
+  return 0;
+}
+
+int gen_spill_reg() {
+  return gen_push_reg('A');
+}
+
+int gen_reg_unary_neg() {
+
+  // negate through the free word above the top of the stack
+  if (gen_top_inst(NULL, "STA", 1, "%s " SYMB_ASSIGN " rA")) return -1;
+  if (gen_top_inst(NULL, "LDAN", 1, "rA " SYMB_ASSIGN " -%s")) return -1;
+
+  return 0;
+}
+
+int gen_reg_binop(enum OpKind op, const Operand *rhs) {
+  static const char *relop_jump[] = {
+    [OP_RELOP_LEQ] = "JLE", [OP_RELOP_LT] = "JL",
+    [OP_RELOP_GT]  = "JG",  [OP_RELOP_GEQ] = "JGE",
+    [OP_RELOP_EQ]  = "JE",  [OP_RELOP_NEQ] = "JNE",
+  };
+
+  char address[32];
+  int index;
+  char desc[32];
+  char comment[64];
+
+  if (options.strength_reduce && rhs->kind == OPERAND_NUM) {
+    if (op == OP_MULOP_MUL) return gen_reg_mul_const(rhs->value);
+    if (op == OP_MULOP_DIV) return gen_reg_div_const(rhs->value);
+  }
+
+  if (gen_operand_to_memory(rhs)) return -1;
+  if (gen_operand_address(rhs, address, sizeof(address), &index, desc, sizeof(desc))) return -1;
+
+  switch (op) {
+    case OP_ADDOP_ADD:
+      if (snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " rA + %s", desc)
+          >= (int)sizeof(comment)) return -1;
+      if (emit_inst(NULL, "ADD", address, index, NULL, comment)) return -1;
+      break;
+
+    case OP_ADDOP_SUB:
+      if (snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " rA - %s", desc)
+          >= (int)sizeof(comment)) return -1;
+      if (emit_inst(NULL, "SUB", address, index, NULL, comment)) return -1;
+      break;
+
+    case OP_MULOP_MUL:
+      if (snprintf(comment, sizeof(comment), "rAX " SYMB_ASSIGN " rA * %s", desc)
+          >= (int)sizeof(comment)) return -1;
+      if (emit_inst(NULL, "MUL", address, index, NULL, comment)) return -1;
+      break;
+
+    case OP_MULOP_DIV:
+      if (emit_inst(NULL, "SRAX", "5", 0, NULL, "rAX " SYMB_ASSIGN " rA")) return -1;
+      if (snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " rAX / %s", desc)
+          >= (int)sizeof(comment)) return -1;
+      if (emit_inst(NULL, "DIV", address, index, NULL, comment)) return -1;
+      break;
+
+    case OP_RELOP_LEQ: case OP_RELOP_LT:
+    case OP_RELOP_GT:  case OP_RELOP_GEQ:
+    case OP_RELOP_EQ:  case OP_RELOP_NEQ:
+      if (snprintf(comment, sizeof(comment), "CI " SYMB_ASSIGN " rA ? %s", desc)
+          >= (int)sizeof(comment)) return -1;
+      if (emit_inst(NULL, "CMPA", address, index, NULL, comment)) return -1;
+      break;
+
+    default:
+      return -1;
+  }
+
+  // release the spilled operand (does not affect rA, rX or CI)
+  if (rhs->kind == OPERAND_STACK) {
+    if (gen_stack_release()) return -1;
+  }
+
+  switch (op) {
+    case OP_MULOP_MUL:
+      // move rX (low word of rAX) to rA
+      if (emit_inst(NULL, "SLAX", "5", 0, NULL, "rA " SYMB_ASSIGN " rX")) return -1;
+      break;
+
+    case OP_RELOP_LEQ: case OP_RELOP_LT:
+    case OP_RELOP_GT:  case OP_RELOP_GEQ:
+    case OP_RELOP_EQ:  case OP_RELOP_NEQ:
+      if (snprintf(comment, sizeof(comment), "lhs %s rhs? continue", op_kind_str[op])
+          >= (int)sizeof(comment)) return -1;
+      if (emit_inst(NULL, "ENTA", "1", 0, NULL, "rA " SYMB_ASSIGN " 1")) return -1;
+      if (emit_inst(NULL, relop_jump[op], "1F", 0, NULL, comment)) return -1;
+      if (emit_inst(NULL, "ENTA", "0", 0, NULL, "else, overwrite rA " SYMB_ASSIGN " 0")) return -1;
+      if (emit_label_next("1H")) return -1;
+      break;
+
+    default:
+      break;
+  }
+
+  return 0;
+}
+
+// conditional jumps taken when the comparison "lhs op rhs" is false
+static const char *relop_jump_false[] = {
+  [OP_RELOP_LEQ] = "JG",  [OP_RELOP_LT] = "JGE",
+  [OP_RELOP_GT]  = "JLE", [OP_RELOP_GEQ] = "JL",
+  [OP_RELOP_EQ]  = "JNE", [OP_RELOP_NEQ] = "JE",
+};
+
+// jumps on rA taken when the comparison "rA op 0" is false
+static const char *relop_zero_jump_false[] = {
+  [OP_RELOP_LEQ] = "JAP",  [OP_RELOP_LT] = "JANN",
+  [OP_RELOP_GT]  = "JANP", [OP_RELOP_GEQ] = "JAN",
+  [OP_RELOP_EQ]  = "JANZ", [OP_RELOP_NEQ] = "JAZ",
+};
+
+static int gen_is_relop(enum OpKind op) {
+  return op >= OP_RELOP_LEQ && op <= OP_RELOP_NEQ;
+}
+
+static int gen_jump_false(const char *jump, const char *l_break) {
+  char comment[64];
+
+  if (snprintf(comment, sizeof(comment), "cond = false? jump to %s", l_break)
+      >= (int)sizeof(comment)) return -1;
+  if (emit_inst(NULL, jump, l_break, 0, NULL, comment)) return -1;
+
+  return 0;
+}
+
+int gen_reg_branch_entry(const char *l_break) {
+  char comment[64];
+
+  // on condition fail, jump to l_break
+  if (snprintf(comment, sizeof(comment), "cond = false? jump to %s", l_break)
+      >= (int)sizeof(comment)) return -1;
+  if (emit_inst(NULL, "JAZ", l_break, 0, NULL, comment)) return -1;
+
+  return 0;
+}
+
+int gen_reg_branch_cmp(enum OpKind op, const Operand *rhs, const char *l_break) {
+  char address[32];
+  int index;
+  char desc[32];
+  char comment[64];
+
+  if (!gen_is_relop(op)) return -1;
+
+  if (gen_operand_to_memory(rhs)) return -1;
+  if (gen_operand_address(rhs, address, sizeof(address), &index, desc, sizeof(desc))) return -1;
+
+  if (snprintf(comment, sizeof(comment), "CI " SYMB_ASSIGN " rA ? %s", desc)
+      >= (int)sizeof(comment)) return -1;
+  if (emit_inst(NULL, "CMPA", address, index, NULL, comment)) return -1;
+
+  // release the spilled operand (does not affect CI)
+  if (rhs->kind == OPERAND_STACK) {
+    if (gen_stack_release()) return -1;
+  }
+
+  return gen_jump_false(relop_jump_false[op], l_break);
+}
+
+int gen_reg_branch_zero(enum OpKind op, const char *l_break) {
+  if (!gen_is_relop(op)) return -1;
+
+  return gen_jump_false(relop_zero_jump_false[op], l_break);
+}
+
+int gen_load_operand_sum(const Operand *o, int value) {
+  char address[32];
+  char comment[64];
+
+  if (o->kind != OPERAND_VAR || o->reg == 0) return -1;
+
+  if (snprintf(address, sizeof(address), "%d", value)
+      >= (int)sizeof(address)) return -1;
+  if (value == 0) {
+    if (snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " %s " SYMB_EQUIV " rI%d", o->name, o->reg)
+        >= (int)sizeof(comment)) return -1;
+  } else {
+    if (snprintf(comment, sizeof(comment), "rA " SYMB_ASSIGN " %s %c %d", o->name,
+                 value < 0 ? '-' : '+', value < 0 ? -value : value)
+        >= (int)sizeof(comment)) return -1;
+  }
+  if (emit_inst(NULL, "ENTA", address, o->reg, NULL, comment)) return -1;
+
+  return 0;
+}
+
+int gen_index_load(const char *var_name, int offset, int reg) {
+  char inst[8];
+  char address[32];
+  char comment[64];
+
+  if (snprintf(inst, sizeof(inst), "LD%c", CHAR(reg))
+      >= (int)sizeof(inst)) return -1;
+  if (snprintf(address, sizeof(address), "STACK%+d", offset)
+      >= (int)sizeof(address)) return -1;
+  if (snprintf(comment, sizeof(comment), "rI%d " SYMB_EQUIV " %s " SYMB_ASSIGN " STACK[FP%+d]", reg, var_name, offset)
+      >= (int)sizeof(comment)) return -1;
+  if (emit_inst(NULL, inst, address, REG_FP, NULL, comment)) return -1;
+
+  return 0;
+}
+
+int gen_index_save(const char *var_name, int offset, int reg) {
+  char inst[8];
+  char address[32];
+  char comment[64];
+
+  if (snprintf(inst, sizeof(inst), "ST%c", CHAR(reg))
+      >= (int)sizeof(inst)) return -1;
+  if (snprintf(address, sizeof(address), "STACK%+d", offset)
+      >= (int)sizeof(address)) return -1;
+  if (snprintf(comment, sizeof(comment), "STACK[FP%+d] " SYMB_ASSIGN " %s " SYMB_EQUIV " rI%d", offset, var_name, reg)
+      >= (int)sizeof(comment)) return -1;
+  if (emit_inst(NULL, inst, address, REG_FP, NULL, comment)) return -1;
+
+  return 0;
+}
+
+int gen_index_inc(const char *var_name, int reg, int value) {
+  char inst[8];
+  char address[32];
+  char comment[64];
+
+  if (value == 0) return 0;
+
+  if (snprintf(inst, sizeof(inst), "%s%c", value < 0 ? "DEC" : "INC", CHAR(reg))
+      >= (int)sizeof(inst)) return -1;
+  if (snprintf(address, sizeof(address), "%d", value < 0 ? -value : value)
+      >= (int)sizeof(address)) return -1;
+  if (snprintf(comment, sizeof(comment), "rI%d " SYMB_EQUIV " %s " SYMB_ASSIGN " %s %c %d", reg, var_name,
+               var_name, value < 0 ? '-' : '+', value < 0 ? -value : value)
+      >= (int)sizeof(comment)) return -1;
+  if (emit_inst(NULL, inst, address, 0, NULL, comment)) return -1;
+
+  return 0;
+}
+
+int gen_index_set(const char *var_name, int reg, const Operand *src, int value) {
+  char inst[8];
+  char address[32];
+  char comment[64];
+
+  switch (src->kind) {
+    case OPERAND_NUM:
+      if (snprintf(inst, sizeof(inst), "ENT%c", CHAR(reg))
+          >= (int)sizeof(inst)) return -1;
+      if (snprintf(address, sizeof(address), "%d", src->value + value)
+          >= (int)sizeof(address)) return -1;
+      if (snprintf(comment, sizeof(comment), "rI%d " SYMB_EQUIV " %s " SYMB_ASSIGN " %d", reg, var_name,
+                   src->value + value)
+          >= (int)sizeof(comment)) return -1;
+      return emit_inst(NULL, inst, address, 0, NULL, comment);
+
+    case OPERAND_VAR:
+      // the source shares the register when it is not used afterwards
+      if (src->reg == reg) return gen_index_inc(var_name, reg, value);
+
+      if (src->reg) {
+        if (snprintf(inst, sizeof(inst), "ENT%c", CHAR(reg))
+            >= (int)sizeof(inst)) return -1;
+        if (snprintf(address, sizeof(address), "%d", value)
+            >= (int)sizeof(address)) return -1;
+        if (value == 0) {
+          if (snprintf(comment, sizeof(comment), "rI%d " SYMB_EQUIV " %s " SYMB_ASSIGN " %s", reg, var_name,
+                       src->name)
+              >= (int)sizeof(comment)) return -1;
+        } else {
+          if (snprintf(comment, sizeof(comment), "rI%d " SYMB_EQUIV " %s " SYMB_ASSIGN " %s %c %d", reg,
+                       var_name, src->name, value < 0 ? '-' : '+', value < 0 ? -value : value)
+              >= (int)sizeof(comment)) return -1;
+        }
+        return emit_inst(NULL, inst, address, src->reg, NULL, comment);
+      }
+
+      if (snprintf(inst, sizeof(inst), "LD%c", CHAR(reg))
+          >= (int)sizeof(inst)) return -1;
+      if (snprintf(address, sizeof(address), "STACK%+d", src->value)
+          >= (int)sizeof(address)) return -1;
+      if (snprintf(comment, sizeof(comment), "rI%d " SYMB_EQUIV " %s " SYMB_ASSIGN " %s", reg, var_name,
+                   src->name)
+          >= (int)sizeof(comment)) return -1;
+      if (emit_inst(NULL, inst, address, REG_FP, NULL, comment)) return -1;
+
+      return gen_index_inc(var_name, reg, value);
+
+    default:
+      return -1;
+  }
+}
+
+int gen_index_branch_cmp(enum OpKind op, const Operand *lhs, const Operand *rhs,
+                         const char *l_break) {
+  char inst[8];
+  char address[32];
+  int index;
+  char desc[32];
+  char comment[64];
+
+  if (!gen_is_relop(op) || lhs->kind != OPERAND_VAR || lhs->reg == 0) return -1;
+
+  if (gen_operand_to_memory(rhs)) return -1;
+  if (gen_operand_address(rhs, address, sizeof(address), &index, desc, sizeof(desc))) return -1;
+
+  if (snprintf(inst, sizeof(inst), "CMP%c", CHAR(lhs->reg))
+      >= (int)sizeof(inst)) return -1;
+  if (snprintf(comment, sizeof(comment), "CI " SYMB_ASSIGN " %s ? %s", lhs->name, desc)
+      >= (int)sizeof(comment)) return -1;
+  if (emit_inst(NULL, inst, address, index, NULL, comment)) return -1;
+
+  return gen_jump_false(relop_jump_false[op], l_break);
+}
+
+int gen_index_branch_zero(enum OpKind op, const Operand *o, const char *l_break) {
+  char jump[8];
+
+  if (!gen_is_relop(op) || o->kind != OPERAND_VAR || o->reg == 0) return -1;
+
+  // JAP, JANN, ... on the index register: J1P, J1NN, ...
+  if (snprintf(jump, sizeof(jump), "J%c%s", CHAR(o->reg), relop_zero_jump_false[op] + 2)
+      >= (int)sizeof(jump)) return -1;
+
+  return gen_jump_false(jump, l_break);
+}
+
 int gen_branch_label(const char *label) {
   // create label at location
   return emit_label(label);
@@ -415,18 +1146,46 @@ int gen_branch_entry(const char *l_break) {
   // on condition fail, jump to l_break
   if (snprintf(comment, sizeof(comment), "cond = false? jump to %s", l_break)
       >= (int)sizeof(comment)) return -1;
-  if (emit_inst(NULL, "JAZ", l_break, comment)) return -1;
+  if (emit_inst(NULL, "JAZ", l_break, 0, NULL, comment)) return -1;
 
   return 0;
 }
 
+int gen_branch_cmp(enum OpKind op, const char *l_break) {
+  if (!gen_is_relop(op)) return -1;
+
+  emit_comment("Comparison branch (%s) on stack (pop A, pop B, jump unless A %s B)",
+               op_kind_str[op], op_kind_str[op]);
+
+  // pop rA from stack
+  if (gen_pop_reg('A')) return -1;
+
+  // pop from stack and compare with rA
+  if (gen_top_inst(NULL, "CMPA", 0, "CI " SYMB_ASSIGN " rA ? %s")) return -1;
+  if (gen_stack_release()) return -1;
+
+  return gen_jump_false(relop_jump_false[op], l_break);
+}
+
+int gen_branch_zero(enum OpKind op, const char *l_break) {
+  if (!gen_is_relop(op)) return -1;
+
+  emit_comment("Comparison branch (%s 0) on stack (pop A, jump unless A %s 0)",
+               op_kind_str[op], op_kind_str[op]);
+
+  // pop rA from stack
+  if (gen_pop_reg('A')) return -1;
+
+  return gen_jump_false(relop_zero_jump_false[op], l_break);
+}
+
 int gen_branch_jmp(const char *l_continue) {
   char comment[64];
 
   // jump to l_continue
   if (snprintf(comment, sizeof(comment), "jump to %s", l_continue)
       >= (int)sizeof(comment)) return -1;
-  if (emit_inst(NULL, "JMP", l_continue, comment)) return -1;
+  if (emit_inst(NULL, "JMP", l_continue, 0, NULL, comment)) return -1;
 
   return 0;
 }
@@ -436,34 +1195,87 @@ int gen_branch_break(const char *l_done) {
   return gen_branch_jmp(l_done);
 }
 
-int gen_method_entry(const char *method_name, const char *label, unsigned int n_locals) {
+// conditional jumps and their opposites
+static const char *jump_negated[][2] = {
+  {"JL", "JGE"}, {"JE", "JNE"}, {"JG", "JLE"},
+  {"JGE", "JL"}, {"JNE", "JE"}, {"JLE", "JG"},
+};
+
+// conditions of the jumps on a register: JAN, J1NZ, ...
+static const char *reg_jump_negated[][2] = {
+  {"N", "NN"}, {"Z", "NZ"}, {"P", "NP"},
+  {"NN", "N"}, {"NZ", "Z"}, {"NP", "P"},
+};
+
+int gen_branch_negate(const char *l_true) {
+  MixInst *jump = mixcode.tail;
+  char opcode[INST_OPCODE_LEN + 1] = "";
+  char comment[64];
+
+  // the jump to l_break just emitted by a condition
+  if (jump == NULL || jump->kind != INST_OP || jump->opcode[0] != 'J') return -1;
+
+  for (size_t k = 0 ; k < sizeof(jump_negated) / sizeof(jump_negated[0]) ; k++) {
+    if (strcmp(jump->opcode, jump_negated[k][0]) == 0) strcpy(opcode, jump_negated[k][1]);
+  }
+
+  if (opcode[0] == '\0' && jump->opcode[1] != '\0' && strchr("AX123456", jump->opcode[1])) {
+    for (size_t k = 0 ; k < sizeof(reg_jump_negated) / sizeof(reg_jump_negated[0]) ; k++) {
+      if (strcmp(jump->opcode + 2, reg_jump_negated[k][0]) == 0) {
+        snprintf(opcode, sizeof(opcode), "J%c%s", jump->opcode[1], reg_jump_negated[k][1]);
+      }
+    }
+  }
+
+  if (opcode[0] == '\0' || strlen(l_true) >= sizeof(jump->address)) return -1;
+
+  if (snprintf(comment, sizeof(comment), "cond = true? jump to %s", l_true)
+      >= (int)sizeof(comment)) return -1;
+
+  char *c = strdup(comment);
+  if (c == NULL) return -1;
+
+  free(jump->comment);
+  jump->comment = c;
+  strcpy(jump->opcode, opcode);
+  strcpy(jump->address, l_true);
+
+  return 0;
+}
+
+int gen_method_entry(const char *method_name, const char *label,
+                     unsigned int n_locals, unsigned int n_temps) {
   char address[32];
   char comment[64];
 
-  emit_comment("Subroutine %s entry (store RA & FP, FP " SYMB_ASSIGN " SP, alloc n_locals)",
-               method_name);
+  frame_static = options.static_frame;
+  frame_base = n_locals;
+  frame_depth = 0;
+
+  if (frame_static) {
+    emit_comment("Subroutine %s entry (store RA & FP, FP " SYMB_ASSIGN " SP, alloc n_locals + n_temps)",
+                 method_name);
+    n_locals += n_temps;
+  } else {
+    emit_comment("Subroutine %s entry (store RA & FP, FP " SYMB_ASSIGN " SP, alloc n_locals)",
+                 method_name);
+  }
   
   // push RA to stack
-  if (snprintf(address, sizeof(address), "STACK+1,%u", REG_SP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(label, "STJ", address, "STACK[SP+1] " SYMB_ASSIGN " RA " SYMB_EQUIV " rJ")) return -1;
+  if (emit_inst(label, "STJ", "STACK+1", REG_SP, NULL, "STACK[SP+1] " SYMB_ASSIGN " RA " SYMB_EQUIV " rJ")) return -1;
 
   // push FP to stack
-  if (snprintf(address, sizeof(address), "STACK+2,%u(0:2)", REG_SP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(NULL, ST(REG_FP), address, "STACK[SP+2] " SYMB_ASSIGN " FP")) return -1;
+  if (emit_inst(NULL, ST(REG_FP), "STACK+2", REG_SP, "0:2", "STACK[SP+2] " SYMB_ASSIGN " FP")) return -1;
 
   // set FP ← SP
-  if (snprintf(address, sizeof(address), "2,%u", REG_SP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(NULL, ENT(REG_FP), address, "FP " SYMB_ASSIGN " SP + 2")) return -1;
+  if (emit_inst(NULL, ENT(REG_FP), "2", REG_SP, NULL, "FP " SYMB_ASSIGN " SP + 2")) return -1;
 
   // allocate stack space for n_locals
   if (snprintf(address, sizeof(address), "%u", n_locals + 2)
       >= (int)sizeof(address)) return -1;
   if (snprintf(comment, sizeof(comment), "SP " SYMB_ASSIGN " SP + %u", n_locals + 2)
       >= (int)sizeof(comment)) return -1;
-  if (emit_inst(NULL, INC(REG_SP), address, comment)) return -1;
+  if (emit_inst(NULL, INC(REG_SP), address, 0, NULL, comment)) return -1;
 
   return 0;
 }
@@ -475,129 +1287,204 @@ int gen_method_exit(const char *method_name, unsigned int n_params) {
   emit_comment("Subroutine %s exit (restore FP & SP, dealloc params, push result, jump to RA)",
                method_name);
 
-  // pop result from stack
-  if (snprintf(address, sizeof(address), "STACK,%u", REG_SP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst("9H", "LDA", address, "rA " SYMB_ASSIGN " result " SYMB_EQUIV " STACK[SP]")) return -1;
-  if (emit_inst(NULL, DEC(REG_SP), "1", "SP " SYMB_ASSIGN " SP - 1")) return -1;
+  if (options.register_expr) {
+    // result is already in rA
+    if (emit_label_next("9H")) return -1;
+  } else if (frame_static) {
+    // result is in the first temporary
+    if (gen_top_inst("9H", "LDA", 1, "rA " SYMB_ASSIGN " result " SYMB_EQUIV " %s")) return -1;
+  } else {
+    // pop result from stack
+    if (emit_inst("9H", "LDA", "STACK", REG_SP, NULL, "rA " SYMB_ASSIGN " result " SYMB_EQUIV " STACK[SP]")) return -1;
+    if (emit_inst(NULL, DEC(REG_SP), "1", 0, NULL, "SP " SYMB_ASSIGN " SP - 1")) return -1;
+  }
+
+  // the result is pushed on the stack of the caller
+  frame_static = 0;
 
   // set SP ← FP (dealloc locals)
-  if (snprintf(address, sizeof(address), "0,%u", REG_FP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(NULL, ENT(REG_SP), address, "SP " SYMB_ASSIGN " FP")) return -1;
+  if (emit_inst(NULL, ENT(REG_SP), "0", REG_FP, NULL, "SP " SYMB_ASSIGN " FP")) return -1;
 
   // pop FP
-  if (snprintf(address, sizeof(address), "STACK,%u(0:2)", REG_FP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(NULL, LD(REG_FP), address, "FP " SYMB_ASSIGN " old FP " SYMB_EQUIV " STACK[SP]")) return -1;
+  if (emit_inst(NULL, LD(REG_FP), "STACK", REG_FP, "0:2", "FP " SYMB_ASSIGN " old FP " SYMB_EQUIV " STACK[SP]")) return -1;
 
   // pop RA
-  if (snprintf(address, sizeof(address), "STACK-1,%u(0:2)", REG_SP)
-      >= (int)sizeof(address)) return -1;
-  if (emit_inst(NULL, "LD4", address, "rI4 " SYMB_ASSIGN " RA " SYMB_EQUIV " STACK[SP-1]")) return -1;
+  if (emit_inst(NULL, "LD4", "STACK-1", REG_SP, "0:2", "rI4 " SYMB_ASSIGN " RA " SYMB_EQUIV " STACK[SP-1]")) return -1;
 
   // deallocate stack space for n_params
   if (snprintf(address, sizeof(address), "%u", n_params + 2)
       >= (int)sizeof(address)) return -1;
   if (snprintf(comment, sizeof(comment), "SP " SYMB_ASSIGN " SP - %u", n_params + 2)
       >= (int)sizeof(comment)) return -1;
-  if (emit_inst(NULL, DEC(REG_SP), address, comment)) return -1;
+  if (emit_inst(NULL, DEC(REG_SP), address, 0, NULL, comment)) return -1;
 
   // push result to stack
-  if (gen_push_reg('A')) return -1;
+  if (!options.register_expr && gen_push_reg('A')) return -1;
 
   // return to RA
-  if (emit_inst(NULL, "JMP", "0,4", "jump to RA")) return -1;
+  if (emit_inst(NULL, "JMP", "0", 4, NULL, "jump to RA")) return -1;
 
   return 0;
 }
 
 int gen_method_return() {
-  emit_comment("Return from subroutine (return value is top of the stack)");
-  if (emit_inst(NULL, "JMP", "9F", "jump to method exit")) return -1;
+  if (options.register_expr) {
+    emit_comment("Return from subroutine (return value is in rA)");
+  } else {
+    emit_comment("Return from subroutine (return value is top of the stack)");
+  }
+  if (emit_inst(NULL, "JMP", "9F", 0, NULL, "jump to method exit")) return -1;
+
+  // the method exit pops the result
+  if (frame_static && !options.register_expr) frame_depth -= 1;
+
   return 0;
 }
 
-int gen_method_call(const char *method_name, const char *label) {
+int gen_method_call(const char *method_name, const char *label, unsigned int n_params) {
+  char address[32];
   char comment[64];
 
   emit_comment("Call method %s (pop params, push result)", method_name);
 
+  if (frame_static) {
+    // SP is only needed by the callee, pointing at the last argument
+    unsigned int k = frame_base + frame_depth;
+
+    if (snprintf(address, sizeof(address), "%u", k)
+        >= (int)sizeof(address)) return -1;
+    if (snprintf(comment, sizeof(comment), "SP " SYMB_ASSIGN " FP + %u", k)
+        >= (int)sizeof(comment)) return -1;
+    if (emit_inst(NULL, ENT(REG_SP), address, REG_FP, NULL, comment)) return -1;
+  }
+
   if (snprintf(comment, sizeof(comment), "jump to %s " SYMB_EQUIV " %s", label, method_name)
       >= (int)sizeof(comment)) return -1;
-  if (emit_inst(NULL, "JMP", label, comment)) return -1;
+  if (emit_inst(NULL, "JMP", label, 0, NULL, comment)) return -1;
+
+  if (frame_static) {
+    // the callee pops the arguments and pushes the result in stack mode
+    frame_depth -= n_params;
+    if (!options.register_expr) frame_depth += 1;
+  }
 
   return 0;
 }
 
+int gen_tail_call(const char *method_name, const char *l_restart) {
+  emit_comment("Tail call to %s (parameters updated, restart the body)", method_name);
+  return gen_branch_jmp(l_restart);
+}
+
+// address of the first word of code
+static unsigned int code_origin = 0;
+
 int gen_program_prologue(const char *entry_label, const char *main_label, unsigned int origin) {
   char address[32];
   char comment[64];
 
+  code_origin = origin;
+
   if (snprintf(address, sizeof(address), "%d", origin)
       >= (int)sizeof(address)) return -1;
 
   emit_comment("Constants and memory locations");
-  if (emit_inst("TTY", "EQU", "19", NULL)) return -1;
-  if (emit_inst("BUFFER", "EQU", "3800", NULL)) return -1;
-  if (emit_inst("STACK", "EQU", address, NULL)) return -1;
+  if (emit_inst("TTY", "EQU", "19", 0, NULL, NULL)) return -1;
+  if (emit_inst("BUFFER", "EQU", XSTR(BUFFER_ADDR), 0, NULL, NULL)) return -1;
+  if (emit_inst("STACK", "EQU", address, 0, NULL, NULL)) return -1;
 
   emit_comment("Program entry, initializes SP, FP and jumps to main");
 
   // set origin address
-  if (emit_inst(NULL, "ORIG", address, NULL)) return -1;
+  if (emit_inst(NULL, "ORIG", address, 0, NULL, NULL)) return -1;
 
   // initialize SP and FP
-  if (emit_inst(entry_label, ENT(REG_FP), "-STACK", "FP " SYMB_ASSIGN " 0")) return -1;
-  if (emit_inst(NULL,        ENT(REG_SP), "-STACK", "SP " SYMB_ASSIGN " 0")) return -1;
+  if (emit_inst(entry_label, ENT(REG_FP), "-STACK", 0, NULL, "FP " SYMB_ASSIGN " 0")) return -1;
+  if (emit_inst(NULL,        ENT(REG_SP), "-STACK", 0, NULL, "SP " SYMB_ASSIGN " 0")) return -1;
 
   // jump to main
   if (snprintf(comment, sizeof(comment), "jump to main " SYMB_EQUIV " %s", main_label)
       >= (int)sizeof(comment)) return -1;
-  if (emit_inst(NULL, "JMP", main_label, comment)) return -1;
+  if (emit_inst(NULL, "JMP", main_label, 0, NULL, comment)) return -1;
 
-  emit_comment("Pop result from stack and print");
+  if (options.register_expr) {
+    emit_comment("Print result");
+  } else {
+    emit_comment("Pop result from stack and print");
 
-  // pop return value 
-  if (gen_pop_reg('A')) return -1;
+    // pop return value 
+    if (gen_pop_reg('A')) return -1;
+  }
 
   // convert to char and store in buffer
-  if (emit_inst(NULL, "CHAR", NULL, NULL)) return -1;
-  if (emit_inst(NULL, "STA", "BUFFER+7", "high byte of result")) return -1;
-  if (emit_inst(NULL, "STX", "BUFFER+8", "low byte of result")) return -1;
+  if (emit_inst(NULL, "CHAR", NULL, 0, NULL, NULL)) return -1;
+  if (emit_inst(NULL, "STA", "BUFFER+7", 0, NULL, "high byte of result")) return -1;
+  if (emit_inst(NULL, "STX", "BUFFER+8", 0, NULL, "low byte of result")) return -1;
+
+  // CHAR keeps the sign of rA, print it as '-' before the digits
+  if (emit_inst(NULL, "JANN", "1F", 0, NULL, "result >= 0? no sign")) return -1;
+  if (emit_inst(NULL, "ENTA", "45", 0, NULL, "rA " SYMB_ASSIGN " '-'")) return -1;
+  if (emit_inst(NULL, "STA", "BUFFER+6", 0, "5:5", "sign of result")) return -1;
+  if (emit_label_next("1H")) return -1;
 
   // print to TTY
-  if (emit_inst(NULL, "OUT", "BUFFER(TTY)", "print to TTY")) return -1;
-  if (emit_inst(NULL, "JBUS", "*(TTY)", "wait until printed")) return -1;
+  if (emit_inst(NULL, "OUT", "BUFFER", 0, "TTY", "print to TTY")) return -1;
+  if (emit_inst(NULL, "JBUS", "*", 0, "TTY", "wait until printed")) return -1;
 
   emit_comment("Halt execution");
 
   // halt execution
-  if (emit_inst(NULL, "HLT", NULL, NULL)) return -1;
+  if (emit_inst(NULL, "HLT", NULL, 0, NULL, NULL)) return -1;
 
   return 0;
 }
 
 int gen_program_epilogue(const char *entry_label) {
   emit_comment("Initial contents of buffer");
-  if (emit_inst(NULL, "ORIG", "BUFFER", NULL)) return -1;
-  if (emit_inst(NULL, "ALF", "\"RETUR\"", NULL)) return -1;
-  if (emit_inst(NULL, "ALF", "\"N VAL\"", NULL)) return -1;
-  if (emit_inst(NULL, "ALF", "\"UE OF\"", NULL)) return -1;
-  if (emit_inst(NULL, "ALF", "\" MAIN\"", NULL)) return -1;
-  if (emit_inst(NULL, "ALF", "\" FUNC\"", NULL)) return -1;
-  if (emit_inst(NULL, "ALF", "\"TION:\"", NULL)) return -1;
-  if (emit_inst(NULL, "ALF", "\"     \"", NULL)) return -1;
-  if (emit_inst(NULL, "ALF", "\"     \"", NULL)) return -1;
-  if (emit_inst(NULL, "ALF", "\"     \"", NULL)) return -1;
-  if (emit_inst(NULL, "ALF", "\"     \"", NULL)) return -1;
-  if (emit_inst(NULL, "ALF", "\"     \"", NULL)) return -1;
-  if (emit_inst(NULL, "ALF", "\"     \"", NULL)) return -1;
-  if (emit_inst(NULL, "ALF", "\"     \"", NULL)) return -1;
-  if (emit_inst(NULL, "ALF", "\"     \"", NULL)) return -1;
+  if (emit_inst(NULL, "ORIG", "BUFFER", 0, NULL, NULL)) return -1;
+  if (emit_inst(NULL, "ALF", "\"RETUR\"", 0, NULL, NULL)) return -1;
+  if (emit_inst(NULL, "ALF", "\"N VAL\"", 0, NULL, NULL)) return -1;
+  if (emit_inst(NULL, "ALF", "\"UE OF\"", 0, NULL, NULL)) return -1;
+  if (emit_inst(NULL, "ALF", "\" MAIN\"", 0, NULL, NULL)) return -1;
+  if (emit_inst(NULL, "ALF", "\" FUNC\"", 0, NULL, NULL)) return -1;
+  if (emit_inst(NULL, "ALF", "\"TION:\"", 0, NULL, NULL)) return -1;
+  if (emit_inst(NULL, "ALF", "\"     \"", 0, NULL, NULL)) return -1;
+  if (emit_inst(NULL, "ALF", "\"     \"", 0, NULL, NULL)) return -1;
+  if (emit_inst(NULL, "ALF", "\"     \"", 0, NULL, NULL)) return -1;
+  if (emit_inst(NULL, "ALF", "\"     \"", 0, NULL, NULL)) return -1;
+  if (emit_inst(NULL, "ALF", "\"     \"", 0, NULL, NULL)) return -1;
+  if (emit_inst(NULL, "ALF", "\"     \"", 0, NULL, NULL)) return -1;
+  if (emit_inst(NULL, "ALF", "\"     \"", 0, NULL, NULL)) return -1;
+  if (emit_inst(NULL, "ALF", "\"     \"", 0, NULL, NULL)) return -1;
 
   emit_comment("Program end, begin execution at %s", entry_label);
-  if (emit_inst(NULL, "END", entry_label, NULL)) return -1;
+  if (emit_inst(NULL, "END", entry_label, 0, NULL, NULL)) return -1;
+
+  return 0;
+}
+
+int gen_check_code_size(const InstList *l) {
+  unsigned int words = 0;
+  int code = 0;
+
+  // the code runs from the first ORIG to the next, that of the buffer
+  for (const MixInst *i = l->head ; i != NULL ; i = i->next) {
+    if (i->kind != INST_OP) continue;
+
+    if (inst_is(i, "ORIG")) {
+      if (code) break;
+      code = 1;
+    } else if (code && !inst_is(i, "EQU") && !inst_is(i, "END")) {
+      words += 1;
+    }
+  }
+
+  if (code_origin + words > BUFFER_ADDR) {
+    fprintf(stderr, "error: the generated code takes %u words, more than the %u "
+            "between its origin at %u and the output buffer at %u\n",
+            words, BUFFER_ADDR - code_origin, code_origin, BUFFER_ADDR);
+    return -1;
+  }
 
   return 0;
 }
@@ -3,11 +3,24 @@
 #include "ast.h"
 #include "table.h"
 #include "label.h"
+#include "options.h"
+#include "emit.h"
+#include "tail.h"
+#include "regalloc.h"
+
+#include <string.h>
 
 #define ORIGIN_ADDR 3000
 
+// largest while condition copied in front of a rotated loop, in AST nodes
+#define ROTATE_COPY_LIMIT 7
+
 unsigned int branch_index = 1;
 
+// method being generated and where its self tail calls jump to
+static const ASTNode *current_method = NULL;
+static char *restart_label = NULL;
+
 static int _gen_mixal_from_ast_node(const ASTNode *n, const HashTable *gt, 
                                     const HashTable *lt, const char *break_label);
 
@@ -17,6 +30,27 @@ static int _gen_mixal_from_ast_list(const ASTList *l, const HashTable *gt,
 static int _gen_mixal_from_ast_list_reverse(const ASTList *l, const HashTable *gt,
                                             const HashTable *lt, const char *break_label);
 
+static int _gen_mixal_from_ast_expr(const ASTNode *n, const HashTable *gt, const HashTable *lt);
+
+static int _gen_mixal_from_ast_args(const ASTList *l, const HashTable *gt, const HashTable *lt);
+
+static int _gen_mixal_from_ast_cond(const ASTNode *n, const HashTable *gt,
+                                    const HashTable *lt, const char *l_false);
+
+static int _gen_mixal_from_ast_rotated(const ASTNode *n, const HashTable *gt,
+                                       const HashTable *lt, unsigned int index,
+                                       const char *loop_label, const char *done_label);
+
+static int _gen_mixal_from_ast_tail_call(const ASTNode *n, const HashTable *gt,
+                                         const HashTable *lt);
+
+static int _gen_mixal_from_ast_assign(const char *name, const ASTNode *rhs,
+                                      const HashTable *gt, const HashTable *lt);
+
+static int _gen_mixal_from_ast_call(const ASTNode *n, const HashTable *gt, const HashTable *lt);
+
+static int _gen_index_params(const ASTNode *method, const HashTable *lt);
+
 int gen_mixal_from_ast(const ASTNode *root, const HashTable *gt) {
   return _gen_mixal_from_ast_node(root, gt, NULL, NULL);
 }
@@ -26,6 +60,10 @@ static int _gen_mixal_from_ast_node(const ASTNode *n, const HashTable *gt,
   if (n != NULL) {
     const TableEntry *e = NULL;
 
+    // attribute the generated instructions to this node
+    YYLTYPE parent_loc = emit_get_loc();
+    emit_set_loc(n->loc);
+
     switch(n->kind) {
       case N_PROGRAM:
         e = ht_find_entry(gt, "main");
@@ -38,14 +76,32 @@ static int _gen_mixal_from_ast_node(const ASTNode *n, const HashTable *gt,
       case N_METHOD:
         e = ht_find_entry(gt, n->method.name);
 
+        emit_set_method(n->method.name);
         if (gen_method_entry(n->method.name, e->payload.method.label, 
-                             e->payload.method.local_count)) return -1;
+                             e->payload.method.local_count,
+                             e->payload.method.temp_count)) return -1;
         if (_gen_mixal_from_ast_list(n->method.params, gt, 
                                     e->payload.method.symbols, break_label)) return -1;
+        if (_gen_index_params(n, e->payload.method.symbols)) return -1;
+
+        current_method = n;
+        if (options.tail_calls && tail_has_self_call(n)) {
+          // self tail calls restart the body with the new parameters
+          restart_label = label_loop(branch_index);
+          branch_index += 1;
+
+          if (gen_branch_label(restart_label)) return -1;
+        }
+
         if (_gen_mixal_from_ast_node(n->method.body, gt, 
                                     e->payload.method.symbols, break_label)) return -1;
         if (gen_method_exit(n->method.name, e->payload.method.param_count)) return -1;
 
+        free(restart_label);
+        restart_label = NULL;
+        current_method = NULL;
+        emit_set_method(NULL);
+
         break;
 
       case N_PARAM:
@@ -62,10 +118,7 @@ static int _gen_mixal_from_ast_node(const ASTNode *n, const HashTable *gt,
 
       case N_VAR:
         if (n->var.expr != NULL) {
-          e = ht_find_entry(lt, n->var.name);
-
-          if (_gen_mixal_from_ast_node(n->var.expr, gt, lt, break_label)) return -1;
-          if (gen_pop_var(n->var.name, e->payload.symbol.offset)) return -1;
+          if (_gen_mixal_from_ast_assign(n->var.name, n->var.expr, gt, lt)) return -1;
         }
 
         break;
@@ -75,20 +128,17 @@ static int _gen_mixal_from_ast_node(const ASTNode *n, const HashTable *gt,
         break;
 
       case N_ASSIGN:
-        e = ht_find_entry(lt, n->assign.location);
-
-        if (_gen_mixal_from_ast_node(n->assign.rhs, gt, lt, break_label)) return -1;
-        if (gen_pop_var(n->assign.location, e->payload.symbol.offset)) return -1;
-
+        if (_gen_mixal_from_ast_assign(n->assign.location, n->assign.rhs, gt, lt)) return -1;
         break;
 
       case N_IF:
         char *else_label = label_else(branch_index);
         char *cont_label = label_done(branch_index);
 
-        if (_gen_mixal_from_ast_node(n->branch.cond, gt, lt, break_label)) return -1;
+        // nested branches must not reuse the labels of this one
+        branch_index += 1;
 
-        if (gen_branch_entry(else_label)) return -1;
+        if (_gen_mixal_from_ast_cond(n->branch.cond, gt, lt, else_label)) return -1;
 
         if (_gen_mixal_from_ast_node(n->branch.then_branch, gt, lt, break_label)) return -1;
 
@@ -102,34 +152,51 @@ static int _gen_mixal_from_ast_node(const ASTNode *n, const HashTable *gt,
         free(else_label);
         free(cont_label);
 
-        branch_index += 1;
-
         break;
 
       case N_WHILE:
         char *loop_label = label_loop(branch_index);
         char *done_label = label_done(branch_index);
 
-        if (gen_branch_label(loop_label)) return -1;
-        
-        if (_gen_mixal_from_ast_node(n->branch.cond, gt, lt, break_label)) return -1;
-
-        if (gen_branch_entry(done_label)) return -1;
+        branch_index += 1;
 
-        if (_gen_mixal_from_ast_node(n->branch.then_branch, gt, lt, done_label)) return -1;
+        if (options.fold_constants && n->branch.cond->kind == N_NUMBER) {
+          // folding drops while (0), but inlining and constant propagation
+          // may substitute a 0 after it: such a loop is not generated at all,
+          // any other only exits by break
+          if (n->branch.cond->number.val != 0) {
+            if (gen_branch_label(loop_label)) return -1;
+            if (_gen_mixal_from_ast_node(n->branch.then_branch, gt, lt, done_label)) return -1;
+            if (gen_branch_jmp(loop_label)) return -1;
+          }
+        } else if (options.loop_rotate) {
+          if (_gen_mixal_from_ast_rotated(n, gt, lt, branch_index - 1,
+                                          loop_label, done_label)) return -1;
+        } else {
+          if (gen_branch_label(loop_label)) return -1;
+          if (_gen_mixal_from_ast_cond(n->branch.cond, gt, lt, done_label)) return -1;
+          if (_gen_mixal_from_ast_node(n->branch.then_branch, gt, lt, done_label)) return -1;
+          if (gen_branch_jmp(loop_label)) return -1;
+        }
 
-        if (gen_branch_jmp(loop_label)) return -1;
         if (gen_branch_label(done_label)) return -1;
 
         free(loop_label);
         free(done_label);
 
-        branch_index += 1;
-
         break;
 
       case N_RETURN:
-        if (_gen_mixal_from_ast_node(n->ret.expr, gt, lt, break_label)) return -1;
+        if (restart_label != NULL && tail_is_self_call(n, current_method->method.name)) {
+          if (_gen_mixal_from_ast_tail_call(n->ret.expr, gt, lt)) return -1;
+          break;
+        }
+
+        if (options.register_expr) {
+          if (_gen_mixal_from_ast_expr(n->ret.expr, gt, lt)) return -1;
+        } else {
+          if (_gen_mixal_from_ast_node(n->ret.expr, gt, lt, break_label)) return -1;
+        }
         if (gen_method_return()) return -1;
 
         break;
@@ -139,6 +206,24 @@ static int _gen_mixal_from_ast_node(const ASTNode *n, const HashTable *gt,
         break;
 
       case N_BINOP:
+        // multiplication and division by a constant operate on one operand
+        if (options.strength_reduce && n->binop.rhs->kind == N_NUMBER
+            && (n->binop.op == OP_MULOP_MUL || n->binop.op == OP_MULOP_DIV)) {
+          if (_gen_mixal_from_ast_node(n->binop.lhs, gt, lt, break_label)) return -1;
+          if (n->binop.op == OP_MULOP_MUL) {
+            if (gen_binop_mul_const(n->binop.rhs->number.val)) return -1;
+          } else {
+            if (gen_binop_div_const(n->binop.rhs->number.val)) return -1;
+          }
+          break;
+        }
+        if (options.strength_reduce && n->binop.lhs->kind == N_NUMBER
+            && n->binop.op == OP_MULOP_MUL) {
+          if (_gen_mixal_from_ast_node(n->binop.rhs, gt, lt, break_label)) return -1;
+          if (gen_binop_mul_const(n->binop.lhs->number.val)) return -1;
+          break;
+        }
+
         if (_gen_mixal_from_ast_node(n->binop.rhs, gt, lt, break_label)) return -1;
         if (_gen_mixal_from_ast_node(n->binop.lhs, gt, lt, break_label)) return -1;
 
@@ -192,17 +277,16 @@ static int _gen_mixal_from_ast_node(const ASTNode *n, const HashTable *gt,
         break;
 
       case N_CALL:
-        e = ht_find_entry(gt, n->call.fname);
-
         if (_gen_mixal_from_ast_list_reverse(n->call.args, gt, lt, break_label)) return -1;
-        if (gen_method_call(n->call.fname, e->payload.method.label)) return -1;
+        if (_gen_mixal_from_ast_call(n, gt, lt)) return -1;
 
         break;
 
       case N_IDENTIFIER:
         e = ht_find_entry(lt, n->identifier.name);
         
-        if (gen_push_var(n->identifier.name, e->payload.symbol.offset)) return -1;
+        if (gen_push_var(n->identifier.name, e->payload.symbol.offset,
+                         e->payload.symbol.reg)) return -1;
 
         break;
 
@@ -214,6 +298,8 @@ static int _gen_mixal_from_ast_node(const ASTNode *n, const HashTable *gt,
       default:
         return -1;
     }
+
+    emit_set_loc(parent_loc);
   }
 
   return 0;
@@ -238,3 +324,395 @@ static int _gen_mixal_from_ast_list_reverse(const ASTList *l, const HashTable *g
 
   return 0;
 }
+
+/* operand that can be addressed directly by a register operation */
+static int _gen_operand(const ASTNode *n, const HashTable *lt, Operand *o) {
+  const TableEntry *e = NULL;
+
+  switch (n->kind) {
+    case N_IDENTIFIER:
+      e = ht_find_entry(lt, n->identifier.name);
+
+      o->kind = OPERAND_VAR;
+      o->name = n->identifier.name;
+      o->value = e->payload.symbol.offset;
+      o->reg = e->payload.symbol.reg;
+      o->reg_home = e->payload.symbol.reg_home;
+      return 1;
+
+    case N_NUMBER:
+      o->kind = OPERAND_NUM;
+      o->name = NULL;
+      o->value = n->number.val;
+      o->reg = 0;
+      o->reg_home = 0;
+      return 1;
+
+    default:
+      return 0;
+  }
+}
+
+/* operation with swapped operands: a op b == b mirror a */
+static int _gen_op_mirror(enum OpKind op, enum OpKind *mirror) {
+  switch (op) {
+    case OP_ADDOP_ADD: case OP_MULOP_MUL:
+    case OP_RELOP_EQ:  case OP_RELOP_NEQ:
+      *mirror = op;
+      return 1;
+
+    case OP_RELOP_LT:  *mirror = OP_RELOP_GT;  return 1;
+    case OP_RELOP_GT:  *mirror = OP_RELOP_LT;  return 1;
+    case OP_RELOP_LEQ: *mirror = OP_RELOP_GEQ; return 1;
+    case OP_RELOP_GEQ: *mirror = OP_RELOP_LEQ; return 1;
+
+    default:
+      return 0;
+  }
+}
+
+/* evaluate one operand of a binary operation into rA and describe the
+   other one, mirroring the operation when the operands are swapped */
+static int _gen_mixal_from_ast_binop_operands(const ASTNode *n, const HashTable *gt,
+                                              const HashTable *lt, enum OpKind *op,
+                                              Operand *rhs) {
+  Operand lhs;
+  enum OpKind mirror;
+
+  if (_gen_operand(n->binop.rhs, lt, rhs)) {
+    *op = n->binop.op;
+    return _gen_mixal_from_ast_expr(n->binop.lhs, gt, lt);
+  }
+
+  if (_gen_op_mirror(n->binop.op, &mirror) && _gen_operand(n->binop.lhs, lt, &lhs)) {
+    *op = mirror;
+    *rhs = lhs;
+    return _gen_mixal_from_ast_expr(n->binop.rhs, gt, lt);
+  }
+
+  if (_gen_mixal_from_ast_expr(n->binop.rhs, gt, lt)) return -1;
+  if (gen_spill_reg()) return -1;
+
+  *op = n->binop.op;
+  rhs->kind = OPERAND_STACK;
+  rhs->name = NULL;
+  rhs->value = 0;
+  rhs->reg = 0;
+  rhs->reg_home = 0;
+  return _gen_mixal_from_ast_expr(n->binop.lhs, gt, lt);
+}
+
+/* evaluate expression into rA, spilling to the stack only when
+   the right operand is not directly addressable */
+static int _gen_mixal_from_ast_expr_kind(const ASTNode *n, const HashTable *gt, const HashTable *lt) {
+  Operand rhs;
+  enum OpKind op;
+  const char *name;
+  int value;
+
+  switch (n->kind) {
+    case N_IDENTIFIER:
+    case N_NUMBER:
+      _gen_operand(n, lt, &rhs);
+      return gen_load_operand(&rhs);
+
+    case N_UNARY:
+      if (n->unary.op != OP_ADDOP_SUB) return -1;
+
+      if (_gen_operand(n->unary.expr, lt, &rhs)) return gen_load_operand_neg(&rhs);
+
+      if (_gen_mixal_from_ast_expr(n->unary.expr, gt, lt)) return -1;
+      return gen_reg_unary_neg();
+
+    case N_BINOP:
+      // a variable in an index register plus a constant is a single ENTA
+      if (regalloc_index_sum(n, &name, &value)
+          && ht_find_entry(lt, name)->payload.symbol.reg) {
+        Operand var;
+        _gen_operand(n->binop.lhs->kind == N_IDENTIFIER ? n->binop.lhs : n->binop.rhs, lt, &var);
+        return gen_load_operand_sum(&var, value);
+      }
+
+      if (_gen_mixal_from_ast_binop_operands(n, gt, lt, &op, &rhs)) return -1;
+      return gen_reg_binop(op, &rhs);
+
+    case N_CALL:
+      if (_gen_mixal_from_ast_args(n->call.args, gt, lt)) return -1;
+      return _gen_mixal_from_ast_call(n, gt, lt);
+
+    default:
+      return -1;
+  }
+}
+
+static int _gen_mixal_from_ast_expr(const ASTNode *n, const HashTable *gt, const HashTable *lt) {
+  // attribute the generated instructions to this node
+  YYLTYPE parent_loc = emit_get_loc();
+  emit_set_loc(n->loc);
+
+  int status = _gen_mixal_from_ast_expr_kind(n, gt, lt);
+
+  emit_set_loc(parent_loc);
+  return status;
+}
+
+/* push call arguments in reverse order */
+static int _gen_mixal_from_ast_args(const ASTList *l, const HashTable *gt, const HashTable *lt) {
+  if (l != NULL) {
+    if (_gen_mixal_from_ast_args(l->list, gt, lt)) return -1;
+    if (_gen_mixal_from_ast_expr(l->node, gt, lt)) return -1;
+    return gen_spill_reg();
+  }
+
+  return 0;
+}
+
+static int _gen_is_relop(const ASTNode *n) {
+  if (n->kind != N_BINOP) return 0;
+
+  switch (n->binop.op) {
+    case OP_RELOP_LEQ: case OP_RELOP_LT:
+    case OP_RELOP_GT:  case OP_RELOP_GEQ:
+    case OP_RELOP_EQ:  case OP_RELOP_NEQ:
+      return 1;
+
+    default:
+      return 0;
+  }
+}
+
+/* jump to l_false unless the condition holds, branching directly on
+   the comparison indicator (or on rA for comparisons against zero) */
+static int _gen_mixal_from_ast_cond(const ASTNode *n, const HashTable *gt,
+                                    const HashTable *lt, const char *l_false) {
+  const ASTNode *operand = NULL;
+  enum OpKind op;
+  Operand rhs;
+
+  if (!options.fuse_compare || !_gen_is_relop(n)) {
+    if (options.register_expr) {
+      if (_gen_mixal_from_ast_expr(n, gt, lt)) return -1;
+      return gen_reg_branch_entry(l_false);
+    }
+
+    if (_gen_mixal_from_ast_node(n, gt, lt, NULL)) return -1;
+    return gen_branch_entry(l_false);
+  }
+
+  YYLTYPE parent_loc = emit_get_loc();
+  emit_set_loc(n->loc);
+
+  op = n->binop.op;
+  if (n->binop.rhs->kind == N_NUMBER && n->binop.rhs->number.val == 0) {
+    operand = n->binop.lhs;
+  } else if (n->binop.lhs->kind == N_NUMBER && n->binop.lhs->number.val == 0) {
+    operand = n->binop.rhs;
+    _gen_op_mirror(n->binop.op, &op);
+  }
+
+  Operand lhs_op, rhs_op;
+  enum OpKind index_op = n->binop.op;
+
+  if (_gen_operand(n->binop.lhs, lt, &lhs_op) && _gen_operand(n->binop.rhs, lt, &rhs_op)
+      && (lhs_op.reg || rhs_op.reg)) {
+    // compare the index register holding a variable in place
+    if (lhs_op.reg == 0) {
+      Operand swap = lhs_op;
+      lhs_op = rhs_op;
+      rhs_op = swap;
+      _gen_op_mirror(n->binop.op, &index_op);
+    }
+
+    if (rhs_op.kind == OPERAND_NUM && rhs_op.value == 0) {
+      if (gen_index_branch_zero(index_op, &lhs_op, l_false)) return -1;
+    } else {
+      if (gen_index_branch_cmp(index_op, &lhs_op, &rhs_op, l_false)) return -1;
+    }
+  } else if (operand != NULL && options.register_expr) {
+    if (_gen_mixal_from_ast_expr(operand, gt, lt)) return -1;
+    if (gen_reg_branch_zero(op, l_false)) return -1;
+  } else if (operand != NULL) {
+    if (_gen_mixal_from_ast_node(operand, gt, lt, NULL)) return -1;
+    if (gen_branch_zero(op, l_false)) return -1;
+  } else if (options.register_expr) {
+    if (_gen_mixal_from_ast_binop_operands(n, gt, lt, &op, &rhs)) return -1;
+    if (gen_reg_branch_cmp(op, &rhs, l_false)) return -1;
+  } else {
+    if (_gen_mixal_from_ast_node(n->binop.rhs, gt, lt, NULL)) return -1;
+    if (_gen_mixal_from_ast_node(n->binop.lhs, gt, lt, NULL)) return -1;
+    if (gen_branch_cmp(op, l_false)) return -1;
+  }
+
+  emit_set_loc(parent_loc);
+  return 0;
+}
+
+static unsigned int _gen_ast_size(const ASTNode *n) {
+  unsigned int size = 1;
+
+  switch (n->kind) {
+    case N_UNARY:
+      return size + _gen_ast_size(n->unary.expr);
+
+    case N_BINOP:
+      return size + _gen_ast_size(n->binop.lhs) + _gen_ast_size(n->binop.rhs);
+
+    case N_CALL:
+      for (const ASTList *l = n->call.args ; l != NULL ; l = l->list) {
+        size += _gen_ast_size(l->node);
+      }
+      return size;
+
+    default:
+      return size;
+  }
+}
+
+/* while loop with the test after the body, jumping back while the
+   condition holds: one jump per iteration instead of two. A small
+   condition is copied in front of the loop to skip it, a larger one
+   is reached by a jump on entry */
+static int _gen_mixal_from_ast_rotated(const ASTNode *n, const HashTable *gt,
+                                       const HashTable *lt, unsigned int index,
+                                       const char *loop_label, const char *done_label) {
+  char *test_label = NULL;
+  int status = -1;
+
+  if (_gen_ast_size(n->branch.cond) <= ROTATE_COPY_LIMIT) {
+    if (_gen_mixal_from_ast_cond(n->branch.cond, gt, lt, done_label)) return -1;
+  } else {
+    test_label = label_test(index);
+    if (test_label == NULL) return -1;
+    if (gen_branch_jmp(test_label)) goto done;
+  }
+
+  if (gen_branch_label(loop_label)) goto done;
+  if (_gen_mixal_from_ast_node(n->branch.then_branch, gt, lt, done_label)) goto done;
+
+  if (test_label != NULL && gen_branch_label(test_label)) goto done;
+  if (_gen_mixal_from_ast_cond(n->branch.cond, gt, lt, done_label)) goto done;
+  status = gen_branch_negate(loop_label);
+
+done:
+  free(test_label);
+  return status;
+}
+
+/* argument passing the parameter unchanged */
+static int _gen_is_same_param(const ASTNode *arg, const ASTNode *param) {
+  return arg->kind == N_IDENTIFIER && strcmp(arg->identifier.name, param->param.name) == 0;
+}
+
+/* evaluate the arguments of a self tail call to the stack, last first,
+   leaving the first one in rA when evaluating in registers */
+static int _gen_mixal_from_ast_tail_args(const ASTList *args, const ASTList *params,
+                                         const HashTable *gt, const HashTable *lt,
+                                         int first) {
+  if (args == NULL) return 0;
+
+  int same = _gen_is_same_param(args->node, params->node);
+
+  if (_gen_mixal_from_ast_tail_args(args->list, params->list, gt, lt, first && same)) return -1;
+  if (same) return 0;
+
+  if (options.register_expr) {
+    if (_gen_mixal_from_ast_expr(args->node, gt, lt)) return -1;
+    return first ? 0 : gen_spill_reg();
+  }
+
+  return _gen_mixal_from_ast_node(args->node, gt, lt, NULL);
+}
+
+/* self tail call: all arguments are evaluated before any parameter is
+   overwritten, then the body starts over in the same frame */
+static int _gen_mixal_from_ast_tail_call(const ASTNode *n, const HashTable *gt,
+                                         const HashTable *lt) {
+  const ASTList *params = current_method->method.params;
+  int first = 1;
+
+  if (_gen_mixal_from_ast_tail_args(n->call.args, params, gt, lt, 1)) return -1;
+
+  for (const ASTList *l = n->call.args ; l != NULL ; l = l->list, params = params->list) {
+    if (_gen_is_same_param(l->node, params->node)) continue;
+
+    const char *name = params->node->param.name;
+    const TableEntry *e = ht_find_entry(lt, name);
+
+    if (first && options.register_expr) {
+      if (gen_store_var(name, e->payload.symbol.offset, e->payload.symbol.reg)) return -1;
+    } else {
+      if (gen_pop_var(name, e->payload.symbol.offset, e->payload.symbol.reg)) return -1;
+    }
+
+    first = 0;
+  }
+
+  return gen_tail_call(n->call.fname, restart_label);
+}
+
+/* variable name ← rhs, in place when the variable is held in an index register */
+static int _gen_mixal_from_ast_assign(const char *name, const ASTNode *rhs,
+                                      const HashTable *gt, const HashTable *lt) {
+  const TableEntry *e = ht_find_entry(lt, name);
+  int offset = e->payload.symbol.offset;
+  int reg = e->payload.symbol.reg;
+  const char *src_name;
+  int value;
+  Operand src;
+
+  if (reg) {
+    if (_gen_operand(rhs, lt, &src)) return gen_index_set(name, reg, &src, 0);
+
+    if (regalloc_index_sum(rhs, &src_name, &value)) {
+      if (strcmp(src_name, name) == 0) return gen_index_inc(name, reg, value);
+
+      _gen_operand(rhs->binop.lhs->kind == N_IDENTIFIER ? rhs->binop.lhs : rhs->binop.rhs, lt, &src);
+      return gen_index_set(name, reg, &src, value);
+    }
+  }
+
+  if (options.register_expr) {
+    if (_gen_mixal_from_ast_expr(rhs, gt, lt)) return -1;
+    return gen_store_var(name, offset, reg);
+  }
+
+  if (_gen_mixal_from_ast_node(rhs, gt, lt, NULL)) return -1;
+  return gen_pop_var(name, offset, reg);
+}
+
+/* call with the arguments already on the stack, saving the variables in
+   index registers that the callee may overwrite */
+static int _gen_mixal_from_ast_call(const ASTNode *n, const HashTable *gt, const HashTable *lt) {
+  const TableEntry *e = ht_find_entry(gt, n->call.fname);
+  size_t n_saves = 0;
+  const char *const *saves = regalloc_call_saves(n, &n_saves);
+
+  for (size_t i = 0 ; i < n_saves ; i++) {
+    const TableEntry *v = ht_find_entry(lt, saves[i]);
+    if (v->payload.symbol.reg_home) continue;
+    if (gen_index_save(saves[i], v->payload.symbol.offset, v->payload.symbol.reg)) return -1;
+  }
+
+  if (gen_method_call(n->call.fname, e->payload.method.label,
+                      e->payload.method.param_count)) return -1;
+
+  for (size_t i = 0 ; i < n_saves ; i++) {
+    const TableEntry *v = ht_find_entry(lt, saves[i]);
+    if (gen_index_load(saves[i], v->payload.symbol.offset, v->payload.symbol.reg)) return -1;
+  }
+
+  return 0;
+}
+
+/* load the parameters held in index registers from the frame */
+static int _gen_index_params(const ASTNode *method, const HashTable *lt) {
+  for (const ASTList *l = method->method.params ; l != NULL ; l = l->list) {
+    const char *name = l->node->param.name;
+    const TableEntry *e = ht_find_entry(lt, name);
+
+    if (e->payload.symbol.reg == 0) continue;
+    if (gen_index_load(name, e->payload.symbol.offset, e->payload.symbol.reg)) return -1;
+  }
+
+  return 0;
+}
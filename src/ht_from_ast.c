@@ -12,6 +12,7 @@ struct SymbolTableContext {
   unsigned int loop_depth;
   unsigned int param_count;
   unsigned int local_count;
+  unsigned int temp_count;
   enum DataType decl_type;
 };
 
@@ -20,10 +21,15 @@ static unsigned int _ht_from_ast_node(const ASTNode *n, HashTable *gt,
 static unsigned int _ht_from_ast_node_list(const ASTList *l, HashTable *gt, 
                                       struct SymbolTableContext *ctxt);
 
+static void _ht_count_temps(const ASTNode *expr, struct SymbolTableContext *ctxt);
+
 unsigned int ht_from_ast(const ASTNode *n, HashTable **gt) {
   unsigned int semantic_errors = 0;
   *gt = ht_new(TABLE_SIZE);
 
+  // labels are numbered from the start on every run
+  method_index = 1;
+
   semantic_errors += _ht_from_ast_node(n, *gt, NULL);
 
   TableEntry *e = ht_find_entry(*gt, "main");
@@ -64,6 +70,7 @@ static unsigned int _ht_from_ast_node(const ASTNode *n, HashTable *gt, struct Sy
             .return_type = n->method.type,
             .param_count = 0,
             .local_count = 0,
+            .temp_count = 0,
             .symbols = NULL,
             .label = label_method(method_index++)
           }
@@ -78,6 +85,7 @@ static unsigned int _ht_from_ast_node(const ASTNode *n, HashTable *gt, struct Sy
           .scope = n->method.name,
           .param_count = 0,
           .local_count = 0,
+          .temp_count = 0,
           .loop_depth = 0,
         };
 
@@ -86,6 +94,7 @@ static unsigned int _ht_from_ast_node(const ASTNode *n, HashTable *gt, struct Sy
 
         semantic_errors += _ht_from_ast_node(n->method.body, gt, &mctxt);
         e->payload.method.local_count = mctxt.local_count;
+        e->payload.method.temp_count = mctxt.temp_count;
 
         e->payload.method.symbols = st;
 
@@ -132,6 +141,7 @@ static unsigned int _ht_from_ast_node(const ASTNode *n, HashTable *gt, struct Sy
     case N_VAR:
       ctxt->local_count += 1;
       semantic_errors += _ht_from_ast_node(n->var.expr, gt, ctxt);
+      _ht_count_temps(n->var.expr, ctxt);
 
       e = ht_find_entry(ctxt->lt, n->var.name);
       if (e != NULL) {
@@ -172,17 +182,20 @@ static unsigned int _ht_from_ast_node(const ASTNode *n, HashTable *gt, struct Sy
         fprintf(stderr, "\n");
       }
       semantic_errors += _ht_from_ast_node(n->assign.rhs, gt, ctxt);
+      _ht_count_temps(n->assign.rhs, ctxt);
 
       return semantic_errors;
 
     case N_IF:
       semantic_errors += _ht_from_ast_node(n->branch.cond, gt, ctxt);
+      _ht_count_temps(n->branch.cond, ctxt);
       semantic_errors += _ht_from_ast_node(n->branch.then_branch, gt, ctxt);
       semantic_errors += _ht_from_ast_node(n->branch.else_branch, gt, ctxt);
       return semantic_errors;
 
     case N_WHILE:
       semantic_errors += _ht_from_ast_node(n->branch.cond, gt, ctxt);
+      _ht_count_temps(n->branch.cond, ctxt);
 
       ctxt->loop_depth += 1;
       semantic_errors += _ht_from_ast_node(n->branch.then_branch, gt, ctxt);
@@ -191,6 +204,7 @@ static unsigned int _ht_from_ast_node(const ASTNode *n, HashTable *gt, struct Sy
       return semantic_errors;
 
     case N_RETURN:
+      _ht_count_temps(n->ret.expr, ctxt);
       return _ht_from_ast_node(n->ret.expr, gt, ctxt);
 
     case N_BREAK:
@@ -267,3 +281,43 @@ static unsigned int _ht_from_ast_node_list(const ASTList *l, HashTable *gt, stru
 
   return semantic_errors;
 }
+
+/* stack words used while evaluating an expression on the stack, including
+   the word holding its value (an upper bound for register evaluation) */
+static unsigned int _ht_expr_depth(const ASTNode *n) {
+  unsigned int depth = 1;
+
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_BINOP:
+      // rhs is evaluated first, lhs on top of it
+      depth = _ht_expr_depth(n->binop.rhs);
+      unsigned int lhs_depth = 1 + _ht_expr_depth(n->binop.lhs);
+      return (lhs_depth > depth) ? lhs_depth : depth;
+
+    case N_UNARY:
+      return _ht_expr_depth(n->unary.expr);
+
+    case N_CALL:
+      // arguments are pushed from the last to the first
+      unsigned int below = ast_list_size(n->call.args);
+      if (below > depth) depth = below;
+
+      for (const ASTList *l = n->call.args ; l != NULL ; l = l->list) {
+        below -= 1;
+        unsigned int arg_depth = below + _ht_expr_depth(l->node);
+        if (arg_depth > depth) depth = arg_depth;
+      }
+
+      return depth;
+
+    default:
+      return depth;
+  }
+}
+
+static void _ht_count_temps(const ASTNode *expr, struct SymbolTableContext *ctxt) {
+  unsigned int depth = _ht_expr_depth(expr);
+  if (depth > ctxt->temp_count) ctxt->temp_count = depth;
+}
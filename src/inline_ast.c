@@ -0,0 +1,684 @@
+#include "inline.h"
+#include "options.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// numbers the variables introduced by inlining, so that names never clash
+static unsigned int inline_index = 1;
+
+/* variable of the callee and what it becomes in the caller */
+struct VarMap {
+  const char *from;
+  char *to;             // renamed caller local, or NULL
+  const ASTNode *subst; // argument used in place of an unmodified parameter
+};
+
+struct InlineCall {
+  struct VarMap *vars;
+  size_t n_vars;
+  char *result;     // caller local receiving the return value
+  ASTList *locals;  // N_VARs to declare in the caller
+};
+
+static char *fresh_name(const char *name) {
+  size_t len = strcspn(name, ".");
+  char buf[64];
+
+  if (snprintf(buf, sizeof(buf), "%.*s.%u", (int)len, name, inline_index++)
+      >= (int)sizeof(buf)) return NULL;
+
+  return strdup(buf);
+}
+
+static const struct VarMap *find_var(const struct InlineCall *c, const char *name) {
+  for (size_t i = 0 ; c != NULL && i < c->n_vars ; i++) {
+    if (strcmp(c->vars[i].from, name) == 0) return &c->vars[i];
+  }
+
+  return NULL;
+}
+
+static int add_var(struct InlineCall *c, const char *from, const ASTNode *subst, YYLTYPE loc) {
+  struct VarMap *vars = realloc(c->vars, (c->n_vars + 1) * sizeof(struct VarMap));
+  if (vars == NULL) return -1;
+  c->vars = vars;
+
+  struct VarMap *v = &c->vars[c->n_vars++];
+  v->from = from;
+  v->to = NULL;
+  v->subst = subst;
+
+  if (subst != NULL) return 0;
+
+  v->to = fresh_name(from);
+  if (v->to == NULL) return -1;
+
+  char *decl_name = strdup(v->to);
+  if (decl_name == NULL) return -1;
+
+  c->locals = ast_list_prepend(c->locals, ast_new_var(decl_name, NULL, loc));
+  return 0;
+}
+
+static int clone_node(const ASTNode *n, const struct InlineCall *c, ASTNode **out);
+
+static int clone_list(const ASTList *l, const struct InlineCall *c, ASTList **out) {
+  ASTList *copy = NULL;
+
+  for ( ; l != NULL ; l = l->list) {
+    ASTNode *node = NULL;
+    if (clone_node(l->node, c, &node)) {
+      ast_list_free(copy);
+      return -1;
+    }
+    copy = ast_list_prepend(copy, node);
+  }
+
+  *out = ast_list_reverse(copy);
+  return 0;
+}
+
+static char *renamed(const struct InlineCall *c, const char *name) {
+  const struct VarMap *v = find_var(c, name);
+  return strdup((v != NULL && v->to != NULL) ? v->to : name);
+}
+
+/* copy of a statement or expression of the callee, with its variables
+   renamed (c is NULL for expressions of the caller) */
+static int clone_node(const ASTNode *n, const struct InlineCall *c, ASTNode **out) {
+  const struct VarMap *v = NULL;
+  ASTNode *a = NULL, *b = NULL, *d = NULL;
+  ASTList *l = NULL;
+  char *name = NULL;
+
+  *out = NULL;
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_NUMBER:
+      *out = ast_new_number(n->number.val, n->loc);
+      return 0;
+
+    case N_IDENTIFIER:
+      v = find_var(c, n->identifier.name);
+      if (v != NULL && v->subst != NULL) return clone_node(v->subst, NULL, out);
+
+      if ((name = renamed(c, n->identifier.name)) == NULL) return -1;
+      *out = ast_new_identifier(name, n->loc);
+      return 0;
+
+    case N_UNARY:
+      if (clone_node(n->unary.expr, c, &a)) return -1;
+      *out = ast_new_unary(n->unary.op, a, n->loc);
+      return 0;
+
+    case N_BINOP:
+      if (clone_node(n->binop.lhs, c, &a)) return -1;
+      if (clone_node(n->binop.rhs, c, &b)) {
+        ast_free(a);
+        return -1;
+      }
+      *out = ast_new_binop(n->binop.op, a, b, n->loc);
+      return 0;
+
+    case N_CALL:
+      if ((name = strdup(n->call.fname)) == NULL) return -1;
+      if (clone_list(n->call.args, c, &l)) {
+        free(name);
+        return -1;
+      }
+      *out = ast_new_call(name, l, n->loc);
+      return 0;
+
+    case N_ASSIGN:
+      if ((name = renamed(c, n->assign.location)) == NULL) return -1;
+      if (clone_node(n->assign.rhs, c, &a)) {
+        free(name);
+        return -1;
+      }
+      *out = ast_new_assign(name, a, n->loc);
+      return 0;
+
+    case N_BLOCK:
+      if (clone_list(n->block.stmts, c, &l)) return -1;
+      *out = ast_new_block(l, n->loc);
+      return 0;
+
+    case N_IF:
+    case N_WHILE:
+      if (clone_node(n->branch.cond, c, &a)) return -1;
+      if (clone_node(n->branch.then_branch, c, &b) ||
+          clone_node(n->branch.else_branch, c, &d)) {
+        ast_free(a);
+        ast_free(b);
+        return -1;
+      }
+      if (n->kind == N_WHILE) *out = ast_new_while(a, b, n->loc);
+      else *out = ast_new_if(a, b, d, n->loc);
+      return 0;
+
+    case N_BREAK:
+      *out = ast_new_break(n->loc);
+      return 0;
+
+    default:
+      // returns are handled by _inline_seq
+      return -1;
+  }
+}
+
+static unsigned int ast_size(const ASTNode *n);
+
+static unsigned int ast_list_nodes(const ASTList *l) {
+  unsigned int size = 0;
+  for ( ; l != NULL ; l = l->list) size += ast_size(l->node);
+  return size;
+}
+
+/* number of nodes, the measure of the inlining budget */
+static unsigned int ast_size(const ASTNode *n) {
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_UNARY:  return 1 + ast_size(n->unary.expr);
+    case N_BINOP:  return 1 + ast_size(n->binop.lhs) + ast_size(n->binop.rhs);
+    case N_CALL:   return 1 + ast_list_nodes(n->call.args);
+    case N_ASSIGN: return 1 + ast_size(n->assign.rhs);
+    case N_RETURN: return 1 + ast_size(n->ret.expr);
+    case N_BLOCK:  return ast_list_nodes(n->block.stmts);
+
+    case N_IF:
+    case N_WHILE:
+      return 1 + ast_size(n->branch.cond)
+               + ast_size(n->branch.then_branch) + ast_size(n->branch.else_branch);
+
+    default:
+      return 1;
+  }
+}
+
+static int has_return(const ASTNode *n) {
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_RETURN:
+      return 1;
+
+    case N_BLOCK:
+      for (const ASTList *l = n->block.stmts ; l != NULL ; l = l->list) {
+        if (has_return(l->node)) return 1;
+      }
+      return 0;
+
+    case N_IF:
+    case N_WHILE:
+      return has_return(n->branch.then_branch) || has_return(n->branch.else_branch);
+
+    default:
+      return 0;
+  }
+}
+
+static int is_assigned(const ASTNode *n, const char *name);
+
+static int is_assigned_list(const ASTList *l, const char *name) {
+  for ( ; l != NULL ; l = l->list) {
+    if (is_assigned(l->node, name)) return 1;
+  }
+  return 0;
+}
+
+static int is_assigned(const ASTNode *n, const char *name) {
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_BODY:   return is_assigned_list(n->body.stmts, name);
+    case N_BLOCK:  return is_assigned_list(n->block.stmts, name);
+    case N_ASSIGN: return strcmp(n->assign.location, name) == 0;
+
+    case N_IF:
+    case N_WHILE:
+      return is_assigned(n->branch.then_branch, name) || is_assigned(n->branch.else_branch, name);
+
+    default:
+      return 0;
+  }
+}
+
+static int append_stmt(ASTList ***tail, ASTNode *s) {
+  **tail = ast_list_prepend(NULL, s);
+  if (**tail == NULL) return -1;
+
+  *tail = &(**tail)->list;
+  return 0;
+}
+
+/* remaining statements of the enclosing lists */
+struct Cont {
+  const ASTList *l;
+  const struct Cont *next;
+};
+
+/* append a copy of the statements l followed by k, with each return
+   turned into an assignment to the result variable and the statements
+   after an if that returns moved into both of its branches.
+   returns 1 if the body cannot be inlined (a return inside a loop) */
+static int _inline_seq(const ASTList *l, const struct Cont *k, struct InlineCall *c,
+                       ASTList ***tail) {
+  ASTNode *copy = NULL;
+  int status;
+
+  for (;;) {
+    while (l == NULL) {
+      if (k == NULL) return 0;
+      l = k->l;
+      k = k->next;
+    }
+
+    const ASTNode *s = l->node;
+    const struct Cont rest = { l->list, k };
+    l = l->list;
+
+    if (s == NULL) continue;
+
+    switch (s->kind) {
+      case N_RETURN:
+        if (clone_node(s->ret.expr, c, &copy)) return -1;
+
+        char *name = strdup(c->result);
+        if (name == NULL) return -1;
+
+        return append_stmt(tail, ast_new_assign(name, copy, s->loc));
+
+      case N_BLOCK:
+        return _inline_seq(s->block.stmts, &rest, c, tail);
+
+      case N_IF:
+        if (!has_return(s)) break;
+
+        ASTList then_cell = { s->branch.then_branch, NULL };
+        ASTList else_cell = { s->branch.else_branch, NULL };
+        ASTList *then_stmts = NULL, *else_stmts = NULL;
+        ASTList **then_tail = &then_stmts, **else_tail = &else_stmts;
+
+        if ((status = _inline_seq(&then_cell, &rest, c, &then_tail)) == 0) {
+          status = _inline_seq(&else_cell, &rest, c, &else_tail);
+        }
+        if (status == 0) status = clone_node(s->branch.cond, c, &copy);
+        if (status) {
+          ast_list_free(then_stmts);
+          ast_list_free(else_stmts);
+          return status;
+        }
+
+        return append_stmt(tail, ast_new_if(copy, ast_new_block(then_stmts, s->loc),
+                                            ast_new_block(else_stmts, s->loc), s->loc));
+
+      case N_WHILE:
+        if (has_return(s)) return 1;
+        break;
+
+      default:
+        break;
+    }
+
+    if (clone_node(s, c, &copy)) return -1;
+    if (append_stmt(tail, copy)) return -1;
+  }
+}
+
+static void inline_call_free(struct InlineCall *c) {
+  for (size_t i = 0 ; i < c->n_vars ; i++) free(c->vars[i].to);
+  free(c->vars);
+  free(c->result);
+  ast_list_free(c->locals);
+}
+
+/* statements computing the value of the call, and the expression that
+   replaces the call (the result variable, or the returned expression
+   when the body is straight-line). returns 1 if the call is not inlined */
+static int inline_body(const ASTNode *callee, const ASTNode *call, struct InlineCall *c,
+                       ASTList **pre, ASTNode **value) {
+  ASTList **tail = pre;
+  const ASTNode *body = callee->method.body;
+  int status;
+
+  *pre = NULL;
+  *value = NULL;
+
+  if ((c->result = fresh_name(callee->method.name)) == NULL) return -1;
+
+  // an argument that is a variable or a number is used as is if the
+  // parameter is never assigned, others are copied to a new local
+  const ASTList *arg = call->call.args;
+  for (const ASTList *p = callee->method.params ; p != NULL ; p = p->list, arg = arg->list) {
+    const char *param = p->node->param.name;
+    const ASTNode *a = arg->node;
+    int simple = (a->kind == N_IDENTIFIER || a->kind == N_NUMBER) && !is_assigned(body, param);
+
+    if (add_var(c, param, simple ? a : NULL, call->loc)) return -1;
+    if (simple) continue;
+
+    ASTNode *copy = NULL;
+    char *name = strdup(c->vars[c->n_vars - 1].to);
+    if (name == NULL || clone_node(a, NULL, &copy)) {
+      free(name);
+      return -1;
+    }
+    if (append_stmt(&tail, ast_new_assign(name, copy, call->loc))) return -1;
+  }
+
+  // locals of the callee, initializers become assignments
+  for (const ASTList *d = body->body.decls ; d != NULL ; d = d->list) {
+    for (const ASTList *l = d->node->decl.vars ; l != NULL ; l = l->list) {
+      if (add_var(c, l->node->var.name, NULL, l->node->loc)) return -1;
+    }
+  }
+
+  for (const ASTList *d = body->body.decls ; d != NULL ; d = d->list) {
+    for (const ASTList *l = d->node->decl.vars ; l != NULL ; l = l->list) {
+      if (l->node->var.expr == NULL) continue;
+
+      ASTNode *copy = NULL;
+      char *name = renamed(c, l->node->var.name);
+      if (name == NULL || clone_node(l->node->var.expr, c, &copy)) {
+        free(name);
+        return -1;
+      }
+      if (append_stmt(&tail, ast_new_assign(name, copy, l->node->loc))) return -1;
+    }
+  }
+
+  if ((status = _inline_seq(body->body.stmts, NULL, c, &tail))) return status;
+
+  // a final unconditional return is substituted for the call
+  ASTList **last = pre;
+  while (*last != NULL && (*last)->list != NULL) last = &(*last)->list;
+
+  if (*last != NULL && (*last)->node->kind == N_ASSIGN &&
+      strcmp((*last)->node->assign.location, c->result) == 0) {
+    *value = (*last)->node->assign.rhs;
+    (*last)->node->assign.rhs = NULL;
+
+    ast_list_free(*last);
+    *last = NULL;
+  } else {
+    char *decl_name = strdup(c->result);
+    char *name = strdup(c->result);
+    if (decl_name == NULL || name == NULL) {
+      free(decl_name);
+      free(name);
+      return -1;
+    }
+
+    c->locals = ast_list_prepend(c->locals, ast_new_var(decl_name, NULL, call->loc));
+    *value = ast_new_identifier(name, call->loc);
+  }
+
+  if (ast_list_nodes(*pre) + ast_size(*value) > (unsigned int)options.inline_limit) return 1;
+
+  return 0;
+}
+
+struct Caller {
+  const CallGraph *g;
+  ASTList *locals;       // N_VARs added to the caller
+  unsigned int budget;   // nodes the caller may still grow by
+  unsigned int *unit;    // nodes the program may still grow by
+};
+
+static int inlinable(const CallGraph *g, long j) {
+  return j >= 0 && !callgraph_reaches(g, (size_t)j, (size_t)j);
+}
+
+/* inline the calls of an expression, post-order, appending the
+   statements that compute them to the pre list */
+static int _inline_expr(ASTNode **slot, struct Caller *cl, ASTList ***pre_tail) {
+  ASTNode *n = *slot;
+
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_BINOP:
+      if (_inline_expr(&n->binop.lhs, cl, pre_tail)) return -1;
+      return _inline_expr(&n->binop.rhs, cl, pre_tail);
+
+    case N_UNARY:
+      return _inline_expr(&n->unary.expr, cl, pre_tail);
+
+    case N_CALL:
+      for (ASTList *l = n->call.args ; l != NULL ; l = l->list) {
+        if (_inline_expr(&l->node, cl, pre_tail)) return -1;
+      }
+      break;
+
+    default:
+      return 0;
+  }
+
+  long j = callgraph_find(cl->g, n->call.fname);
+  if (!inlinable(cl->g, j)) return 0;
+
+  struct InlineCall c = { NULL, 0, NULL, NULL };
+  ASTList *pre = NULL;
+  ASTNode *value = NULL;
+
+  int status = inline_body(cl->g->methods[j], n, &c, &pre, &value);
+
+  // what the copy adds in place of the call, within the growth budgets
+  unsigned int growth = 0;
+  if (status == 0) {
+    unsigned int size = ast_list_nodes(pre) + ast_size(value), call = ast_size(n);
+    growth = size > call ? size - call : 0;
+    if (growth > cl->budget || growth > *cl->unit) status = 1;
+  }
+
+  if (status) {
+    ast_list_free(pre);
+    ast_free(value);
+    inline_call_free(&c);
+    return (status < 0) ? -1 : 0;
+  }
+
+  cl->budget -= growth;
+  *cl->unit -= growth;
+
+  // the caller takes over the new locals
+  ASTList **locals_tail = &c.locals;
+  while (*locals_tail != NULL) locals_tail = &(*locals_tail)->list;
+  *locals_tail = cl->locals;
+  cl->locals = c.locals;
+  c.locals = NULL;
+  inline_call_free(&c);
+
+  **pre_tail = pre;
+  while (**pre_tail != NULL) *pre_tail = &(**pre_tail)->list;
+
+  ast_free(n);
+  *slot = value;
+
+  return 0;
+}
+
+/* the statements computing inlined calls go before the statement,
+   which becomes a block in place */
+static int wrap_stmt(ASTNode *s, ASTList *pre) {
+  if (pre == NULL) return 0;
+
+  ASTNode *copy = malloc(sizeof(ASTNode));
+  if (copy == NULL) return -1;
+  *copy = *s;
+
+  ASTList **tail = &pre;
+  while (*tail != NULL) tail = &(*tail)->list;
+  if (append_stmt(&tail, copy)) return -1;
+
+  s->kind = N_BLOCK;
+  s->block.stmts = pre;
+
+  return 0;
+}
+
+static int has_inlinable_call(const CallGraph *g, const ASTNode *n) {
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_BINOP:
+      return has_inlinable_call(g, n->binop.lhs) || has_inlinable_call(g, n->binop.rhs);
+
+    case N_UNARY:
+      return has_inlinable_call(g, n->unary.expr);
+
+    case N_CALL:
+      if (inlinable(g, callgraph_find(g, n->call.fname))) return 1;
+      for (const ASTList *l = n->call.args ; l != NULL ; l = l->list) {
+        if (has_inlinable_call(g, l->node)) return 1;
+      }
+      return 0;
+
+    default:
+      return 0;
+  }
+}
+
+/* initializers run before the statements, in order: turn them all into
+   leading assignments so that the inlined statements can precede them */
+static int initializers_to_stmts(ASTNode *body, const CallGraph *g) {
+  int found = 0;
+
+  for (const ASTList *d = body->body.decls ; d != NULL ; d = d->list) {
+    for (const ASTList *l = d->node->decl.vars ; l != NULL ; l = l->list) {
+      if (has_inlinable_call(g, l->node->var.expr)) found = 1;
+    }
+  }
+
+  if (!found) return 0;
+
+  ASTList *assigns = NULL;
+  ASTList **tail = &assigns;
+
+  for (ASTList *d = body->body.decls ; d != NULL ; d = d->list) {
+    for (ASTList *l = d->node->decl.vars ; l != NULL ; l = l->list) {
+      ASTNode *v = l->node;
+      if (v->var.expr == NULL) continue;
+
+      char *name = strdup(v->var.name);
+      if (name == NULL) return -1;
+
+      if (append_stmt(&tail, ast_new_assign(name, v->var.expr, v->loc))) return -1;
+      v->var.expr = NULL;
+    }
+  }
+
+  *tail = body->body.stmts;
+  body->body.stmts = assigns;
+
+  return 0;
+}
+
+static int _inline_stmt(ASTNode *s, struct Caller *cl);
+
+static int _inline_stmt_list(ASTList *l, struct Caller *cl) {
+  for ( ; l != NULL ; l = l->list) {
+    if (_inline_stmt(l->node, cl)) return -1;
+  }
+
+  return 0;
+}
+
+static int _inline_stmt(ASTNode *s, struct Caller *cl) {
+  ASTList *pre = NULL;
+  ASTList **pre_tail = &pre;
+
+  if (s == NULL) return 0;
+
+  switch (s->kind) {
+    case N_BODY:
+      if (initializers_to_stmts(s, cl->g)) return -1;
+      return _inline_stmt_list(s->body.stmts, cl);
+
+    case N_BLOCK:
+      return _inline_stmt_list(s->block.stmts, cl);
+
+    case N_ASSIGN:
+      if (_inline_expr(&s->assign.rhs, cl, &pre_tail)) return -1;
+      return wrap_stmt(s, pre);
+
+    case N_RETURN:
+      if (_inline_expr(&s->ret.expr, cl, &pre_tail)) return -1;
+      return wrap_stmt(s, pre);
+
+    case N_IF:
+      if (_inline_stmt(s->branch.then_branch, cl)) return -1;
+      if (_inline_stmt(s->branch.else_branch, cl)) return -1;
+
+      // the condition is evaluated once, before either branch
+      if (_inline_expr(&s->branch.cond, cl, &pre_tail)) return -1;
+      return wrap_stmt(s, pre);
+
+    case N_WHILE:
+      // the condition is evaluated on every iteration, calls in it are kept
+      return _inline_stmt(s->branch.then_branch, cl);
+
+    default:
+      return 0;
+  }
+}
+
+/* nodes of a method body, initializers included */
+static unsigned int method_size(const ASTNode *m) {
+  const ASTNode *body = m->method.body;
+  unsigned int size = ast_list_nodes(body->body.stmts);
+
+  for (const ASTList *d = body->body.decls ; d != NULL ; d = d->list) {
+    for (const ASTList *l = d->node->decl.vars ; l != NULL ; l = l->list) {
+      size += 1 + ast_size(l->node->var.expr);
+    }
+  }
+
+  return size;
+}
+
+/* a growth of percent of size, but always enough for one body */
+static unsigned int growth_budget(unsigned int size, int percent) {
+  unsigned long long budget = (unsigned long long)size * (unsigned int)percent / 100;
+  if (budget < (unsigned int)options.inline_limit) budget = (unsigned int)options.inline_limit;
+  return budget > UINT_MAX ? UINT_MAX : (unsigned int)budget;
+}
+
+static int inline_method(ASTNode *m, const CallGraph *g, unsigned int *unit) {
+  struct Caller cl = { g, NULL, growth_budget(method_size(m), options.inline_growth), unit };
+
+  if (_inline_stmt(m->method.body, &cl)) {
+    ast_list_free(cl.locals);
+    return -1;
+  }
+
+  if (cl.locals == NULL) return 0;
+
+  // declare the new locals after those of the method
+  ASTList **tail = &m->method.body->body.decls;
+  while (*tail != NULL) tail = &(*tail)->list;
+
+  *tail = ast_list_prepend(NULL, ast_new_decl(TYPE_INT, ast_list_reverse(cl.locals),
+                                              m->method.body->loc));
+  return (*tail == NULL) ? -1 : 0;
+}
+
+int inline_ast(ASTNode *root, const CallGraph *g) {
+  if (root == NULL || root->kind != N_PROGRAM) return -1;
+
+  unsigned int size = 0;
+  for (size_t k = 0 ; k < g->n_methods ; k++) size += method_size(g->methods[k]);
+  unsigned int unit = growth_budget(size, options.inline_unit_growth);
+
+  // callees first, so that their bodies are final when copied
+  for (size_t k = 0 ; k < g->n_methods ; k++) {
+    if (inline_method(g->methods[g->order[k]], g, &unit)) return -1;
+  }
+
+  return 0;
+}
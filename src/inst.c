@@ -0,0 +1,186 @@
+#include "inst.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COL_LABEL 10
+#define COL_OPCODE 4
+#define COL_ADDR 22
+
+static int copy_str(char *dst, size_t len, const char *src) {
+  if (src == NULL) {
+    dst[0] = '\0';
+    return 0;
+  }
+
+  if (strlen(src) >= len) return -1;
+  strcpy(dst, src);
+
+  return 0;
+}
+
+MixInst *inst_new(enum InstKind kind, const char *label, const char *opcode,
+                  const char *address, int index, const char *field,
+                  const char *comment, YYLTYPE loc) {
+  MixInst *i = calloc(1, sizeof(MixInst));
+  if (i == NULL) return NULL;
+
+  i->kind = kind;
+  i->index = index;
+  i->loc = loc;
+
+  if (copy_str(i->label, sizeof(i->label), label) ||
+      copy_str(i->opcode, sizeof(i->opcode), opcode) ||
+      copy_str(i->address, sizeof(i->address), address) ||
+      copy_str(i->field, sizeof(i->field), field)) {
+    free(i);
+    return NULL;
+  }
+
+  if (comment != NULL) {
+    i->comment = strdup(comment);
+    if (i->comment == NULL) {
+      free(i);
+      return NULL;
+    }
+  }
+
+  return i;
+}
+
+void inst_append(InstList *l, MixInst *i) {
+  i->prev = l->tail;
+  i->next = NULL;
+
+  if (l->tail) l->tail->next = i;
+  else l->head = i;
+
+  l->tail = i;
+  l->n_inst += 1;
+}
+
+void inst_insert_before(InstList *l, MixInst *pos, MixInst *i) {
+  if (pos == NULL) {
+    inst_append(l, i);
+    return;
+  }
+
+  i->next = pos;
+  i->prev = pos->prev;
+
+  if (pos->prev) pos->prev->next = i;
+  else l->head = i;
+
+  pos->prev = i;
+  l->n_inst += 1;
+}
+
+void inst_unlink(InstList *l, MixInst *i) {
+  if (i->prev) i->prev->next = i->next;
+  else l->head = i->next;
+
+  if (i->next) i->next->prev = i->prev;
+  else l->tail = i->prev;
+
+  i->prev = NULL;
+  i->next = NULL;
+  l->n_inst -= 1;
+}
+
+void inst_remove(InstList *l, MixInst *i) {
+  inst_unlink(l, i);
+
+  free(i->comment);
+  free(i);
+}
+
+int inst_is(const MixInst *i, const char *opcode) {
+  return i != NULL && i->kind == INST_OP && strcmp(i->opcode, opcode) == 0;
+}
+
+int inst_operand(const MixInst *i, char *buf, size_t len) {
+  int n = snprintf(buf, len, "%s", i->address);
+
+  if (n >= 0 && i->index != 0) {
+    n += snprintf(buf + n, (size_t)n < len ? len - n : 0, ",%d", i->index);
+  }
+  if (n >= 0 && i->field[0]) {
+    n += snprintf(buf + n, (size_t)n < len ? len - n : 0, "(%s)", i->field);
+  }
+
+  return (n < 0 || (size_t)n >= len) ? -1 : 0;
+}
+
+/* append formatted text to a growing buffer */
+static int buf_printf(char **buf, size_t *len, size_t *cap, const char *fmt, ...) {
+  va_list args;
+
+  for (;;) {
+    va_start(args, fmt);
+    int n = vsnprintf(*buf + *len, *cap - *len, fmt, args);
+    va_end(args);
+
+    if (n < 0) return -1;
+    if ((size_t)n < *cap - *len) {
+      *len += n;
+      return 0;
+    }
+
+    size_t new_cap = 2 * (*cap) + n;
+    char *b = realloc(*buf, new_cap);
+    if (b == NULL) return -1;
+
+    *buf = b;
+    *cap = new_cap;
+  }
+}
+
+int inst_list_write(const InstList *l, FILE *f, int annotate) {
+  size_t cap = 4096, len = 0;
+  char *buf = malloc(cap);
+  char operand[INST_ADDRESS_LEN + INST_FIELD_LEN + 8];
+  int status = 0;
+
+  if (buf == NULL) return -1;
+
+  for (const MixInst *i = l->head ; i != NULL && status == 0 ; i = i->next) {
+    switch (i->kind) {
+      case INST_COMMENT:
+        status = buf_printf(&buf, &len, &cap, "* %s\n", i->comment ? i->comment : "");
+        break;
+
+      case INST_LINE:
+        status = buf_printf(&buf, &len, &cap, "%s\n", i->comment ? i->comment : "");
+        break;
+
+      case INST_OP:
+        if (inst_operand(i, operand, sizeof(operand))) {
+          status = -1;
+          break;
+        }
+        status = buf_printf(&buf, &len, &cap, "%-*s %-*s %-*s",
+                            COL_LABEL, i->label, COL_OPCODE, i->opcode, COL_ADDR, operand);
+        if (status == 0 && i->comment && i->comment[0]) {
+          status = buf_printf(&buf, &len, &cap, " ; %s", i->comment);
+        }
+        if (status == 0 && annotate && i->method != NULL) {
+          status = buf_printf(&buf, &len, &cap, "%s @%s:%d",
+                              (i->comment && i->comment[0]) ? "" : " ;",
+                              i->method, i->loc.first_line);
+        }
+        if (status == 0) status = buf_printf(&buf, &len, &cap, "\n");
+        break;
+    }
+  }
+
+  if (status == 0 && fwrite(buf, 1, len, f) != len) status = -1;
+
+  free(buf);
+  return status;
+}
+
+void inst_list_free(InstList *l) {
+  while (l->head != NULL) inst_remove(l, l->head);
+}
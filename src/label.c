@@ -41,3 +41,15 @@ char *label_else(unsigned int index) {
 char *label_done(unsigned int index) {
   return label_fmt("DONE", index);
 }
+
+char *label_test(unsigned int index) {
+  return label_fmt("TEST", index);
+}
+
+char *label_pool(unsigned int index) {
+  return label_fmt("POOL", index);
+}
+
+char *label_block(unsigned int index) {
+  return label_fmt("BLCK", index);
+}
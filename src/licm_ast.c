@@ -0,0 +1,380 @@
+#include "licm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// numbers the locals holding hoisted expressions
+static unsigned int licm_index = 1;
+
+/* variables assigned anywhere in a loop */
+struct Assigned {
+  const char **names;
+  size_t n;
+};
+
+/* invariant expression moved out of the loop and the local holding it */
+struct Hoist {
+  ASTNode *expr;
+  char *name;
+};
+
+struct Loop {
+  struct Assigned assigned;
+  struct Hoist *hoists;
+  size_t n_hoists;
+};
+
+static int is_assigned(const struct Assigned *a, const char *name) {
+  for (size_t i = 0 ; i < a->n ; i++) {
+    if (strcmp(a->names[i], name) == 0) return 1;
+  }
+
+  return 0;
+}
+
+static int collect_assigned(const ASTNode *n, struct Assigned *a);
+
+static int collect_assigned_list(const ASTList *l, struct Assigned *a) {
+  for ( ; l != NULL ; l = l->list) {
+    if (collect_assigned(l->node, a)) return -1;
+  }
+
+  return 0;
+}
+
+static int collect_assigned(const ASTNode *n, struct Assigned *a) {
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_BLOCK:
+      return collect_assigned_list(n->block.stmts, a);
+
+    case N_ASSIGN:
+      if (is_assigned(a, n->assign.location)) return 0;
+
+      const char **names = realloc(a->names, (a->n + 1) * sizeof(const char *));
+      if (names == NULL) return -1;
+
+      a->names = names;
+      a->names[a->n++] = n->assign.location;
+      return 0;
+
+    case N_IF:
+    case N_WHILE:
+      if (collect_assigned(n->branch.then_branch, a)) return -1;
+      return collect_assigned(n->branch.else_branch, a);
+
+    default:
+      return 0;
+  }
+}
+
+static int is_relop(enum OpKind op) {
+  return op >= OP_RELOP_LEQ && op <= OP_RELOP_NEQ;
+}
+
+/* the value of e is the same on every iteration. The hoisted expression
+   is evaluated even if the loop body never runs: calls (which may not
+   terminate) and divisions by a variable are only hoisted from the
+   condition of the loop itself, which is always evaluated once */
+static int is_invariant(const ASTNode *e, const struct Assigned *a, int in_cond) {
+  switch (e->kind) {
+    case N_NUMBER:
+      return 1;
+
+    case N_IDENTIFIER:
+      return !is_assigned(a, e->identifier.name);
+
+    case N_UNARY:
+      return is_invariant(e->unary.expr, a, in_cond);
+
+    case N_BINOP:
+      if (e->binop.op == OP_MULOP_DIV && !in_cond &&
+          (e->binop.rhs->kind != N_NUMBER || e->binop.rhs->number.val == 0)) return 0;
+      return is_invariant(e->binop.lhs, a, in_cond) && is_invariant(e->binop.rhs, a, in_cond);
+
+    case N_CALL:
+      if (!in_cond) return 0;
+      for (const ASTList *l = e->call.args ; l != NULL ; l = l->list) {
+        if (!is_invariant(l->node, a, in_cond)) return 0;
+      }
+      return 1;
+
+    default:
+      return 0;
+  }
+}
+
+/* the expression costs more than loading a variable. A comparison is left
+   in place, to keep branching on the comparison indicator */
+static int is_worth_hoisting(const ASTNode *e) {
+  switch (e->kind) {
+    case N_BINOP:
+      return !is_relop(e->binop.op);
+
+    case N_UNARY:
+      return is_worth_hoisting(e->unary.expr);
+
+    case N_CALL:
+      return 1;
+
+    default:
+      return 0;
+  }
+}
+
+static int same_expr(const ASTNode *x, const ASTNode *y) {
+  if (x->kind != y->kind) return 0;
+
+  switch (x->kind) {
+    case N_NUMBER:
+      return x->number.val == y->number.val;
+
+    case N_IDENTIFIER:
+      return strcmp(x->identifier.name, y->identifier.name) == 0;
+
+    case N_UNARY:
+      return x->unary.op == y->unary.op && same_expr(x->unary.expr, y->unary.expr);
+
+    case N_BINOP:
+      return x->binop.op == y->binop.op && same_expr(x->binop.lhs, y->binop.lhs)
+             && same_expr(x->binop.rhs, y->binop.rhs);
+
+    case N_CALL:
+      if (strcmp(x->call.fname, y->call.fname) != 0) return 0;
+
+      const ASTList *a = x->call.args, *b = y->call.args;
+      for ( ; a != NULL && b != NULL ; a = a->list, b = b->list) {
+        if (!same_expr(a->node, b->node)) return 0;
+      }
+      return a == NULL && b == NULL;
+
+    default:
+      return 0;
+  }
+}
+
+/* fresh local for a hoisted expression: .invN */
+static char *fresh_name(void) {
+  char buf[32];
+
+  if (snprintf(buf, sizeof(buf), ".inv%u", licm_index++)
+      >= (int)sizeof(buf)) return NULL;
+
+  return strdup(buf);
+}
+
+/* move the expression in slot to the loop preheader, sharing the local
+   of an identical expression already hoisted from the same loop */
+static int hoist(ASTNode **slot, struct Loop *lp) {
+  ASTNode *e = *slot;
+  YYLTYPE loc = e->loc;
+  const char *name = NULL;
+
+  for (size_t i = 0 ; i < lp->n_hoists ; i++) {
+    if (same_expr(lp->hoists[i].expr, e)) name = lp->hoists[i].name;
+  }
+
+  if (name == NULL) {
+    struct Hoist *h = realloc(lp->hoists, (lp->n_hoists + 1) * sizeof(struct Hoist));
+    if (h == NULL) return -1;
+    lp->hoists = h;
+
+    char *fresh = fresh_name();
+    if (fresh == NULL) return -1;
+
+    lp->hoists[lp->n_hoists++] = (struct Hoist) { .expr = e, .name = fresh };
+    name = fresh;
+  } else {
+    ast_free(e);
+  }
+
+  char *copy = strdup(name);
+  if (copy == NULL) return -1;
+
+  *slot = ast_new_identifier(copy, loc);
+  return 0;
+}
+
+/* replace the largest invariant subexpressions of an expression */
+static int _licm_expr(ASTNode **slot, struct Loop *lp, int in_cond) {
+  ASTNode *e = *slot;
+
+  if (e == NULL) return 0;
+  if (is_worth_hoisting(e) && is_invariant(e, &lp->assigned, in_cond)) return hoist(slot, lp);
+
+  switch (e->kind) {
+    case N_BINOP:
+      if (_licm_expr(&e->binop.lhs, lp, in_cond)) return -1;
+      return _licm_expr(&e->binop.rhs, lp, in_cond);
+
+    case N_UNARY:
+      return _licm_expr(&e->unary.expr, lp, in_cond);
+
+    case N_CALL:
+      for (ASTList *l = e->call.args ; l != NULL ; l = l->list) {
+        if (_licm_expr(&l->node, lp, in_cond)) return -1;
+      }
+      return 0;
+
+    default:
+      return 0;
+  }
+}
+
+/* hoist from the statements of a loop body, nested loops included */
+static int _licm_body(ASTNode *s, struct Loop *lp) {
+  if (s == NULL) return 0;
+
+  switch (s->kind) {
+    case N_BLOCK:
+      for (ASTList *l = s->block.stmts ; l != NULL ; l = l->list) {
+        if (_licm_body(l->node, lp)) return -1;
+      }
+      return 0;
+
+    case N_ASSIGN:
+      return _licm_expr(&s->assign.rhs, lp, 0);
+
+    case N_IF:
+    case N_WHILE:
+      if (_licm_expr(&s->branch.cond, lp, 0)) return -1;
+      if (_licm_body(s->branch.then_branch, lp)) return -1;
+      return _licm_body(s->branch.else_branch, lp);
+
+    default:
+      // a return leaves the loop, its value is computed at most once
+      return 0;
+  }
+}
+
+static int append_stmt(ASTList ***tail, ASTNode *s) {
+  **tail = ast_list_prepend(NULL, s);
+  if (**tail == NULL) return -1;
+
+  *tail = &(**tail)->list;
+  return 0;
+}
+
+/* the preheader assignments go before the loop, which becomes a block in place */
+static int wrap_loop(ASTNode *s, struct Loop *lp, ASTList **locals) {
+  ASTList *pre = NULL;
+  ASTList **tail = &pre;
+
+  for (size_t i = 0 ; i < lp->n_hoists ; i++) {
+    struct Hoist *h = &lp->hoists[i];
+    char *decl_name = strdup(h->name);
+
+    if (decl_name == NULL) {
+      ast_list_free(pre);
+      return -1;
+    }
+    *locals = ast_list_prepend(*locals, ast_new_var(decl_name, NULL, h->expr->loc));
+
+    if (append_stmt(&tail, ast_new_assign(h->name, h->expr, h->expr->loc))) {
+      ast_list_free(pre);
+      return -1;
+    }
+    h->name = NULL;
+    h->expr = NULL;
+  }
+
+  ASTNode *loop = malloc(sizeof(ASTNode));
+  if (loop == NULL || append_stmt(&tail, loop)) {
+    free(loop);
+    ast_list_free(pre);
+    return -1;
+  }
+  *loop = *s;
+
+  s->kind = N_BLOCK;
+  s->block.stmts = pre;
+
+  return 0;
+}
+
+static void loop_free(struct Loop *lp) {
+  for (size_t i = 0 ; i < lp->n_hoists ; i++) {
+    ast_free(lp->hoists[i].expr);
+    free(lp->hoists[i].name);
+  }
+
+  free(lp->hoists);
+  free(lp->assigned.names);
+}
+
+static int _licm_stmt(ASTNode *s, ASTList **locals);
+
+static int _licm_stmt_list(ASTList *l, ASTList **locals) {
+  for ( ; l != NULL ; l = l->list) {
+    if (_licm_stmt(l->node, locals)) return -1;
+  }
+
+  return 0;
+}
+
+static int _licm_stmt(ASTNode *s, ASTList **locals) {
+  struct Loop lp = { { NULL, 0 }, NULL, 0 };
+  int status = -1;
+
+  if (s == NULL) return 0;
+
+  switch (s->kind) {
+    case N_BODY:
+      return _licm_stmt_list(s->body.stmts, locals);
+
+    case N_BLOCK:
+      return _licm_stmt_list(s->block.stmts, locals);
+
+    case N_IF:
+      if (_licm_stmt(s->branch.then_branch, locals)) return -1;
+      return _licm_stmt(s->branch.else_branch, locals);
+
+    case N_WHILE:
+      if (collect_assigned(s->branch.then_branch, &lp.assigned)) goto done;
+      if (_licm_expr(&s->branch.cond, &lp, 1)) goto done;
+      if (_licm_body(s->branch.then_branch, &lp)) goto done;
+
+      // inner loops hoist what is only invariant in them
+      if (_licm_stmt(s->branch.then_branch, locals)) goto done;
+
+      status = (lp.n_hoists > 0) ? wrap_loop(s, &lp, locals) : 0;
+
+    done:
+      loop_free(&lp);
+      return status;
+
+    default:
+      return 0;
+  }
+}
+
+static int licm_method(ASTNode *m) {
+  ASTList *locals = NULL;
+
+  if (_licm_stmt(m->method.body, &locals)) {
+    ast_list_free(locals);
+    return -1;
+  }
+
+  if (locals == NULL) return 0;
+
+  // declare the new locals after those of the method
+  ASTList **tail = &m->method.body->body.decls;
+  while (*tail != NULL) tail = &(*tail)->list;
+
+  *tail = ast_list_prepend(NULL, ast_new_decl(TYPE_INT, ast_list_reverse(locals),
+                                              m->method.body->loc));
+  return (*tail == NULL) ? -1 : 0;
+}
+
+int licm_ast(ASTNode *root) {
+  if (root == NULL || root->kind != N_PROGRAM) return -1;
+
+  for (ASTList *l = root->prog.methods ; l != NULL ; l = l->list) {
+    if (licm_method(l->node)) return -1;
+  }
+
+  return 0;
+}
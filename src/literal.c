@@ -0,0 +1,146 @@
+#include "literal.h"
+#include "label.h"
+#include "mix.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// largest magnitude in the address field, sign and two bytes
+#define IMMEDIATE_MAX (MIX_BYTE_SIZE * MIX_BYTE_SIZE - 1)
+
+/* the value n of a literal operand =n= */
+static int literal_value(const MixInst *i, long *value) {
+  size_t len = strlen(i->address);
+  char *end = NULL;
+
+  if (i->kind != INST_OP || len < 3) return -1;
+  if (i->address[0] != '=' || i->address[len - 1] != '=') return -1;
+
+  *value = strtol(i->address + 1, &end, 10);
+  return (end == i->address + len - 1) ? 0 : -1;
+}
+
+/* register loaded by LDr and LDrN, 0 otherwise */
+static char load_reg(const char *opcode, int negative) {
+  size_t len = strlen(opcode);
+
+  if (strncmp(opcode, "LD", 2) != 0 || len != (negative ? 4u : 3u)) return 0;
+  if (negative && opcode[3] != 'N') return 0;
+  if (strchr("AX123456", opcode[2]) == NULL) return 0;
+
+  return opcode[2];
+}
+
+/* opcode and address of the immediate form of an instruction on =value=,
+   -1 if there is none */
+static int immediate_form(const MixInst *i, long value, char *opcode, size_t len, long *address) {
+  char reg;
+
+  if (i->index != 0 || i->field[0] || labs(value) > IMMEDIATE_MAX) return -1;
+
+  if ((reg = load_reg(i->opcode, 0))) {
+    // ENTr 0 gives +0 like the literal
+    snprintf(opcode, len, "%s%c", value >= 0 ? "ENT" : "ENN", reg);
+    *address = labs(value);
+  } else if ((reg = load_reg(i->opcode, 1))) {
+    // LDrN =0= loads -0, so does ENNr 0
+    snprintf(opcode, len, "%s%c", value >= 0 ? "ENN" : "ENT", reg);
+    *address = labs(value);
+  } else if (strcmp(i->opcode, "ADD") == 0) {
+    snprintf(opcode, len, "%s", value >= 0 ? "INCA" : "DECA");
+    *address = labs(value);
+  } else if (strcmp(i->opcode, "SUB") == 0) {
+    snprintf(opcode, len, "%s", value >= 0 ? "DECA" : "INCA");
+    *address = labs(value);
+  } else {
+    return -1;
+  }
+
+  return 0;
+}
+
+int literal_immediate(InstList *l) {
+  for (MixInst *i = l->head ; i != NULL ; i = i->next) {
+    char opcode[INST_OPCODE_LEN + 1];
+    long value, address;
+
+    if (literal_value(i, &value)) continue;
+    if (immediate_form(i, value, opcode, sizeof(opcode), &address)) continue;
+
+    strcpy(i->opcode, opcode);
+    if (snprintf(i->address, sizeof(i->address), "%ld", address)
+        >= (int)sizeof(i->address)) return -1;
+  }
+
+  return 0;
+}
+
+struct PoolWord {
+  long value;
+  char label[INST_LABEL_LEN + 1];
+};
+
+int literal_pool(InstList *l) {
+  struct PoolWord *pool = NULL;
+  size_t n = 0;
+  MixInst *end = NULL;
+
+  for (MixInst *i = l->head ; i != NULL ; i = i->next) {
+    long value;
+    size_t k;
+
+    if (inst_is(i, "END")) end = i;
+    if (literal_value(i, &value)) continue;
+
+    for (k = 0 ; k < n && pool[k].value != value ; k++);
+
+    if (k == n) {
+      struct PoolWord *p = realloc(pool, (n + 1) * sizeof(struct PoolWord));
+      char *label = label_pool(n + 1);
+
+      if (p == NULL || label == NULL) {
+        free(label);
+        free(p ? p : pool);
+        return -1;
+      }
+
+      pool = p;
+      pool[n].value = value;
+      strcpy(pool[n].label, label);
+      free(label);
+      n += 1;
+    }
+
+    strcpy(i->address, pool[k].label);
+  }
+
+  // the pool goes after the data, before the comment on END
+  MixInst *pos = end;
+  while (pos != NULL && pos->prev != NULL && pos->prev->kind == INST_COMMENT) pos = pos->prev;
+
+  YYLTYPE loc = pos ? pos->loc : (YYLTYPE) { 0, 0, 0, 0 };
+  int status = 0;
+
+  if (n > 0) {
+    MixInst *c = inst_new(INST_COMMENT, NULL, NULL, NULL, 0, NULL,
+                          "Constant pool (one word per distinct literal)", loc);
+    if (c == NULL) status = -1;
+    else inst_insert_before(l, pos, c);
+  }
+
+  for (size_t k = 0 ; k < n && status == 0 ; k++) {
+    char address[INST_ADDRESS_LEN];
+    MixInst *w = NULL;
+
+    if (snprintf(address, sizeof(address), "%ld", pool[k].value) < (int)sizeof(address)) {
+      w = inst_new(INST_OP, pool[k].label, "CON", address, 0, NULL, NULL, loc);
+    }
+
+    if (w == NULL) status = -1;
+    else inst_insert_before(l, pos, w);
+  }
+
+  free(pool);
+  return status;
+}
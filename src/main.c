@@ -2,6 +2,8 @@
 #include "ast.h"
 #include "table.h"
 #include "emit.h"
+#include "options.h"
+#include "pass.h"
 #include "gen.h"
 
 #include <stdio.h>
@@ -32,13 +34,18 @@ int set_output_file(const char *fname, FILE **fp);
 int main(int argc, char ** argv) {
   char *ifname = NULL;
   char *ofname = NULL;
-  if (argc > 1) {
-    ifname = argv[1];
-    if (argc > 2) {
-      ofname = argv[2];
+  for (int i = 1 ; i < argc ; i++) {
+    if (argv[i][0] == '-' && argv[i][1] != '\0') {
+      exit_if (options_parse_flag(argv[i]));
+    } else if (ifname == NULL) {
+      ifname = argv[i];
+    } else if (ofname == NULL) {
+      ofname = argv[i];
     }
   }
 
+  options_finalize();
+
   exit_if (set_input_file(ifname, &yyin));
   exit_if (set_output_file(ofname, &mixout));
 
@@ -63,9 +70,16 @@ int main(int argc, char ** argv) {
   printf("\n");
 #endif
 
-  exit_if (gen_mixal_from_ast(ast_root, function_table));
+  PassManager pm;
+  pass_manager_init(&pm, ast_root, function_table, &mixcode);
+  exit_if (pass_run_pipeline(&pm));
+  exit_if (gen_check_code_size(&mixcode));
+
+  exit_if (emit_flush());
+
+  if (options.pass_stats) pass_print_stats(stderr);
 
-  ht_free(function_table);
+  pass_manager_free(&pm);
   ast_free(ast_root);
 
   return 0;
@@ -0,0 +1,110 @@
+#include "mix.h"
+
+#include <string.h>
+
+#define FIELD(l, r) (8 * (l) + (r))
+
+// operation codes, default fields and timings from TAOCP Vol. 1, Section 1.3.1
+static const MixOpcode mix_opcodes[] = {
+  {"NOP",   0, 0,  1},
+  {"ADD",   1, FIELD(0, 5),  2},
+  {"SUB",   2, FIELD(0, 5),  2},
+  {"MUL",   3, FIELD(0, 5), 10},
+  {"DIV",   4, FIELD(0, 5), 12},
+  {"NUM",   5, 0, 10}, {"CHAR",  5, 1, 10}, {"HLT",   5, 2, 10},
+  {"SLA",   6, 0,  2}, {"SRA",   6, 1,  2}, {"SLAX",  6, 2,  2},
+  {"SRAX",  6, 3,  2}, {"SLC",   6, 4,  2}, {"SRC",   6, 5,  2},
+  {"MOVE",  7, 1,  1},
+  {"LDA",   8, FIELD(0, 5),  2}, {"LD1",   9, FIELD(0, 5),  2},
+  {"LD2",  10, FIELD(0, 5),  2}, {"LD3",  11, FIELD(0, 5),  2},
+  {"LD4",  12, FIELD(0, 5),  2}, {"LD5",  13, FIELD(0, 5),  2},
+  {"LD6",  14, FIELD(0, 5),  2}, {"LDX",  15, FIELD(0, 5),  2},
+  {"LDAN", 16, FIELD(0, 5),  2}, {"LD1N", 17, FIELD(0, 5),  2},
+  {"LD2N", 18, FIELD(0, 5),  2}, {"LD3N", 19, FIELD(0, 5),  2},
+  {"LD4N", 20, FIELD(0, 5),  2}, {"LD5N", 21, FIELD(0, 5),  2},
+  {"LD6N", 22, FIELD(0, 5),  2}, {"LDXN", 23, FIELD(0, 5),  2},
+  {"STA",  24, FIELD(0, 5),  2}, {"ST1",  25, FIELD(0, 5),  2},
+  {"ST2",  26, FIELD(0, 5),  2}, {"ST3",  27, FIELD(0, 5),  2},
+  {"ST4",  28, FIELD(0, 5),  2}, {"ST5",  29, FIELD(0, 5),  2},
+  {"ST6",  30, FIELD(0, 5),  2}, {"STX",  31, FIELD(0, 5),  2},
+  {"STJ",  32, FIELD(0, 2),  2}, {"STZ",  33, FIELD(0, 5),  2},
+  {"JBUS", 34, 0,  1}, {"IOC",  35, 0,  1}, {"IN",   36, 0,  1},
+  {"OUT",  37, 0,  1}, {"JRED", 38, 0,  1},
+  {"JMP",  39, 0,  1}, {"JSJ",  39, 1,  1}, {"JOV",  39, 2,  1},
+  {"JNOV", 39, 3,  1}, {"JL",   39, 4,  1}, {"JE",   39, 5,  1},
+  {"JG",   39, 6,  1}, {"JGE",  39, 7,  1}, {"JNE",  39, 8,  1},
+  {"JLE",  39, 9,  1},
+  {"JAN",  40, 0,  1}, {"JAZ",  40, 1,  1}, {"JAP",  40, 2,  1},
+  {"JANN", 40, 3,  1}, {"JANZ", 40, 4,  1}, {"JANP", 40, 5,  1},
+  {"J1N",  41, 0,  1}, {"J1Z",  41, 1,  1}, {"J1P",  41, 2,  1},
+  {"J1NN", 41, 3,  1}, {"J1NZ", 41, 4,  1}, {"J1NP", 41, 5,  1},
+  {"J2N",  42, 0,  1}, {"J2Z",  42, 1,  1}, {"J2P",  42, 2,  1},
+  {"J2NN", 42, 3,  1}, {"J2NZ", 42, 4,  1}, {"J2NP", 42, 5,  1},
+  {"J3N",  43, 0,  1}, {"J3Z",  43, 1,  1}, {"J3P",  43, 2,  1},
+  {"J3NN", 43, 3,  1}, {"J3NZ", 43, 4,  1}, {"J3NP", 43, 5,  1},
+  {"J4N",  44, 0,  1}, {"J4Z",  44, 1,  1}, {"J4P",  44, 2,  1},
+  {"J4NN", 44, 3,  1}, {"J4NZ", 44, 4,  1}, {"J4NP", 44, 5,  1},
+  {"J5N",  45, 0,  1}, {"J5Z",  45, 1,  1}, {"J5P",  45, 2,  1},
+  {"J5NN", 45, 3,  1}, {"J5NZ", 45, 4,  1}, {"J5NP", 45, 5,  1},
+  {"J6N",  46, 0,  1}, {"J6Z",  46, 1,  1}, {"J6P",  46, 2,  1},
+  {"J6NN", 46, 3,  1}, {"J6NZ", 46, 4,  1}, {"J6NP", 46, 5,  1},
+  {"JXN",  47, 0,  1}, {"JXZ",  47, 1,  1}, {"JXP",  47, 2,  1},
+  {"JXNN", 47, 3,  1}, {"JXNZ", 47, 4,  1}, {"JXNP", 47, 5,  1},
+  {"INCA", 48, 0,  1}, {"DECA", 48, 1,  1}, {"ENTA", 48, 2,  1}, {"ENNA", 48, 3,  1},
+  {"INC1", 49, 0,  1}, {"DEC1", 49, 1,  1}, {"ENT1", 49, 2,  1}, {"ENN1", 49, 3,  1},
+  {"INC2", 50, 0,  1}, {"DEC2", 50, 1,  1}, {"ENT2", 50, 2,  1}, {"ENN2", 50, 3,  1},
+  {"INC3", 51, 0,  1}, {"DEC3", 51, 1,  1}, {"ENT3", 51, 2,  1}, {"ENN3", 51, 3,  1},
+  {"INC4", 52, 0,  1}, {"DEC4", 52, 1,  1}, {"ENT4", 52, 2,  1}, {"ENN4", 52, 3,  1},
+  {"INC5", 53, 0,  1}, {"DEC5", 53, 1,  1}, {"ENT5", 53, 2,  1}, {"ENN5", 53, 3,  1},
+  {"INC6", 54, 0,  1}, {"DEC6", 54, 1,  1}, {"ENT6", 54, 2,  1}, {"ENN6", 54, 3,  1},
+  {"INCX", 55, 0,  1}, {"DECX", 55, 1,  1}, {"ENTX", 55, 2,  1}, {"ENNX", 55, 3,  1},
+  {"CMPA", 56, FIELD(0, 5),  2}, {"CMP1", 57, FIELD(0, 5),  2},
+  {"CMP2", 58, FIELD(0, 5),  2}, {"CMP3", 59, FIELD(0, 5),  2},
+  {"CMP4", 60, FIELD(0, 5),  2}, {"CMP5", 61, FIELD(0, 5),  2},
+  {"CMP6", 62, FIELD(0, 5),  2}, {"CMPX", 63, FIELD(0, 5),  2},
+  {"EQU",  MIX_PSEUDO, 0, 0}, {"ORIG", MIX_PSEUDO, 0, 0},
+  {"CON",  MIX_PSEUDO, 0, 0}, {"ALF",  MIX_PSEUDO, 0, 0},
+  {"END",  MIX_PSEUDO, 0, 0},
+};
+
+const MixOpcode *mix_opcode_find(const char *name) {
+  if (name == NULL) return NULL;
+
+  for (size_t i = 0 ; i < sizeof(mix_opcodes) / sizeof(mix_opcodes[0]) ; i++) {
+    if (strcmp(mix_opcodes[i].name, name) == 0) return &mix_opcodes[i];
+  }
+
+  return NULL;
+}
+
+const MixOpcode *mix_opcode_decode(unsigned int code, unsigned int field) {
+  const MixOpcode *first = NULL;
+
+  for (size_t i = 0 ; i < sizeof(mix_opcodes) / sizeof(mix_opcodes[0]) ; i++) {
+    if (mix_opcodes[i].code != code) continue;
+
+    // the field selects the operation of NUM/CHAR/HLT, shifts, jumps, ENTA...
+    if (mix_opcodes[i].field == field) return &mix_opcodes[i];
+    if (first == NULL) first = &mix_opcodes[i];
+  }
+
+  return first;
+}
+
+unsigned int mix_opcode_time(const MixOpcode *op, unsigned int field) {
+  if (op == NULL) return 0;
+
+  // MOVE takes one unit plus two units per word moved
+  if (op->code == 7) return op->time + 2 * field;
+
+  return op->time;
+}
+
+long long mix_word_wrap(long long value) {
+  long long modulus = 1;
+  for (int i = 0 ; i < MIX_WORD_BYTES ; i++) modulus *= MIX_BYTE_SIZE;
+
+  long long magnitude = (value < 0 ? -value : value) % modulus;
+
+  return value < 0 ? -magnitude : magnitude;
+}
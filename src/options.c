@@ -0,0 +1,193 @@
+#include "options.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// flags left at -1 are set by options_finalize
+struct Options options = {
+  .opt_level = 0,
+  .opt_size = 0,
+  .fold_constants = -1,
+  .fuse_compare = -1,
+  .register_expr = -1,
+  .static_frame = -1,
+  .eval_calls = -1,
+  .eval_limit = 100000,
+  .inline_methods = -1,
+  .inline_limit = 40,
+  .inline_growth = 100,
+  .inline_unit_growth = 30,
+  .tail_calls = -1,
+  .tail_calls_report = -1,
+  .sccp = -1,
+  .licm = -1,
+  .loop_rotate = -1,
+  .cse = -1,
+  .dce = -1,
+  .dce_report = -1,
+  .strength_reduce = -1,
+  .immediate = -1,
+  .literal_pool = -1,
+  .register_alloc = -1,
+  .register_alloc_report = -1,
+  .peephole = -1,
+  .peephole_stats = -1,
+  .cfg = -1,
+  .cfg_stats = -1,
+  .iterate = -1,
+  .pass_stats = -1,
+  .profile = -1,
+};
+
+struct FeatureFlag {
+  const char *name;
+  int *value;
+  int level; // lowest -O level that enables the flag, -1 for none
+};
+
+// flags of the form -f<name> and -fno-<name>
+static const struct FeatureFlag feature_flags[] = {
+  {"fold-constants", &options.fold_constants, 1},
+  {"fuse-compare", &options.fuse_compare, 1},
+  {"register-expr", &options.register_expr, 1},
+  {"static-frame", &options.static_frame, 1},
+  {"eval-calls", &options.eval_calls, 1},
+  {"inline", &options.inline_methods, 1},
+  {"tail-calls", &options.tail_calls, 1},
+  {"tail-calls-report", &options.tail_calls_report, -1},
+  {"sccp", &options.sccp, 1},
+  {"licm", &options.licm, 1},
+  {"loop-rotate", &options.loop_rotate, 1},
+  {"cse", &options.cse, 1},
+  {"dce", &options.dce, 1},
+  {"dce-report", &options.dce_report, -1},
+  {"strength-reduce", &options.strength_reduce, 1},
+  {"immediate", &options.immediate, 1},
+  {"literal-pool", &options.literal_pool, 1},
+  {"register-alloc", &options.register_alloc, 1},
+  {"register-alloc-report", &options.register_alloc_report, -1},
+  {"peephole", &options.peephole, 1},
+  {"peephole-stats", &options.peephole_stats, -1},
+  {"cfg", &options.cfg, 1},
+  {"cfg-stats", &options.cfg_stats, -1},
+  {"iterate", &options.iterate, 2},
+  {"pass-stats", &options.pass_stats, -1},
+  {"profile", &options.profile, -1},
+};
+
+#define N_FEATURE_FLAGS (sizeof(feature_flags) / sizeof(feature_flags[0]))
+
+// flags that trade code size for speed, left off by -Os. Inlining stays
+// on: the small methods it copies are mostly smaller than their calls
+static int *const size_costly[] = {
+  &options.loop_rotate,
+};
+
+#define N_SIZE_COSTLY (sizeof(size_costly) / sizeof(size_costly[0]))
+
+struct ValueFlag {
+  const char *name;
+  int *value;
+};
+
+// flags of the form -f<name>=<n>, n a non-negative integer
+static const struct ValueFlag value_flags[] = {
+  {"eval-limit", &options.eval_limit},
+  {"inline-limit", &options.inline_limit},
+  {"inline-growth", &options.inline_growth},
+  {"inline-unit-growth", &options.inline_unit_growth},
+};
+
+#define N_VALUE_FLAGS (sizeof(value_flags) / sizeof(value_flags[0]))
+
+static int parse_value_flag(const char *name) {
+  const char *eq = strchr(name, '=');
+  char *end = NULL;
+
+  for (size_t i = 0 ; i < N_VALUE_FLAGS ; i++) {
+    size_t len = strlen(value_flags[i].name);
+    if ((size_t)(eq - name) != len || strncmp(value_flags[i].name, name, len) != 0) continue;
+
+    long value = strtol(eq + 1, &end, 10);
+    if (eq[1] == '\0' || *end != '\0' || value < 0 || value > INT_MAX) return -1;
+
+    *value_flags[i].value = (int)value;
+    return 0;
+  }
+
+  return -1;
+}
+
+static int parse_opt_level(const char *level) {
+  // plain -O is the same as -O1
+  if (level[0] == '\0') {
+    options.opt_level = 1;
+    options.opt_size = 0;
+    return 0;
+  }
+
+  if (strcmp(level, "s") == 0) {
+    options.opt_level = 2;
+    options.opt_size = 1;
+    return 0;
+  }
+
+  if (level[0] >= '0' && level[0] <= '0' + OPT_LEVEL_MAX && level[1] == '\0') {
+    options.opt_level = level[0] - '0';
+    options.opt_size = 0;
+    return 0;
+  }
+
+  return -1;
+}
+
+int options_parse_flag(const char *flag) {
+  if (strncmp(flag, "-O", 2) == 0) {
+    if (parse_opt_level(flag + 2) == 0) return 0;
+  } else if (strncmp(flag, "-f", 2) == 0) {
+    const char *name = flag + 2;
+    int value = 1;
+
+    if (strchr(name, '=') != NULL) {
+      if (parse_value_flag(name) == 0) return 0;
+
+      fprintf(stderr, "error: invalid option '%s'\n", flag);
+      fprintf(stderr, "\n");
+      return -1;
+    }
+
+    if (strncmp(name, "no-", 3) == 0) {
+      name += 3;
+      value = 0;
+    }
+
+    for (size_t i = 0 ; i < N_FEATURE_FLAGS ; i++) {
+      if (strcmp(feature_flags[i].name, name) == 0) {
+        *feature_flags[i].value = value;
+        return 0;
+      }
+    }
+  }
+
+  fprintf(stderr, "error: unknown option '%s'\n", flag);
+  fprintf(stderr, "\n");
+  return -1;
+}
+
+void options_finalize(void) {
+  if (options.opt_size) {
+    for (size_t i = 0 ; i < N_SIZE_COSTLY ; i++) {
+      if (*size_costly[i] == -1) *size_costly[i] = 0;
+    }
+  }
+
+  for (size_t i = 0 ; i < N_FEATURE_FLAGS ; i++) {
+    const struct FeatureFlag *f = &feature_flags[i];
+
+    if (*f->value == -1) {
+      *f->value = (f->level >= 0 && options.opt_level >= f->level);
+    }
+  }
+}
@@ -0,0 +1,1850 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 0
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 1 "src/parser.y"
+
+#include "ast.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* declare the lexer function */
+int yylex(void);
+
+/* declare the error handler */
+void yyerror(ASTNode **ast, const char *s);
+
+#line 84 "src/parser.tab.c"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+#include "parser.tab.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_IF = 3,                         /* IF  */
+  YYSYMBOL_ELSE = 4,                       /* ELSE  */
+  YYSYMBOL_WHILE = 5,                      /* WHILE  */
+  YYSYMBOL_RETURN = 6,                     /* RETURN  */
+  YYSYMBOL_BREAK = 7,                      /* BREAK  */
+  YYSYMBOL_TYPE = 8,                       /* TYPE  */
+  YYSYMBOL_TRUE = 9,                       /* TRUE  */
+  YYSYMBOL_FALSE = 10,                     /* FALSE  */
+  YYSYMBOL_IDENTIFIER = 11,                /* IDENTIFIER  */
+  YYSYMBOL_NUMBER = 12,                    /* NUMBER  */
+  YYSYMBOL_RELOP = 13,                     /* RELOP  */
+  YYSYMBOL_ADDOP = 14,                     /* ADDOP  */
+  YYSYMBOL_MULOP = 15,                     /* MULOP  */
+  YYSYMBOL_16_ = 16,                       /* '('  */
+  YYSYMBOL_17_ = 17,                       /* ')'  */
+  YYSYMBOL_18_ = 18,                       /* ','  */
+  YYSYMBOL_19_ = 19,                       /* '{'  */
+  YYSYMBOL_20_ = 20,                       /* '}'  */
+  YYSYMBOL_21_ = 21,                       /* ';'  */
+  YYSYMBOL_22_ = 22,                       /* '='  */
+  YYSYMBOL_YYACCEPT = 23,                  /* $accept  */
+  YYSYMBOL_PROGRAM = 24,                   /* PROGRAM  */
+  YYSYMBOL_METHLIST = 25,                  /* METHLIST  */
+  YYSYMBOL_METH = 26,                      /* METH  */
+  YYSYMBOL_PARAMS = 27,                    /* PARAMS  */
+  YYSYMBOL_FORMALS = 28,                   /* FORMALS  */
+  YYSYMBOL_BODY = 29,                      /* BODY  */
+  YYSYMBOL_DECLS = 30,                     /* DECLS  */
+  YYSYMBOL_DECLLIST = 31,                  /* DECLLIST  */
+  YYSYMBOL_DECL = 32,                      /* DECL  */
+  YYSYMBOL_VARS = 33,                      /* VARS  */
+  YYSYMBOL_STMTS = 34,                     /* STMTS  */
+  YYSYMBOL_STMT = 35,                      /* STMT  */
+  YYSYMBOL_BLOCK = 36,                     /* BLOCK  */
+  YYSYMBOL_ASSIGN = 37,                    /* ASSIGN  */
+  YYSYMBOL_LOCATION = 38,                  /* LOCATION  */
+  YYSYMBOL_METHOD = 39,                    /* METHOD  */
+  YYSYMBOL_EXPR = 40,                      /* EXPR  */
+  YYSYMBOL_ADDEXPR = 41,                   /* ADDEXPR  */
+  YYSYMBOL_TERM = 42,                      /* TERM  */
+  YYSYMBOL_UNARY = 43,                     /* UNARY  */
+  YYSYMBOL_FACTOR = 44,                    /* FACTOR  */
+  YYSYMBOL_ACTUALS = 45,                   /* ACTUALS  */
+  YYSYMBOL_ARGS = 46                       /* ARGS  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL \
+             && defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+  YYLTYPE yyls_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE) \
+             + YYSIZEOF (YYLTYPE)) \
+      + 2 * YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  6
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   95
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  23
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  24
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  51
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  92
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   270
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+      16,    17,     2,     2,    18,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,    21,
+       2,    22,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,    19,     2,    20,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_uint8 yyrline[] =
+{
+       0,    62,    62,    63,    67,    68,    72,    78,    79,    91,
+      92,   104,   110,   111,   115,   116,   120,   125,   138,   139,
+     143,   155,   156,   160,   161,   162,   163,   164,   165,   166,
+     170,   174,   178,   182,   186,   187,   191,   192,   196,   197,
+     201,   208,   212,   213,   214,   215,   216,   217,   221,   222,
+     226,   227
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "IF", "ELSE", "WHILE",
+  "RETURN", "BREAK", "TYPE", "TRUE", "FALSE", "IDENTIFIER", "NUMBER",
+  "RELOP", "ADDOP", "MULOP", "'('", "')'", "','", "'{'", "'}'", "';'",
+  "'='", "$accept", "PROGRAM", "METHLIST", "METH", "PARAMS", "FORMALS",
+  "BODY", "DECLS", "DECLLIST", "DECL", "VARS", "STMTS", "STMT", "BLOCK",
+  "ASSIGN", "LOCATION", "METHOD", "EXPR", "ADDEXPR", "TERM", "UNARY",
+  "FACTOR", "ACTUALS", "ARGS", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-65)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-49)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int8 yypact[] =
+{
+      -2,     9,    36,   -65,    -2,    21,   -65,   -65,    30,    22,
+      32,    28,    40,    52,   -65,    37,   -65,    57,   -65,     4,
+      55,    59,    54,    56,    47,    50,   -65,   -65,   -65,   -65,
+     -65,   -65,    53,    46,    -4,    47,    47,   -65,   -65,    60,
+     -65,    47,    47,   -65,    61,    58,    -1,    63,   -65,   -65,
+     -65,    23,   -65,    47,    62,    47,    64,    65,    66,   -65,
+      67,    69,   -65,    47,    47,    47,   -65,   -65,    13,    70,
+     -65,    43,    43,   -65,    72,    47,    73,    63,   -65,    47,
+     -65,    71,    76,   -65,   -65,    75,    70,   -65,    43,   -65,
+     -65,   -65
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       2,     0,     0,     3,     5,     0,     1,     4,     7,     0,
+       0,     0,     0,    12,     6,     8,    21,     0,    10,     0,
+       0,    13,     0,     0,     0,     0,    32,    21,    11,    29,
+      22,    28,     0,     0,    18,     0,     0,    45,    46,    32,
+      44,     0,     0,    43,     0,     0,    35,    37,    39,    41,
+      27,     0,    23,     0,     0,     0,     0,     0,     0,    40,
+       0,    50,    24,     0,     0,     0,    30,    31,    18,    18,
+      16,     0,     0,    42,     0,     0,    34,    36,    38,     0,
+      19,     0,     0,    26,    47,    49,    18,    17,     0,    51,
+      20,    25
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int8 yypgoto[] =
+{
+     -65,   -65,    77,   -65,   -65,   -65,   -65,   -65,   -65,   -65,
+     -64,    48,   -55,   -65,   -65,   -19,   -65,   -34,    27,    31,
+     -38,   -65,   -65,   -65
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int8 yydefgoto[] =
+{
+       0,     2,     3,     4,     9,    10,    14,    16,    17,    21,
+      56,    19,    30,    31,    32,    43,    44,    45,    46,    47,
+      48,    49,    74,    75
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int8 yytable[] =
+{
+      33,    57,    58,    59,    80,    81,     1,    22,    60,    23,
+      24,    25,    63,    64,    54,    26,    82,    83,    55,    67,
+       5,    69,    90,    27,    28,    29,    22,    78,    23,    24,
+      25,    54,    33,    91,    26,    79,     6,     8,    -9,    11,
+      12,    85,    27,    66,    29,    86,    22,    13,    23,    24,
+      25,    15,    33,    33,    26,    18,    37,    38,    39,    40,
+     -14,    41,    27,    42,    29,    20,    34,   -15,    53,    33,
+      35,    50,    36,    68,    52,    51,   -33,    61,    65,    62,
+      88,     7,    71,    72,    73,    70,   -48,    64,    54,    84,
+      76,     0,    87,    89,     0,    77
+};
+
+static const yytype_int8 yycheck[] =
+{
+      19,    35,    36,    41,    68,    69,     8,     3,    42,     5,
+       6,     7,    13,    14,    18,    11,    71,    72,    22,    53,
+      11,    55,    86,    19,    20,    21,     3,    65,     5,     6,
+       7,    18,    51,    88,    11,    22,     0,    16,     8,    17,
+       8,    75,    19,    20,    21,    79,     3,    19,     5,     6,
+       7,    11,    71,    72,    11,    18,     9,    10,    11,    12,
+       8,    14,    19,    16,    21,     8,    11,     8,    22,    88,
+      16,    21,    16,    11,    21,    27,    16,    16,    15,    21,
+       4,     4,    17,    17,    17,    21,    17,    14,    18,    17,
+      63,    -1,    21,    18,    -1,    64
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
+{
+       0,     8,    24,    25,    26,    11,     0,    25,    16,    27,
+      28,    17,     8,    19,    29,    11,    30,    31,    18,    34,
+       8,    32,     3,     5,     6,     7,    11,    19,    20,    21,
+      35,    36,    37,    38,    11,    16,    16,     9,    10,    11,
+      12,    14,    16,    38,    39,    40,    41,    42,    43,    44,
+      21,    34,    21,    22,    18,    22,    33,    40,    40,    43,
+      40,    16,    21,    13,    14,    15,    20,    40,    11,    40,
+      21,    17,    17,    17,    45,    46,    41,    42,    43,    22,
+      33,    33,    35,    35,    17,    40,    40,    21,     4,    18,
+      33,    35
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    23,    24,    24,    25,    25,    26,    27,    27,    28,
+      28,    29,    30,    30,    31,    31,    32,    32,    33,    33,
+      33,    34,    34,    35,    35,    35,    35,    35,    35,    35,
+      36,    37,    38,    39,    40,    40,    41,    41,    42,    42,
+      43,    43,    44,    44,    44,    44,    44,    44,    45,    45,
+      46,    46
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     0,     1,     2,     1,     6,     0,     3,     0,
+       4,     4,     0,     2,     0,     2,     4,     6,     0,     3,
+       5,     0,     2,     2,     3,     7,     5,     2,     1,     1,
+       3,     3,     1,     1,     3,     1,     3,     1,     3,     1,
+       2,     1,     3,     1,     1,     1,     1,     4,     0,     2,
+       0,     3
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (ast, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
+   If N is 0, then set CURRENT to the empty location which ends
+   the previous symbol: RHS[0] (always defined).  */
+
+#ifndef YYLLOC_DEFAULT
+# define YYLLOC_DEFAULT(Current, Rhs, N)                                \
+    do                                                                  \
+      if (N)                                                            \
+        {                                                               \
+          (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;        \
+          (Current).first_column = YYRHSLOC (Rhs, 1).first_column;      \
+          (Current).last_line    = YYRHSLOC (Rhs, N).last_line;         \
+          (Current).last_column  = YYRHSLOC (Rhs, N).last_column;       \
+        }                                                               \
+      else                                                              \
+        {                                                               \
+          (Current).first_line   = (Current).last_line   =              \
+            YYRHSLOC (Rhs, 0).last_line;                                \
+          (Current).first_column = (Current).last_column =              \
+            YYRHSLOC (Rhs, 0).last_column;                              \
+        }                                                               \
+    while (0)
+#endif
+
+#define YYRHSLOC(Rhs, K) ((Rhs)[K])
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+/* YYLOCATION_PRINT -- Print the location on the stream.
+   This macro was not mandated originally: define only if we know
+   we won't break user code: when these are the locations we know.  */
+
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+
+/* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
+
+YY_ATTRIBUTE_UNUSED
+static int
+yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
+{
+  int res = 0;
+  int end_col = 0 != yylocp->last_column ? yylocp->last_column - 1 : 0;
+  if (0 <= yylocp->first_line)
+    {
+      res += YYFPRINTF (yyo, "%d", yylocp->first_line);
+      if (0 <= yylocp->first_column)
+        res += YYFPRINTF (yyo, ".%d", yylocp->first_column);
+    }
+  if (0 <= yylocp->last_line)
+    {
+      if (yylocp->first_line < yylocp->last_line)
+        {
+          res += YYFPRINTF (yyo, "-%d", yylocp->last_line);
+          if (0 <= end_col)
+            res += YYFPRINTF (yyo, ".%d", end_col);
+        }
+      else if (0 <= end_col && yylocp->first_column < end_col)
+        res += YYFPRINTF (yyo, "-%d", end_col);
+    }
+  return res;
+}
+
+#   define YYLOCATION_PRINT  yy_location_print_
+
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
+
+#  else
+
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
+
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, Location, ast); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, ASTNode **ast)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (yylocationp);
+  YY_USE (ast);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, ASTNode **ast)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  YYLOCATION_PRINT (yyo, yylocationp);
+  YYFPRINTF (yyo, ": ");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp, ast);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
+                 int yyrule, ASTNode **ast)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]), ast);
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, yylsp, Rule, ast); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp, ASTNode **ast)
+{
+  YY_USE (yyvaluep);
+  YY_USE (yylocationp);
+  YY_USE (ast);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Location data for the lookahead symbol.  */
+YYLTYPE yylloc
+# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+  = { 1, 1, 1, 1 }
+# endif
+;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (ASTNode **ast)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+    /* The location stack: array, bottom, top.  */
+    YYLTYPE yylsa[YYINITDEPTH];
+    YYLTYPE *yyls = yylsa;
+    YYLTYPE *yylsp = yyls;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+  YYLTYPE yyloc;
+
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  yylsp[0] = yylloc;
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+        YYLTYPE *yyls1 = yyls;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yyls1, yysize * YYSIZEOF (*yylsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+        yyls = yyls1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+        YYSTACK_RELOCATE (yyls_alloc, yyls);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+      yylsp = yyls + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+  *++yylsp = yylloc;
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+  /* Default location. */
+  YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
+  yyerror_range[1] = yyloc;
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* PROGRAM: %empty  */
+#line 62 "src/parser.y"
+                  { *ast = ast_new_program(NULL, (yyloc)); }
+#line 1292 "src/parser.tab.c"
+    break;
+
+  case 3: /* PROGRAM: METHLIST  */
+#line 63 "src/parser.y"
+                  { *ast = ast_new_program((yyvsp[0].list), (yyloc)); }
+#line 1298 "src/parser.tab.c"
+    break;
+
+  case 4: /* METHLIST: METH METHLIST  */
+#line 67 "src/parser.y"
+                    { (yyval.list) = ast_list_prepend((yyvsp[0].list), (yyvsp[-1].node)); }
+#line 1304 "src/parser.tab.c"
+    break;
+
+  case 5: /* METHLIST: METH  */
+#line 68 "src/parser.y"
+                    { (yyval.list) = ast_list_prepend(NULL, (yyvsp[0].node)); }
+#line 1310 "src/parser.tab.c"
+    break;
+
+  case 6: /* METH: TYPE IDENTIFIER '(' PARAMS ')' BODY  */
+#line 72 "src/parser.y"
+                                          {
+        (yyval.node) = ast_new_method((yyvsp[-5].type), (yyvsp[-4].id), ast_list_reverse((yyvsp[-2].list)), (yyvsp[0].node), (yyloc));
+      }
+#line 1318 "src/parser.tab.c"
+    break;
+
+  case 7: /* PARAMS: %empty  */
+#line 78 "src/parser.y"
+                              { (yyval.list) = NULL; }
+#line 1324 "src/parser.tab.c"
+    break;
+
+  case 8: /* PARAMS: FORMALS TYPE IDENTIFIER  */
+#line 79 "src/parser.y"
+                              {
+        YYLTYPE loc;
+        loc.first_line   = (yylsp[-1]).first_line;
+        loc.first_column = (yylsp[-1]).first_column;
+        loc.last_line    = (yylsp[0]).last_line;
+        loc.last_column  = (yylsp[0]).last_column;
+        ASTNode *p = ast_new_param((yyvsp[-1].type), (yyvsp[0].id), loc);
+        (yyval.list) = ast_list_prepend((yyvsp[-2].list), p);
+      }
+#line 1338 "src/parser.tab.c"
+    break;
+
+  case 9: /* FORMALS: %empty  */
+#line 91 "src/parser.y"
+                                  { (yyval.list) = NULL; }
+#line 1344 "src/parser.tab.c"
+    break;
+
+  case 10: /* FORMALS: FORMALS TYPE IDENTIFIER ','  */
+#line 92 "src/parser.y"
+                                  {
+        YYLTYPE loc;
+        loc.first_line   = (yylsp[-2]).first_line;
+        loc.first_column = (yylsp[-2]).first_column;
+        loc.last_line    = (yylsp[-1]).last_line;
+        loc.last_column  = (yylsp[-1]).last_column;
+        ASTNode *p = ast_new_param((yyvsp[-2].type), (yyvsp[-1].id), loc);
+        (yyval.list) = ast_list_prepend((yyvsp[-3].list), p);
+      }
+#line 1358 "src/parser.tab.c"
+    break;
+
+  case 11: /* BODY: '{' DECLS STMTS '}'  */
+#line 104 "src/parser.y"
+                          {
+        (yyval.node) = ast_new_body(ast_list_reverse((yyvsp[-2].list)), ast_list_reverse((yyvsp[-1].list)), (yyloc));
+      }
+#line 1366 "src/parser.tab.c"
+    break;
+
+  case 12: /* DECLS: %empty  */
+#line 110 "src/parser.y"
+                           { (yyval.list) = NULL; }
+#line 1372 "src/parser.tab.c"
+    break;
+
+  case 13: /* DECLS: DECLLIST DECL  */
+#line 111 "src/parser.y"
+                           { (yyval.list) = ast_list_prepend((yyvsp[-1].list), (yyvsp[0].node)); }
+#line 1378 "src/parser.tab.c"
+    break;
+
+  case 14: /* DECLLIST: %empty  */
+#line 115 "src/parser.y"
+                           { (yyval.list) = NULL; }
+#line 1384 "src/parser.tab.c"
+    break;
+
+  case 15: /* DECLLIST: DECLLIST DECL  */
+#line 116 "src/parser.y"
+                           { (yyval.list) = ast_list_prepend((yyvsp[-1].list), (yyvsp[0].node)); }
+#line 1390 "src/parser.tab.c"
+    break;
+
+  case 16: /* DECL: TYPE IDENTIFIER VARS ';'  */
+#line 120 "src/parser.y"
+                                        {
+        ASTNode *v = ast_new_var((yyvsp[-2].id), NULL, (yylsp[-2]));
+        ASTList *vars = ast_list_prepend((yyvsp[-1].list), v);
+        (yyval.node) = ast_new_decl((yyvsp[-3].type), vars, (yyloc));
+      }
+#line 1400 "src/parser.tab.c"
+    break;
+
+  case 17: /* DECL: TYPE IDENTIFIER '=' EXPR VARS ';'  */
+#line 125 "src/parser.y"
+                                        {
+        YYLTYPE loc;
+        loc.first_line   = (yylsp[-4]).first_line;
+        loc.first_column = (yylsp[-4]).first_column;
+        loc.last_line    = (yylsp[-2]).last_line;
+        loc.last_column  = (yylsp[-2]).last_column;
+        ASTNode *v = ast_new_var((yyvsp[-4].id), (yyvsp[-2].node), loc);
+        ASTList *vars = ast_list_prepend((yyvsp[-1].list), v);
+        (yyval.node) = ast_new_decl((yyvsp[-5].type), vars, (yyloc));
+      }
+#line 1415 "src/parser.tab.c"
+    break;
+
+  case 18: /* VARS: %empty  */
+#line 138 "src/parser.y"
+                                   { (yyval.list) = NULL; }
+#line 1421 "src/parser.tab.c"
+    break;
+
+  case 19: /* VARS: ',' IDENTIFIER VARS  */
+#line 139 "src/parser.y"
+                                   {
+        ASTNode *v = ast_new_var((yyvsp[-1].id), NULL, (yylsp[-1]));
+        (yyval.list) = ast_list_prepend((yyvsp[0].list), v);
+      }
+#line 1430 "src/parser.tab.c"
+    break;
+
+  case 20: /* VARS: ',' IDENTIFIER '=' EXPR VARS  */
+#line 143 "src/parser.y"
+                                   {
+        YYLTYPE loc;
+        loc.first_line   = (yylsp[-3]).first_line;
+        loc.first_column = (yylsp[-3]).first_column;
+        loc.last_line    = (yylsp[-1]).last_line;
+        loc.last_column  = (yylsp[-1]).last_column;
+        ASTNode *v = ast_new_var((yyvsp[-3].id), (yyvsp[-1].node), loc);
+        (yyval.list) = ast_list_prepend((yyvsp[0].list), v);
+      }
+#line 1444 "src/parser.tab.c"
+    break;
+
+  case 21: /* STMTS: %empty  */
+#line 155 "src/parser.y"
+                         { (yyval.list) = NULL; }
+#line 1450 "src/parser.tab.c"
+    break;
+
+  case 22: /* STMTS: STMTS STMT  */
+#line 156 "src/parser.y"
+                         { (yyval.list) = ast_list_prepend((yyvsp[-1].list), (yyvsp[0].node)); }
+#line 1456 "src/parser.tab.c"
+    break;
+
+  case 23: /* STMT: ASSIGN ';'  */
+#line 160 "src/parser.y"
+                                       { (yyval.node) = (yyvsp[-1].node); (yyval.node)->loc = (yyloc); }
+#line 1462 "src/parser.tab.c"
+    break;
+
+  case 24: /* STMT: RETURN EXPR ';'  */
+#line 161 "src/parser.y"
+                                       { (yyval.node) = ast_new_return((yyvsp[-1].node), (yyloc)); }
+#line 1468 "src/parser.tab.c"
+    break;
+
+  case 25: /* STMT: IF '(' EXPR ')' STMT ELSE STMT  */
+#line 162 "src/parser.y"
+                                       { (yyval.node) = ast_new_if((yyvsp[-4].node), (yyvsp[-2].node), (yyvsp[0].node), (yyloc)); }
+#line 1474 "src/parser.tab.c"
+    break;
+
+  case 26: /* STMT: WHILE '(' EXPR ')' STMT  */
+#line 163 "src/parser.y"
+                                       { (yyval.node) = ast_new_while((yyvsp[-2].node), (yyvsp[0].node), (yyloc)); }
+#line 1480 "src/parser.tab.c"
+    break;
+
+  case 27: /* STMT: BREAK ';'  */
+#line 164 "src/parser.y"
+                                       { (yyval.node) = ast_new_break((yyloc)); }
+#line 1486 "src/parser.tab.c"
+    break;
+
+  case 28: /* STMT: BLOCK  */
+#line 165 "src/parser.y"
+                                       { (yyval.node) = (yyvsp[0].node); }
+#line 1492 "src/parser.tab.c"
+    break;
+
+  case 29: /* STMT: ';'  */
+#line 166 "src/parser.y"
+                                       { (yyval.node) = NULL; }
+#line 1498 "src/parser.tab.c"
+    break;
+
+  case 30: /* BLOCK: '{' STMTS '}'  */
+#line 170 "src/parser.y"
+                    { (yyval.node) = ast_new_block(ast_list_reverse((yyvsp[-1].list)), (yyloc)); }
+#line 1504 "src/parser.tab.c"
+    break;
+
+  case 31: /* ASSIGN: LOCATION '=' EXPR  */
+#line 174 "src/parser.y"
+                        { (yyval.node) = ast_new_assign((yyvsp[-2].id), (yyvsp[0].node), (yyloc)); }
+#line 1510 "src/parser.tab.c"
+    break;
+
+  case 32: /* LOCATION: IDENTIFIER  */
+#line 178 "src/parser.y"
+                 { (yyval.id) = (yyvsp[0].id); }
+#line 1516 "src/parser.tab.c"
+    break;
+
+  case 33: /* METHOD: IDENTIFIER  */
+#line 182 "src/parser.y"
+                 { (yyval.id) = (yyvsp[0].id); }
+#line 1522 "src/parser.tab.c"
+    break;
+
+  case 34: /* EXPR: ADDEXPR RELOP ADDEXPR  */
+#line 186 "src/parser.y"
+                            { (yyval.node) = ast_new_binop((yyvsp[-1].op), (yyvsp[-2].node), (yyvsp[0].node), (yyloc)); }
+#line 1528 "src/parser.tab.c"
+    break;
+
+  case 35: /* EXPR: ADDEXPR  */
+#line 187 "src/parser.y"
+                            { (yyval.node) = (yyvsp[0].node); }
+#line 1534 "src/parser.tab.c"
+    break;
+
+  case 36: /* ADDEXPR: ADDEXPR ADDOP TERM  */
+#line 191 "src/parser.y"
+                         { (yyval.node) = ast_new_binop((yyvsp[-1].op), (yyvsp[-2].node), (yyvsp[0].node), (yyloc)); }
+#line 1540 "src/parser.tab.c"
+    break;
+
+  case 37: /* ADDEXPR: TERM  */
+#line 192 "src/parser.y"
+                         { (yyval.node) = (yyvsp[0].node); }
+#line 1546 "src/parser.tab.c"
+    break;
+
+  case 38: /* TERM: TERM MULOP UNARY  */
+#line 196 "src/parser.y"
+                        { (yyval.node) = ast_new_binop((yyvsp[-1].op), (yyvsp[-2].node), (yyvsp[0].node), (yyloc)); }
+#line 1552 "src/parser.tab.c"
+    break;
+
+  case 39: /* TERM: UNARY  */
+#line 197 "src/parser.y"
+                        { (yyval.node) = (yyvsp[0].node); }
+#line 1558 "src/parser.tab.c"
+    break;
+
+  case 40: /* UNARY: ADDOP UNARY  */
+#line 201 "src/parser.y"
+                  {
+        if ((enum OpKind)(yyvsp[-1].op) == OP_ADDOP_SUB) {
+          (yyval.node) = ast_new_unary(OP_ADDOP_SUB, (yyvsp[0].node), (yyloc));
+        } else {
+          (yyval.node) = (yyvsp[0].node);
+        }
+      }
+#line 1570 "src/parser.tab.c"
+    break;
+
+  case 41: /* UNARY: FACTOR  */
+#line 208 "src/parser.y"
+             { (yyval.node) = (yyvsp[0].node); }
+#line 1576 "src/parser.tab.c"
+    break;
+
+  case 42: /* FACTOR: '(' EXPR ')'  */
+#line 212 "src/parser.y"
+                             { (yyval.node) = (yyvsp[-1].node); }
+#line 1582 "src/parser.tab.c"
+    break;
+
+  case 43: /* FACTOR: LOCATION  */
+#line 213 "src/parser.y"
+                             { (yyval.node) = ast_new_identifier((yyvsp[0].id), (yyloc)); }
+#line 1588 "src/parser.tab.c"
+    break;
+
+  case 44: /* FACTOR: NUMBER  */
+#line 214 "src/parser.y"
+                             { (yyval.node) = ast_new_number((yyvsp[0].num), (yyloc)); }
+#line 1594 "src/parser.tab.c"
+    break;
+
+  case 45: /* FACTOR: TRUE  */
+#line 215 "src/parser.y"
+                             { (yyval.node) = ast_new_number(1, (yyloc)); }
+#line 1600 "src/parser.tab.c"
+    break;
+
+  case 46: /* FACTOR: FALSE  */
+#line 216 "src/parser.y"
+                             { (yyval.node) = ast_new_number(0, (yyloc)); }
+#line 1606 "src/parser.tab.c"
+    break;
+
+  case 47: /* FACTOR: METHOD '(' ACTUALS ')'  */
+#line 217 "src/parser.y"
+                             { (yyval.node) = ast_new_call((yyvsp[-3].id), ast_list_reverse((yyvsp[-1].list)), (yyloc)); }
+#line 1612 "src/parser.tab.c"
+    break;
+
+  case 48: /* ACTUALS: %empty  */
+#line 221 "src/parser.y"
+                    { (yyval.list) = NULL; }
+#line 1618 "src/parser.tab.c"
+    break;
+
+  case 49: /* ACTUALS: ARGS EXPR  */
+#line 222 "src/parser.y"
+                    { (yyval.list) = ast_list_prepend((yyvsp[-1].list), (yyvsp[0].node)); }
+#line 1624 "src/parser.tab.c"
+    break;
+
+  case 50: /* ARGS: %empty  */
+#line 226 "src/parser.y"
+                    { (yyval.list) = NULL; }
+#line 1630 "src/parser.tab.c"
+    break;
+
+  case 51: /* ARGS: ARGS EXPR ','  */
+#line 227 "src/parser.y"
+                    { (yyval.list) = ast_list_prepend((yyvsp[-2].list), (yyvsp[-1].node)); }
+#line 1636 "src/parser.tab.c"
+    break;
+
+
+#line 1640 "src/parser.tab.c"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+  *++yylsp = yyloc;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (ast, YY_("syntax error"));
+    }
+
+  yyerror_range[1] = yylloc;
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, &yylloc, ast);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+      yyerror_range[1] = *yylsp;
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp, ast);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  yyerror_range[2] = yylloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (ast, YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, &yylloc, ast);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp, ast);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+
+  return yyresult;
+}
+
+#line 230 "src/parser.y"
+
+
+void yyerror(ASTNode **ast, const char *s) {
+  (void)ast; /* suppress unused parameter warning */
+
+  extern char *yytext;
+  extern YYLTYPE yylloc;
+
+  fprintf(stderr, "error: %s near '%s' at line %d, column %d\n",
+          s, yytext, yylloc.first_line, yylloc.first_column);
+  fprintf(stderr, "\n");
+}
+
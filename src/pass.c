@@ -0,0 +1,417 @@
+#include "pass.h"
+#include "options.h"
+#include "mix.h"
+#include "fold.h"
+#include "eval.h"
+#include "inline.h"
+#include "tail.h"
+#include "sccp.h"
+#include "licm.h"
+#include "cse.h"
+#include "dce.h"
+#include "regalloc.h"
+#include "gen.h"
+#include "peephole.h"
+#include "cfg.h"
+#include "literal.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// rounds of the cleanup passes run by -fiterate
+#define PASS_ROUNDS_MAX 4
+
+enum PassKind {
+  PASS_AST, // rewrites the syntax tree
+  PASS_GEN, // generates the instructions from the syntax tree
+  PASS_IR   // rewrites the instructions
+};
+
+struct Pass {
+  const char *name;
+  enum PassKind kind;
+  const int *enabled;       // option running the pass, NULL if it always runs
+  int cleanup;              // run again by -fiterate while the program changes
+  unsigned int requires;    // analyses computed before it runs
+  unsigned int preserves;   // analyses still valid after it changed the program
+  int (*run)(PassManager *pm);
+  void (*report)(FILE *f);  // printed after the pipeline if report_enabled
+  const int *report_enabled;
+};
+
+struct PassStats {
+  unsigned int runs;
+  unsigned int changed;  // runs that changed the program
+  long removed;          // AST nodes or instructions, negative if added
+  long cycles;           // execution time of the instructions removed
+  double ms;             // wall time
+};
+
+/* size and hash of the program, to tell whether a pass changed it */
+struct Fingerprint {
+  long size;
+  long cycles;
+  uint64_t hash;
+};
+
+static int run_fold(PassManager *pm) {
+  return fold_ast(pm->root);
+}
+
+static int run_eval(PassManager *pm) {
+  if (eval_ast(pm->root)) return -1;
+
+  // the values of the calls fold further
+  return options.fold_constants ? fold_ast(pm->root) : 0;
+}
+
+static int run_inline(PassManager *pm) {
+  return inline_ast(pm->root, pm->call_graph);
+}
+
+static int run_tail(PassManager *pm) {
+  return tail_ast(pm->root);
+}
+
+static int run_sccp(PassManager *pm) {
+  return sccp_ast(pm->root);
+}
+
+static int run_licm(PassManager *pm) {
+  return licm_ast(pm->root);
+}
+
+static int run_cse(PassManager *pm) {
+  return cse_ast(pm->root);
+}
+
+static int run_dce(PassManager *pm) {
+  return dce_ast(pm->root, pm->call_graph);
+}
+
+static int run_regalloc(PassManager *pm) {
+  return regalloc_ast(pm->root, pm->symbols);
+}
+
+static int run_gen(PassManager *pm) {
+  return gen_mixal_from_ast(pm->root, pm->symbols);
+}
+
+static int run_immediate(PassManager *pm) {
+  return literal_immediate(pm->code);
+}
+
+static int run_peephole(PassManager *pm) {
+  return peephole_optimize(pm->code);
+}
+
+static int run_cfg(PassManager *pm) {
+  return cfg_optimize(pm->code);
+}
+
+static int run_literal_pool(PassManager *pm) {
+  return literal_pool(pm->code);
+}
+
+static const struct Pass passes[] = {
+  {"fold-constants", PASS_AST, &options.fold_constants, 0, 0,
+   ANALYSIS_SYMBOLS, run_fold, NULL, NULL},
+  {"eval-calls", PASS_AST, &options.eval_calls, 0, 0,
+   ANALYSIS_SYMBOLS, run_eval, NULL, NULL},
+  {"inline", PASS_AST, &options.inline_methods, 0, ANALYSIS_CALL_GRAPH,
+   0, run_inline, NULL, NULL},
+  {"tail-calls", PASS_AST, &options.tail_calls, 0, 0,
+   0, run_tail, tail_print_report, &options.tail_calls_report},
+  {"sccp", PASS_AST, &options.sccp, 1, 0,
+   ANALYSIS_SYMBOLS, run_sccp, NULL, NULL},
+  {"licm", PASS_AST, &options.licm, 1, 0,
+   ANALYSIS_CALL_GRAPH, run_licm, NULL, NULL},
+  {"cse", PASS_AST, &options.cse, 1, 0,
+   ANALYSIS_CALL_GRAPH, run_cse, NULL, NULL},
+  {"dce", PASS_AST, &options.dce, 1, ANALYSIS_CALL_GRAPH,
+   0, run_dce, dce_print_report, &options.dce_report},
+  {"register-alloc", PASS_AST, &options.register_alloc, 0, ANALYSIS_SYMBOLS,
+   ANALYSIS_SYMBOLS | ANALYSIS_CALL_GRAPH, run_regalloc,
+   regalloc_print_report, &options.register_alloc_report},
+  {"gen", PASS_GEN, NULL, 0, ANALYSIS_SYMBOLS,
+   ANALYSIS_SYMBOLS | ANALYSIS_CALL_GRAPH, run_gen, NULL, NULL},
+  {"immediate", PASS_IR, &options.immediate, 0, 0,
+   ANALYSIS_SYMBOLS | ANALYSIS_CALL_GRAPH, run_immediate, NULL, NULL},
+  {"peephole", PASS_IR, &options.peephole, 0, 0,
+   ANALYSIS_SYMBOLS | ANALYSIS_CALL_GRAPH, run_peephole,
+   peephole_print_stats, &options.peephole_stats},
+  {"cfg", PASS_IR, &options.cfg, 0, 0,
+   ANALYSIS_SYMBOLS | ANALYSIS_CALL_GRAPH, run_cfg, cfg_print_stats, &options.cfg_stats},
+  {"literal-pool", PASS_IR, &options.literal_pool, 0, 0,
+   ANALYSIS_SYMBOLS | ANALYSIS_CALL_GRAPH, run_literal_pool, NULL, NULL},
+};
+
+#define N_PASSES (sizeof(passes) / sizeof(passes[0]))
+
+static struct PassStats stats[N_PASSES];
+
+/* FNV-1a */
+static void hash_bytes(uint64_t *h, const void *data, size_t len) {
+  const unsigned char *p = data;
+
+  for (size_t k = 0 ; k < len ; k++) {
+    *h ^= p[k];
+    *h *= 0x100000001b3ULL;
+  }
+}
+
+static void hash_str(uint64_t *h, const char *s) {
+  hash_bytes(h, s, strlen(s) + 1);
+}
+
+static void fingerprint_node(struct Fingerprint *fp, const ASTNode *n);
+
+static void fingerprint_list(struct Fingerprint *fp, const ASTList *l) {
+  for ( ; l != NULL ; l = l->list) fingerprint_node(fp, l->node);
+
+  // the end of the list, so that moving a statement out of a block shows
+  hash_bytes(&fp->hash, "", 1);
+}
+
+static void fingerprint_node(struct Fingerprint *fp, const ASTNode *n) {
+  int kind = (n == NULL) ? -1 : (int)n->kind;
+
+  hash_bytes(&fp->hash, &kind, sizeof(kind));
+  if (n == NULL) return;
+
+  fp->size += 1;
+
+  switch (n->kind) {
+    case N_PROGRAM: fingerprint_list(fp, n->prog.methods); break;
+
+    case N_METHOD:
+      hash_str(&fp->hash, n->method.name);
+      fingerprint_list(fp, n->method.params);
+      fingerprint_node(fp, n->method.body);
+      break;
+
+    case N_PARAM: hash_str(&fp->hash, n->param.name); break;
+
+    case N_BODY:
+      fingerprint_list(fp, n->body.decls);
+      fingerprint_list(fp, n->body.stmts);
+      break;
+
+    case N_DECL: fingerprint_list(fp, n->decl.vars); break;
+
+    case N_VAR:
+      hash_str(&fp->hash, n->var.name);
+      fingerprint_node(fp, n->var.expr);
+      break;
+
+    case N_BLOCK: fingerprint_list(fp, n->block.stmts); break;
+
+    case N_ASSIGN:
+      hash_str(&fp->hash, n->assign.location);
+      fingerprint_node(fp, n->assign.rhs);
+      break;
+
+    case N_IF:
+    case N_WHILE:
+      fingerprint_node(fp, n->branch.cond);
+      fingerprint_node(fp, n->branch.then_branch);
+      fingerprint_node(fp, n->branch.else_branch);
+      break;
+
+    case N_RETURN: fingerprint_node(fp, n->ret.expr); break;
+
+    case N_BINOP:
+      hash_bytes(&fp->hash, &n->binop.op, sizeof(n->binop.op));
+      fingerprint_node(fp, n->binop.lhs);
+      fingerprint_node(fp, n->binop.rhs);
+      break;
+
+    case N_UNARY:
+      hash_bytes(&fp->hash, &n->unary.op, sizeof(n->unary.op));
+      fingerprint_node(fp, n->unary.expr);
+      break;
+
+    case N_CALL:
+      hash_str(&fp->hash, n->call.fname);
+      fingerprint_list(fp, n->call.args);
+      break;
+
+    case N_IDENTIFIER: hash_str(&fp->hash, n->identifier.name); break;
+    case N_NUMBER: hash_bytes(&fp->hash, &n->number.val, sizeof(n->number.val)); break;
+
+    default:
+      break;
+  }
+}
+
+/* the machine instructions (pseudo-operations aside) and their time */
+static void fingerprint_code(struct Fingerprint *fp, const InstList *l) {
+  for (const MixInst *i = l->head ; i != NULL ; i = i->next) {
+    if (i->kind != INST_OP) continue;
+
+    hash_str(&fp->hash, i->label);
+    hash_str(&fp->hash, i->opcode);
+    hash_str(&fp->hash, i->address);
+    hash_bytes(&fp->hash, &i->index, sizeof(i->index));
+    hash_str(&fp->hash, i->field);
+
+    const MixOpcode *op = mix_opcode_find(i->opcode);
+    if (op == NULL || op->code == MIX_PSEUDO) continue;
+
+    fp->size += 1;
+    fp->cycles += mix_opcode_time(op, op->field);
+  }
+}
+
+static struct Fingerprint fingerprint(const PassManager *pm, enum PassKind kind) {
+  struct Fingerprint fp = { 0, 0, 0xcbf29ce484222325ULL };
+
+  if (kind == PASS_AST) fingerprint_node(&fp, pm->root);
+  if (kind == PASS_IR) fingerprint_code(&fp, pm->code);
+
+  return fp;
+}
+
+static double now_ms(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int require(PassManager *pm, unsigned int analyses) {
+  unsigned int missing = analyses & ~pm->valid;
+
+  if (missing & ANALYSIS_SYMBOLS) {
+    // methods may have been added, removed or given new parameters and locals
+    if (pm->symbols != NULL) ht_free(pm->symbols);
+    pm->symbols = NULL;
+    if (ht_from_ast(pm->root, &pm->symbols)) return -1;
+  }
+
+  if (missing & ANALYSIS_CALL_GRAPH) {
+    callgraph_free(pm->call_graph);
+    pm->call_graph = callgraph_new(pm->root);
+    if (pm->call_graph == NULL) return -1;
+  }
+
+  pm->valid |= missing;
+  return 0;
+}
+
+/* run pass k if enabled: 1 if it changed the program, 0 if not, -1 on error */
+static int run_pass(PassManager *pm, size_t k) {
+  const struct Pass *p = &passes[k];
+  struct PassStats *s = &stats[k];
+
+  if (p->enabled != NULL && !*p->enabled) return 0;
+  if (require(pm, p->requires)) return -1;
+
+  struct Fingerprint before = fingerprint(pm, p->kind);
+  double start = now_ms();
+
+  if (p->run(pm)) return -1;
+
+  s->ms += now_ms() - start;
+  s->runs += 1;
+
+  // the instructions are new, nothing to compare them with
+  if (p->kind == PASS_GEN) return 0;
+
+  struct Fingerprint after = fingerprint(pm, p->kind);
+
+  if (before.hash == after.hash && before.size == after.size) return 0;
+
+  s->changed += 1;
+  s->removed += before.size - after.size;
+  s->cycles += before.cycles - after.cycles;
+  pm->valid &= p->preserves;
+  return 1;
+}
+
+void pass_manager_init(PassManager *pm, ASTNode *root, HashTable *symbols, InstList *code) {
+  pm->root = root;
+  pm->code = code;
+  pm->symbols = symbols;
+  pm->call_graph = NULL;
+  pm->valid = ANALYSIS_SYMBOLS;
+}
+
+int pass_run_pipeline(PassManager *pm) {
+  size_t k = 0;
+
+  while (k < N_PASSES) {
+    if (!passes[k].cleanup) {
+      if (run_pass(pm, k) < 0) return -1;
+      k += 1;
+      continue;
+    }
+
+    size_t end = k;
+    while (end < N_PASSES && passes[end].cleanup) end++;
+
+    int rounds = options.iterate ? PASS_ROUNDS_MAX : 1;
+    for (int round = 0 ; round < rounds ; round++) {
+      int changed = 0;
+
+      for (size_t j = k ; j < end ; j++) {
+        int status = run_pass(pm, j);
+        if (status < 0) return -1;
+        changed |= status;
+      }
+
+      if (!changed) break;
+    }
+
+    k = end;
+  }
+
+  for (k = 0 ; k < N_PASSES ; k++) {
+    if (passes[k].report != NULL && stats[k].runs > 0 && *passes[k].report_enabled) {
+      passes[k].report(stderr);
+    }
+  }
+
+  return 0;
+}
+
+void pass_print_stats(FILE *f) {
+  static const char *kind_str[] = { "ast", "gen", "ir" };
+  double ms = 0;
+
+  fprintf(f, "%-20s %4s %4s %7s %8s %8s %9s\n",
+          "pass", "kind", "runs", "changed", "removed", "cycles", "time (ms)");
+
+  for (size_t k = 0 ; k < N_PASSES ; k++) {
+    const struct PassStats *s = &stats[k];
+    if (s->runs == 0) continue;
+
+    if (passes[k].kind == PASS_GEN) {
+      fprintf(f, "%-20s %4s %4u %7s %8s %8s %9.3f\n", passes[k].name,
+              kind_str[passes[k].kind], s->runs, "-", "-", "-", s->ms);
+    } else if (passes[k].kind == PASS_AST) {
+      fprintf(f, "%-20s %4s %4u %7u %8ld %8s %9.3f\n", passes[k].name,
+              kind_str[passes[k].kind], s->runs, s->changed, s->removed, "-", s->ms);
+    } else {
+      fprintf(f, "%-20s %4s %4u %7u %8ld %8ld %9.3f\n", passes[k].name,
+              kind_str[passes[k].kind], s->runs, s->changed, s->removed, s->cycles, s->ms);
+    }
+    ms += s->ms;
+  }
+
+  fprintf(f, "%-20s %4s %4s %7s %8s %8s %9.3f\n", "total", "", "", "", "", "", ms);
+}
+
+void pass_manager_free(PassManager *pm) {
+  regalloc_free();
+  dce_free();
+  tail_free();
+
+  callgraph_free(pm->call_graph);
+  if (pm->symbols != NULL) ht_free(pm->symbols);
+  pm->call_graph = NULL;
+  pm->symbols = NULL;
+  pm->valid = 0;
+}
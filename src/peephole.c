@@ -0,0 +1,362 @@
+#include "peephole.h"
+#include "emit.h"
+#include "mix.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct PeepholeRule PeepholeRule;
+
+struct PeepholeRule {
+  const char *name;
+
+  // try to rewrite the window starting at i, returns 1 if it did
+  int (*apply)(InstList *l, MixInst *i, PeepholeRule *r);
+
+  unsigned long applied;
+  unsigned long insts;  // instructions removed
+  unsigned long cycles; // execution time of the removed instructions
+};
+
+static MixInst *next_op(MixInst *i) {
+  if (i == NULL) return NULL;
+
+  // comments do not separate instructions
+  do {
+    i = i->next;
+  } while (i != NULL && i->kind == INST_COMMENT);
+
+  return i;
+}
+
+static int has_label(const MixInst *i) {
+  return i->label[0] != '\0';
+}
+
+/* instruction with the given opcode, address and index but no field */
+static int is_op(const MixInst *i, const char *opcode, const char *address, int index) {
+  return inst_is(i, opcode) && strcmp(i->address, address) == 0
+      && i->index == index && i->field[0] == '\0';
+}
+
+static int address_num(const MixInst *i, int *value) {
+  char *end = NULL;
+
+  if (i->address[0] == '\0') return -1;
+
+  long v = strtol(i->address, &end, 10);
+  if (*end != '\0') return -1;
+
+  *value = (int)v;
+  return 0;
+}
+
+/* register stored by STA, STX, ST1 ... ST6, 0 otherwise */
+static char store_reg(const MixInst *i) {
+  if (i == NULL || i->kind != INST_OP) return 0;
+  if (strncmp(i->opcode, "ST", 2) != 0 || strlen(i->opcode) != 3) return 0;
+  if (strchr("AX123456", i->opcode[2]) == NULL) return 0;
+
+  return i->opcode[2];
+}
+
+static int is_load(const MixInst *i, char reg) {
+  return i != NULL && i->kind == INST_OP && i->opcode[0] == 'L' && i->opcode[1] == 'D'
+      && i->opcode[2] == reg && i->opcode[3] == '\0';
+}
+
+static void remove_inst(InstList *l, MixInst *i, PeepholeRule *r) {
+  const MixOpcode *op = mix_opcode_find(i->opcode);
+
+  r->insts += 1;
+  r->cycles += mix_opcode_time(op, op ? op->field : 0);
+
+  inst_remove(l, i);
+}
+
+static int set_comment(MixInst *i, const char *comment) {
+  char *c = strdup(comment);
+  if (c == NULL) return -1;
+
+  free(i->comment);
+  i->comment = c;
+
+  return 0;
+}
+
+/* INC6 1 / STr STACK,6 / LDr STACK,6 / DEC6 1: push immediately popped */
+static int rule_push_pop(InstList *l, MixInst *i, PeepholeRule *r) {
+  if (!is_op(i, "INC6", "1", 0) || has_label(i)) return 0;
+
+  MixInst *st = next_op(i);
+  char reg = store_reg(st);
+  if (!reg || !is_op(st, st->opcode, "STACK", 6) || has_label(st)) return 0;
+
+  MixInst *ld = next_op(st);
+  if (!is_load(ld, reg) || !is_op(ld, ld->opcode, "STACK", 6) || has_label(ld)) return 0;
+
+  MixInst *dec = next_op(ld);
+  if (!is_op(dec, "DEC6", "1", 0) || has_label(dec)) return 0;
+
+  remove_inst(l, i, r);
+  remove_inst(l, st, r);
+  remove_inst(l, ld, r);
+  remove_inst(l, dec, r);
+
+  return 1;
+}
+
+/* STr M / LDr M: the register already holds the value */
+static int rule_store_load(InstList *l, MixInst *i, PeepholeRule *r) {
+  char reg = store_reg(i);
+  if (!reg || i->field[0]) return 0;
+
+  MixInst *ld = next_op(i);
+  if (!is_load(ld, reg) || has_label(ld)) return 0;
+  if (!is_op(ld, ld->opcode, i->address, i->index)) return 0;
+
+  remove_inst(l, ld, r);
+
+  return 1;
+}
+
+/* STr STACK,6 / DEC6 k: the stored word is popped before it is read */
+static int rule_dead_stack_store(InstList *l, MixInst *i, PeepholeRule *r) {
+  int k;
+
+  if (!store_reg(i) || !is_op(i, i->opcode, "STACK", 6) || has_label(i)) return 0;
+
+  MixInst *dec = next_op(i);
+  if (!inst_is(dec, "DEC6") || dec->index != 0 || dec->field[0] || has_label(dec)) return 0;
+  if (address_num(dec, &k) || k < 1) return 0;
+
+  remove_inst(l, i, r);
+
+  return 1;
+}
+
+/* adjustment of index register k: +value for INCk, -value for DECk */
+static int index_adjust(const MixInst *i, char *reg, int *value) {
+  if (i == NULL || i->kind != INST_OP || strlen(i->opcode) != 4) return -1;
+  if (i->opcode[3] < '1' || i->opcode[3] > '6') return -1;
+  if (i->index != 0 || i->field[0]) return -1;
+
+  int sign;
+  if (strncmp(i->opcode, "INC", 3) == 0) sign = 1;
+  else if (strncmp(i->opcode, "DEC", 3) == 0) sign = -1;
+  else return -1;
+
+  if (address_num(i, value)) return -1;
+
+  *value *= sign;
+  *reg = i->opcode[3];
+
+  return 0;
+}
+
+/* INCk a / DECk b: one adjustment by a - b, or none */
+static int rule_index_merge(InstList *l, MixInst *i, PeepholeRule *r) {
+  char reg1, reg2;
+  int a, b;
+
+  if (index_adjust(i, &reg1, &a)) return 0;
+
+  MixInst *j = next_op(i);
+  if (index_adjust(j, &reg2, &b) || reg1 != reg2 || has_label(j)) return 0;
+
+  int net = a + b;
+
+  if (net == 0) {
+    if (has_label(i)) return 0;
+
+    remove_inst(l, i, r);
+    remove_inst(l, j, r);
+    return 1;
+  }
+
+  char reg_str[4];
+  char comment[64];
+
+  if (reg1 == '6') strcpy(reg_str, "SP");
+  else if (reg1 == '5') strcpy(reg_str, "FP");
+  else snprintf(reg_str, sizeof(reg_str), "rI%c", reg1);
+
+  snprintf(i->opcode, sizeof(i->opcode), "%s%c", net > 0 ? "INC" : "DEC", reg1);
+  snprintf(i->address, sizeof(i->address), "%d", abs(net));
+  snprintf(comment, sizeof(comment), "%s " SYMB_ASSIGN " %s %c %d",
+           reg_str, reg_str, net > 0 ? '+' : '-', abs(net));
+  if (set_comment(i, comment)) return -1;
+
+  remove_inst(l, j, r);
+
+  return 1;
+}
+
+/* JMP L where only NOPs separate the jump from L */
+static int rule_jmp_next(InstList *l, MixInst *i, PeepholeRule *r) {
+  char target[INST_LABEL_LEN + 1];
+
+  if (!inst_is(i, "JMP") || i->index != 0 || i->field[0] || has_label(i)) return 0;
+
+  size_t len = strlen(i->address);
+  if (len == 0 || len > INST_LABEL_LEN) return 0;
+
+  strcpy(target, i->address);
+
+  // a forward local reference dF lands on the next dH
+  if (len == 2 && target[0] >= '0' && target[0] <= '9') {
+    if (target[1] != 'F') return 0;
+    target[1] = 'H';
+  }
+
+  for (MixInst *j = i->next ; j != NULL ; j = j->next) {
+    if (j->kind == INST_COMMENT) continue;
+    if (j->kind != INST_OP) return 0;
+
+    if (strcmp(j->label, target) == 0) {
+      remove_inst(l, i, r);
+      return 1;
+    }
+
+    if (!inst_is(j, "NOP")) return 0;
+  }
+
+  return 0;
+}
+
+/* conditional jump on the opposite condition */
+static const char *jump_negate(const char *opcode) {
+  static const char *pairs[][2] = {
+    {"JL", "JGE"}, {"JE", "JNE"}, {"JG", "JLE"},
+    {"JGE", "JL"}, {"JNE", "JE"}, {"JLE", "JG"},
+  };
+
+  for (size_t k = 0 ; k < sizeof(pairs) / sizeof(pairs[0]) ; k++) {
+    if (strcmp(opcode, pairs[k][0]) == 0) return pairs[k][1];
+  }
+
+  return NULL;
+}
+
+/* a comparison materialized as 0/1 and then tested with JAZ, jump on it directly:
+     ENTA 1 / Jcc 1F / ENTA 0 / 1H JAZ L                         -> Jcc' L
+     ENTX 1 / Jcc 1F / ENTX 0 / 1H STX STACK,6 / LDA STACK,6 /
+     DEC6 1 / JAZ L                                              -> DEC6 1 / Jcc' L
+     ENTX 1 / Jcc 1F / ENTX 0 / 1H STX T,5 / LDA T,5 / JAZ L     -> Jcc' L */
+static int rule_cmp_branch(InstList *l, MixInst *i, PeepholeRule *r) {
+  char reg;
+
+  if (is_op(i, "ENTA", "1", 0)) reg = 'A';
+  else if (is_op(i, "ENTX", "1", 0)) reg = 'X';
+  else return 0;
+
+  if (has_label(i)) return 0;
+
+  MixInst *jcc = next_op(i);
+  if (jcc == NULL || jcc->kind != INST_OP || has_label(jcc)) return 0;
+
+  const char *negated = jump_negate(jcc->opcode);
+  if (negated == NULL || !is_op(jcc, jcc->opcode, "1F", 0)) return 0;
+
+  MixInst *ent0 = next_op(jcc);
+  if (!is_op(ent0, reg == 'A' ? "ENTA" : "ENTX", "0", 0) || has_label(ent0)) return 0;
+
+  MixInst *target = next_op(ent0);
+  if (target == NULL || strcmp(target->label, "1H") != 0) return 0;
+
+  MixInst *jaz;
+
+  if (reg == 'A') {
+    jaz = target;
+    if (!inst_is(jaz, "JAZ") || jaz->index != 0) return 0;
+  } else {
+    if (!inst_is(target, "STX") || target->field[0]) return 0;
+
+    MixInst *ld = next_op(target);
+    if (!is_op(ld, "LDA", target->address, target->index) || has_label(ld)) return 0;
+
+    if (is_op(target, "STX", "STACK", 6)) {
+      MixInst *dec = next_op(ld);
+      if (!is_op(dec, "DEC6", "1", 0) || has_label(dec)) return 0;
+
+      jaz = next_op(dec);
+    } else if (target->index == 5) {
+      // a temporary in a static frame is released without an instruction
+      jaz = next_op(ld);
+    } else {
+      return 0;
+    }
+
+    if (!inst_is(jaz, "JAZ") || jaz->index != 0 || has_label(jaz)) return 0;
+
+    remove_inst(l, target, r);
+    remove_inst(l, ld, r);
+  }
+
+  strcpy(jaz->opcode, negated);
+  jaz->label[0] = '\0';
+
+  remove_inst(l, i, r);
+  remove_inst(l, jcc, r);
+  remove_inst(l, ent0, r);
+
+  return 1;
+}
+
+static PeepholeRule rules[] = {
+  {"cmp-branch", rule_cmp_branch, 0, 0, 0},
+  {"push-pop", rule_push_pop, 0, 0, 0},
+  {"store-load", rule_store_load, 0, 0, 0},
+  {"dead-stack-store", rule_dead_stack_store, 0, 0, 0},
+  {"index-merge", rule_index_merge, 0, 0, 0},
+  {"jmp-next", rule_jmp_next, 0, 0, 0},
+};
+
+#define N_RULES (sizeof(rules) / sizeof(rules[0]))
+
+int peephole_optimize(InstList *l) {
+  int changed;
+
+  // every rule removes instructions, so this terminates
+  do {
+    changed = 0;
+
+    MixInst *i = l->head;
+    while (i != NULL) {
+      MixInst *prev = i->prev;
+      int applied = 0;
+
+      for (size_t k = 0 ; k < N_RULES && !applied ; k++) {
+        applied = rules[k].apply(l, i, &rules[k]);
+        if (applied < 0) return -1;
+        if (applied) rules[k].applied += 1;
+      }
+
+      if (applied) {
+        // the rewrite may complete a window that starts earlier
+        changed = 1;
+        i = prev ? prev : l->head;
+      } else {
+        i = i->next;
+      }
+    }
+  } while (changed);
+
+  return 0;
+}
+
+void peephole_print_stats(FILE *f) {
+  unsigned long applied = 0, insts = 0, cycles = 0;
+
+  fprintf(f, "%-20s %8s %8s %8s\n", "peephole rule", "applied", "insts", "cycles");
+  for (size_t k = 0 ; k < N_RULES ; k++) {
+    fprintf(f, "%-20s %8lu %8lu %8lu\n",
+            rules[k].name, rules[k].applied, rules[k].insts, rules[k].cycles);
+
+    applied += rules[k].applied;
+    insts += rules[k].insts;
+    cycles += rules[k].cycles;
+  }
+  fprintf(f, "%-20s %8lu %8lu %8lu\n", "total", applied, insts, cycles);
+}
@@ -0,0 +1,1507 @@
+#include "regalloc.h"
+
+#include "options.h"
+#include "mix.h"
+#include "tail.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define INDEX_REGS 4     // rI1-rI4, rI5 and rI6 hold FP and SP
+#define REG_RA 4         // the method exit loads the return address in rI4
+#define ALL_REGS 0x1eu   // bit k stands for rIk
+#define LOOP_WEIGHT 8    // estimated iterations of a loop
+#define MAX_LOOP_DEPTH 6
+#define WIDEN_ROUND 3    // iterations before bounds that keep growing are widened
+
+typedef struct {
+  long long lo, hi; // empty when lo > hi
+} Range;
+
+typedef struct {
+  int reachable;
+  Range *vars;
+} RangeState;
+
+struct RaMethod;
+
+struct RaVar {
+  const char *name;
+  int param;         // parameter position + 1, 0 for locals
+  Range range;       // every value assigned to the variable
+  long long hot;     // reads and writes, weighted by loop depth
+  long long benefit; // estimated cycles saved by keeping it in a register
+  int reg;           // 0 when the variable stays in memory
+};
+
+struct RaCall {
+  const ASTNode *call;
+  struct RaMethod *callee;
+  long long weight;
+  unsigned char *crossing; // variables live across the call
+  const char **saves;
+  size_t n_saves;
+};
+
+// value assigned by an assignment or an initialized variable
+struct RaDef {
+  const ASTNode *node;
+  int var;
+  Range range;
+};
+
+struct RaMethod {
+  const ASTNode *node;
+  HashTable *symbols;
+
+  struct RaVar *vars;
+  size_t n_vars;
+  unsigned char *interfere; // n_vars * n_vars
+
+  struct RaCall *calls;
+  size_t n_calls;
+
+  struct RaDef *defs;
+  size_t n_defs;
+
+  Range *params;  // values passed by every call site so far
+  Range *pending; // values passed in the current round
+  int analyzed;
+
+  int visiting, done;
+  unsigned int clobber; // registers a call to the method may change
+};
+
+static struct RaMethod *methods = NULL;
+static size_t n_methods = 0;
+
+static long long word_max = 0;  // largest magnitude of a word
+static long long index_max = 0; // largest magnitude of an index register
+
+/* execution time of an instruction, from the MIX timing table */
+static long long inst_time(const char *opcode) {
+  const MixOpcode *op = mix_opcode_find(opcode);
+  return mix_opcode_time(op, op ? op->field : 0);
+}
+
+static struct RaMethod *method_find(const char *name) {
+  for (size_t k = 0 ; k < n_methods ; k++) {
+    if (strcmp(methods[k].node->method.name, name) == 0) return &methods[k];
+  }
+
+  return NULL;
+}
+
+static int var_index(const struct RaMethod *m, const char *name) {
+  for (size_t k = 0 ; k < m->n_vars ; k++) {
+    if (strcmp(m->vars[k].name, name) == 0) return (int)k;
+  }
+
+  return -1;
+}
+
+static struct RaCall *call_find(const struct RaMethod *m, const ASTNode *call) {
+  for (size_t k = 0 ; k < m->n_calls ; k++) {
+    if (m->calls[k].call == call) return &m->calls[k];
+  }
+
+  return NULL;
+}
+
+static int is_self_tail_call(const struct RaMethod *m, const ASTNode *ret) {
+  return options.tail_calls && tail_is_self_call(ret, m->node->method.name);
+}
+
+int regalloc_index_sum(const ASTNode *e, const char **name, int *value) {
+  long long max = 1;
+  for (int i = 0 ; i < MIX_INDEX_BYTES ; i++) max *= MIX_BYTE_SIZE;
+  max -= 1;
+
+  if (e == NULL || e->kind != N_BINOP) return 0;
+
+  const ASTNode *lhs = e->binop.lhs, *rhs = e->binop.rhs;
+
+  switch (e->binop.op) {
+    case OP_ADDOP_ADD:
+      if (lhs->kind == N_NUMBER) {
+        const ASTNode *swap = lhs;
+        lhs = rhs;
+        rhs = swap;
+      }
+      if (lhs->kind != N_IDENTIFIER || rhs->kind != N_NUMBER) return 0;
+      if (rhs->number.val < -max || rhs->number.val > max) return 0;
+
+      *name = lhs->identifier.name;
+      *value = rhs->number.val;
+      return 1;
+
+    case OP_ADDOP_SUB:
+      if (lhs->kind != N_IDENTIFIER || rhs->kind != N_NUMBER) return 0;
+      if (rhs->number.val < -max || rhs->number.val > max) return 0;
+
+      *name = lhs->identifier.name;
+      *value = -rhs->number.val;
+      return 1;
+
+    default:
+      return 0;
+  }
+}
+
+/* value ranges */
+
+static Range range_top(void) {
+  return (Range) {-word_max, word_max};
+}
+
+static Range range_empty(void) {
+  return (Range) {1, 0};
+}
+
+static int range_is_empty(Range r) {
+  return r.lo > r.hi;
+}
+
+/* values outside of a word wrap around, so nothing is known of them */
+static Range range_make(long long lo, long long hi) {
+  if (lo < -word_max || hi > word_max) return range_top();
+  return (Range) {lo, hi};
+}
+
+static Range range_join(Range a, Range b) {
+  if (range_is_empty(a)) return b;
+  if (range_is_empty(b)) return a;
+
+  return (Range) {a.lo < b.lo ? a.lo : b.lo, a.hi > b.hi ? a.hi : b.hi};
+}
+
+static Range range_meet(Range a, Range b) {
+  return (Range) {a.lo > b.lo ? a.lo : b.lo, a.hi < b.hi ? a.hi : b.hi};
+}
+
+static int range_equal(Range a, Range b) {
+  if (range_is_empty(a) || range_is_empty(b)) return range_is_empty(a) && range_is_empty(b);
+  return a.lo == b.lo && a.hi == b.hi;
+}
+
+/* bounds that are still moving go straight to the limits of a word */
+static Range range_widen(Range old, Range new) {
+  if (range_is_empty(old) || range_is_empty(new)) return range_join(old, new);
+
+  return (Range) {
+    new.lo < old.lo ? -word_max : old.lo,
+    new.hi > old.hi ? word_max : old.hi
+  };
+}
+
+static int range_mul_fits(long long a, long long b) {
+  if (a == 0 || b == 0) return 1;
+  return llabs(a) <= word_max / llabs(b);
+}
+
+static Range range_binop(enum OpKind op, Range a, Range b) {
+  long long c[4];
+
+  if (range_is_empty(a) || range_is_empty(b)) return range_empty();
+
+  switch (op) {
+    case OP_RELOP_LEQ: case OP_RELOP_LT:
+    case OP_RELOP_GT:  case OP_RELOP_GEQ:
+    case OP_RELOP_EQ:  case OP_RELOP_NEQ:
+      return (Range) {0, 1};
+
+    case OP_ADDOP_ADD:
+      return range_make(a.lo + b.lo, a.hi + b.hi);
+
+    case OP_ADDOP_SUB:
+      return range_make(a.lo - b.hi, a.hi - b.lo);
+
+    case OP_MULOP_MUL:
+      if (!range_mul_fits(a.lo, b.lo) || !range_mul_fits(a.lo, b.hi)
+          || !range_mul_fits(a.hi, b.lo) || !range_mul_fits(a.hi, b.hi)) return range_top();
+      c[0] = a.lo * b.lo;
+      c[1] = a.lo * b.hi;
+      c[2] = a.hi * b.lo;
+      c[3] = a.hi * b.hi;
+      break;
+
+    case OP_MULOP_DIV:
+      // the result of a division by zero is undefined
+      if (b.lo <= 0 && b.hi >= 0) return range_top();
+      c[0] = a.lo / b.lo;
+      c[1] = a.lo / b.hi;
+      c[2] = a.hi / b.lo;
+      c[3] = a.hi / b.hi;
+      break;
+
+    default:
+      return range_top();
+  }
+
+  Range r = {c[0], c[0]};
+  for (int i = 1 ; i < 4 ; i++) {
+    if (c[i] < r.lo) r.lo = c[i];
+    if (c[i] > r.hi) r.hi = c[i];
+  }
+
+  return range_make(r.lo, r.hi);
+}
+
+static RangeState *state_new(const struct RaMethod *m) {
+  RangeState *s = malloc(sizeof(RangeState));
+  if (s == NULL) return NULL;
+
+  s->reachable = 0;
+  s->vars = calloc(m->n_vars + 1, sizeof(Range));
+  if (s->vars == NULL) {
+    free(s);
+    return NULL;
+  }
+
+  return s;
+}
+
+static void state_free(RangeState *s) {
+  if (s == NULL) return;
+
+  free(s->vars);
+  free(s);
+}
+
+static void state_copy(const struct RaMethod *m, RangeState *dst, const RangeState *src) {
+  dst->reachable = src->reachable;
+  memcpy(dst->vars, src->vars, m->n_vars * sizeof(Range));
+}
+
+static void state_join(const struct RaMethod *m, RangeState *dst, const RangeState *src) {
+  if (!src->reachable) return;
+  if (!dst->reachable) {
+    state_copy(m, dst, src);
+    return;
+  }
+
+  for (size_t k = 0 ; k < m->n_vars ; k++) {
+    dst->vars[k] = range_join(dst->vars[k], src->vars[k]);
+  }
+}
+
+static void state_widen(const struct RaMethod *m, RangeState *dst, const RangeState *old) {
+  if (!old->reachable || !dst->reachable) return;
+
+  for (size_t k = 0 ; k < m->n_vars ; k++) {
+    dst->vars[k] = range_widen(old->vars[k], dst->vars[k]);
+  }
+}
+
+static int state_equal(const struct RaMethod *m, const RangeState *a, const RangeState *b) {
+  if (a->reachable != b->reachable) return 0;
+  if (!a->reachable) return 1;
+
+  for (size_t k = 0 ; k < m->n_vars ; k++) {
+    if (!range_equal(a->vars[k], b->vars[k])) return 0;
+  }
+
+  return 1;
+}
+
+struct RangeCtx {
+  struct RaMethod *m;
+  RangeState *breaks; // states at the break statements of the innermost loop
+};
+
+static Range range_expr(struct RangeCtx *c, const ASTNode *e, const RangeState *s) {
+  struct RaMethod *callee = NULL;
+  int k;
+  size_t i = 0;
+
+  switch (e->kind) {
+    case N_NUMBER:
+      return (Range) {mix_word_wrap(e->number.val), mix_word_wrap(e->number.val)};
+
+    case N_IDENTIFIER:
+      k = var_index(c->m, e->identifier.name);
+      return k >= 0 ? s->vars[k] : range_top();
+
+    case N_UNARY: {
+      Range r = range_expr(c, e->unary.expr, s);
+      if (range_is_empty(r)) return r;
+      return (Range) {-r.hi, -r.lo};
+    }
+
+    case N_BINOP:
+      return range_binop(e->binop.op, range_expr(c, e->binop.lhs, s),
+                         range_expr(c, e->binop.rhs, s));
+
+    case N_CALL:
+      // the arguments are the values of the parameters of the callee
+      callee = method_find(e->call.fname);
+      for (const ASTList *l = e->call.args ; l != NULL ; l = l->list, i++) {
+        Range r = range_expr(c, l->node, s);
+        if (callee != NULL && i < ast_list_size(callee->node->method.params)) {
+          callee->pending[i] = range_join(callee->pending[i], r);
+        }
+      }
+      return range_top();
+
+    default:
+      return range_top();
+  }
+}
+
+static enum OpKind relop_negate(enum OpKind op) {
+  switch (op) {
+    case OP_RELOP_LT:  return OP_RELOP_GEQ;
+    case OP_RELOP_GEQ: return OP_RELOP_LT;
+    case OP_RELOP_LEQ: return OP_RELOP_GT;
+    case OP_RELOP_GT:  return OP_RELOP_LEQ;
+    case OP_RELOP_EQ:  return OP_RELOP_NEQ;
+    default:           return OP_RELOP_EQ;
+  }
+}
+
+static enum OpKind relop_mirror(enum OpKind op) {
+  switch (op) {
+    case OP_RELOP_LT:  return OP_RELOP_GT;
+    case OP_RELOP_GT:  return OP_RELOP_LT;
+    case OP_RELOP_LEQ: return OP_RELOP_GEQ;
+    case OP_RELOP_GEQ: return OP_RELOP_LEQ;
+    default:           return op;
+  }
+}
+
+static int is_relop(const ASTNode *n) {
+  return n->kind == N_BINOP && n->binop.op >= OP_RELOP_LEQ && n->binop.op <= OP_RELOP_NEQ;
+}
+
+/* restrict the variable to the values for which "var op r" holds */
+static void range_refine_var(RangeState *s, int k, enum OpKind op, Range r) {
+  Range *v = &s->vars[k];
+
+  if (range_is_empty(r)) return;
+
+  switch (op) {
+    case OP_RELOP_LT:
+      if (r.hi - 1 < v->hi) v->hi = r.hi - 1;
+      break;
+    case OP_RELOP_LEQ:
+      if (r.hi < v->hi) v->hi = r.hi;
+      break;
+    case OP_RELOP_GT:
+      if (r.lo + 1 > v->lo) v->lo = r.lo + 1;
+      break;
+    case OP_RELOP_GEQ:
+      if (r.lo > v->lo) v->lo = r.lo;
+      break;
+    case OP_RELOP_EQ:
+      *v = range_meet(*v, r);
+      break;
+    case OP_RELOP_NEQ:
+      if (r.lo == r.hi && v->lo == r.lo) v->lo += 1;
+      else if (r.lo == r.hi && v->hi == r.lo) v->hi -= 1;
+      break;
+    default:
+      break;
+  }
+
+  if (range_is_empty(*v)) s->reachable = 0;
+}
+
+/* restrict the state to the values for which the condition is true (or false) */
+static void range_refine(struct RangeCtx *c, const ASTNode *cond, RangeState *s, int truth) {
+  int k;
+
+  if (!s->reachable) return;
+
+  if (is_relop(cond)) {
+    enum OpKind op = truth ? cond->binop.op : relop_negate(cond->binop.op);
+    Range lhs = range_expr(c, cond->binop.lhs, s);
+    Range rhs = range_expr(c, cond->binop.rhs, s);
+
+    if (cond->binop.lhs->kind == N_IDENTIFIER
+        && (k = var_index(c->m, cond->binop.lhs->identifier.name)) >= 0) {
+      range_refine_var(s, k, op, rhs);
+    }
+    if (cond->binop.rhs->kind == N_IDENTIFIER
+        && (k = var_index(c->m, cond->binop.rhs->identifier.name)) >= 0) {
+      range_refine_var(s, k, relop_mirror(op), lhs);
+    }
+  } else if (cond->kind == N_IDENTIFIER
+             && (k = var_index(c->m, cond->identifier.name)) >= 0) {
+    range_refine_var(s, k, truth ? OP_RELOP_NEQ : OP_RELOP_EQ, (Range) {0, 0});
+  }
+}
+
+/* the range of the last analysis of a definition replaces the previous ones,
+   so that the loops enclosing it are taken at their fixed point */
+static int range_record(struct RaMethod *m, const ASTNode *node, int var, Range r) {
+  for (size_t k = 0 ; k < m->n_defs ; k++) {
+    if (m->defs[k].node == node) {
+      m->defs[k].range = r;
+      return 0;
+    }
+  }
+
+  struct RaDef *d = realloc(m->defs, (m->n_defs + 1) * sizeof(struct RaDef));
+  if (d == NULL) return -1;
+
+  m->defs = d;
+  m->defs[m->n_defs++] = (struct RaDef) {.node = node, .var = var, .range = r};
+  return 0;
+}
+
+static int range_stmt(struct RangeCtx *c, const ASTNode *n, RangeState *s);
+
+static int range_list(struct RangeCtx *c, const ASTList *l, RangeState *s) {
+  for ( ; l != NULL ; l = l->list) {
+    if (range_stmt(c, l->node, s)) return -1;
+  }
+
+  return 0;
+}
+
+static int range_assign(struct RangeCtx *c, const ASTNode *n, const char *name,
+                        const ASTNode *rhs, RangeState *s) {
+  Range r = range_expr(c, rhs, s);
+  int k = var_index(c->m, name);
+
+  if (k < 0) return 0;
+
+  s->vars[k] = r;
+  return range_record(c->m, n, k, r);
+}
+
+/* iterate the loop body up to a fixed point of the state at the condition,
+   widened after a few rounds, then take one narrowing step and analyze the
+   body a last time from the narrowed state */
+static int range_while(struct RangeCtx *c, const ASTNode *n, RangeState *s) {
+  const struct RaMethod *m = c->m;
+  RangeState *saved_breaks = c->breaks;
+  RangeState *entry = state_new(m), *head = state_new(m);
+  RangeState *body = state_new(m), *breaks = state_new(m);
+  int status = -1;
+
+  if (entry == NULL || head == NULL || body == NULL || breaks == NULL) goto done;
+
+  state_copy(m, entry, s);
+  state_copy(m, head, s);
+  c->breaks = breaks;
+
+  for (int round = 0 ; ; round++) {
+    state_copy(m, body, head);
+    range_refine(c, n->branch.cond, body, 1);
+    breaks->reachable = 0;
+    if (range_stmt(c, n->branch.then_branch, body)) goto done;
+
+    state_join(m, body, entry);
+    if (round >= WIDEN_ROUND) state_widen(m, body, head);
+    if (state_equal(m, body, head)) break;
+
+    state_copy(m, head, body);
+  }
+
+  for (int pass = 0 ; pass < 2 ; pass++) {
+    state_copy(m, body, head);
+    range_expr(c, n->branch.cond, body);
+    range_refine(c, n->branch.cond, body, 1);
+    breaks->reachable = 0;
+    if (range_stmt(c, n->branch.then_branch, body)) goto done;
+
+    // narrowing step, the last pass keeps the definitions it records
+    if (pass == 0) {
+      state_join(m, body, entry);
+      state_copy(m, head, body);
+    }
+  }
+
+  state_copy(m, s, head);
+  range_refine(c, n->branch.cond, s, 0);
+  state_join(m, s, breaks);
+  status = 0;
+
+done:
+  c->breaks = saved_breaks;
+  state_free(entry);
+  state_free(head);
+  state_free(body);
+  state_free(breaks);
+  return status;
+}
+
+static int range_dead_list(struct RaMethod *m, const ASTList *l);
+
+/* code that no state reaches is still generated, so its constants must fit
+   the register of the variable they are assigned to: its definitions take
+   any value but that of a number */
+static int range_dead(struct RaMethod *m, const ASTNode *n) {
+  const ASTNode *rhs = NULL;
+  const char *name = NULL;
+  int k;
+
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_BODY:
+      if (range_dead_list(m, n->body.decls)) return -1;
+      return range_dead_list(m, n->body.stmts);
+
+    case N_DECL:
+      return range_dead_list(m, n->decl.vars);
+
+    case N_BLOCK:
+      return range_dead_list(m, n->block.stmts);
+
+    case N_IF:
+      if (range_dead(m, n->branch.then_branch)) return -1;
+      return range_dead(m, n->branch.else_branch);
+
+    case N_WHILE:
+      return range_dead(m, n->branch.then_branch);
+
+    case N_VAR:
+      name = n->var.name;
+      rhs = n->var.expr;
+      break;
+
+    case N_ASSIGN:
+      name = n->assign.location;
+      rhs = n->assign.rhs;
+      break;
+
+    default:
+      return 0;
+  }
+
+  if (rhs == NULL || (k = var_index(m, name)) < 0) return 0;
+  if (rhs->kind != N_NUMBER) return range_record(m, n, k, range_top());
+
+  long long v = mix_word_wrap(rhs->number.val);
+  return range_record(m, n, k, range_make(v, v));
+}
+
+static int range_dead_list(struct RaMethod *m, const ASTList *l) {
+  for ( ; l != NULL ; l = l->list) {
+    if (range_dead(m, l->node)) return -1;
+  }
+
+  return 0;
+}
+
+static int range_stmt(struct RangeCtx *c, const ASTNode *n, RangeState *s) {
+  RangeState *e = NULL;
+
+  if (n == NULL) return 0;
+  if (!s->reachable) return range_dead(c->m, n);
+
+  switch (n->kind) {
+    case N_BODY:
+      if (range_list(c, n->body.decls, s)) return -1;
+      return range_list(c, n->body.stmts, s);
+
+    case N_DECL:
+      return range_list(c, n->decl.vars, s);
+
+    case N_VAR:
+      if (n->var.expr == NULL) return 0;
+      return range_assign(c, n, n->var.name, n->var.expr, s);
+
+    case N_BLOCK:
+      return range_list(c, n->block.stmts, s);
+
+    case N_ASSIGN:
+      return range_assign(c, n, n->assign.location, n->assign.rhs, s);
+
+    case N_IF:
+      e = state_new(c->m);
+      if (e == NULL) return -1;
+
+      range_expr(c, n->branch.cond, s);
+      state_copy(c->m, e, s);
+      range_refine(c, n->branch.cond, s, 1);
+      range_refine(c, n->branch.cond, e, 0);
+
+      if (range_stmt(c, n->branch.then_branch, s)
+          || range_stmt(c, n->branch.else_branch, e)) {
+        state_free(e);
+        return -1;
+      }
+
+      state_join(c->m, s, e);
+      state_free(e);
+      return 0;
+
+    case N_WHILE:
+      return range_while(c, n, s);
+
+    case N_RETURN:
+      // self tail calls pass their arguments like any other call
+      range_expr(c, n->ret.expr, s);
+      s->reachable = 0;
+      return 0;
+
+    case N_BREAK:
+      if (c->breaks != NULL) state_join(c->m, c->breaks, s);
+      s->reachable = 0;
+      return 0;
+
+    default:
+      return 0;
+  }
+}
+
+static int range_method(struct RaMethod *m) {
+  struct RangeCtx c = {.m = m, .breaks = NULL};
+  RangeState *s = state_new(m);
+  if (s == NULL) return -1;
+
+  s->reachable = 1;
+  for (size_t k = 0 ; k < m->n_vars ; k++) {
+    s->vars[k] = m->vars[k].param ? m->params[m->vars[k].param - 1] : range_top();
+  }
+
+  m->n_defs = 0;
+  int status = range_stmt(&c, m->node->method.body, s);
+
+  state_free(s);
+  return status;
+}
+
+/* analyze every method with the values its call sites pass to the
+   parameters, until those do not change anymore */
+static int range_program(void) {
+  for (int round = 0 ; ; round++) {
+    int changed = 0;
+
+    for (size_t k = 0 ; k < n_methods ; k++) {
+      struct RaMethod *m = &methods[k];
+      size_t n_params = ast_list_size(m->node->method.params);
+
+      for (size_t i = 0 ; i < n_params ; i++) m->pending[i] = range_empty();
+    }
+
+    for (size_t k = 0 ; k < n_methods ; k++) {
+      struct RaMethod *m = &methods[k];
+      size_t n_params = ast_list_size(m->node->method.params);
+
+      // methods with parameters that no call reaches are not analyzed
+      m->analyzed = n_params == 0 || !range_is_empty(m->params[0]);
+      if (m->analyzed && range_method(m)) return -1;
+    }
+
+    for (size_t k = 0 ; k < n_methods ; k++) {
+      struct RaMethod *m = &methods[k];
+      size_t n_params = ast_list_size(m->node->method.params);
+
+      for (size_t i = 0 ; i < n_params ; i++) {
+        Range r = range_join(m->params[i], m->pending[i]);
+        if (round >= WIDEN_ROUND) r = range_widen(m->params[i], r);
+
+        if (!range_equal(r, m->params[i])) {
+          m->params[i] = r;
+          changed = 1;
+        }
+      }
+    }
+
+    if (!changed) return 0;
+  }
+}
+
+/* cost estimates: cycles saved with the variable in an index register */
+
+static int is_operand(const ASTNode *n) {
+  return n->kind == N_IDENTIFIER || n->kind == N_NUMBER;
+}
+
+static int is_mirrorable(enum OpKind op) {
+  return op == OP_ADDOP_ADD || op == OP_MULOP_MUL || (op >= OP_RELOP_LEQ && op <= OP_RELOP_NEQ);
+}
+
+static void weigh_var(struct RaMethod *m, const char *name, long long weight,
+                      long long benefit) {
+  int k = var_index(m, name);
+  if (k < 0) return;
+
+  m->vars[k].hot += weight;
+  m->vars[k].benefit += weight * benefit;
+}
+
+static int weigh_call(struct RaMethod *m, const ASTNode *call, long long weight) {
+  struct RaCall *c = realloc(m->calls, (m->n_calls + 1) * sizeof(struct RaCall));
+  if (c == NULL) return -1;
+
+  m->calls = c;
+  m->calls[m->n_calls] = (struct RaCall) {
+    .call = call,
+    .callee = method_find(call->call.fname),
+    .weight = weight,
+    .crossing = calloc(m->n_vars + 1, 1),
+    .saves = NULL,
+    .n_saves = 0
+  };
+  if (m->calls[m->n_calls].crossing == NULL) return -1;
+
+  m->n_calls += 1;
+  return 0;
+}
+
+/* the expression is evaluated into rA (load) or is the memory operand of
+   an instruction, following the choices of the code generator */
+static int weigh_expr(struct RaMethod *m, const ASTNode *e, long long weight, int load) {
+  const char *name;
+  int value;
+
+  switch (e->kind) {
+    case N_IDENTIFIER:
+      if (!options.register_expr) {
+        // pushed with STi instead of LDA and STA
+        weigh_var(m, e->identifier.name, weight, inst_time("LDA"));
+      } else if (load) {
+        weigh_var(m, e->identifier.name, weight, inst_time("LDA") - inst_time("ENTA"));
+      } else {
+        // stored to its frame word to be used as an operand
+        weigh_var(m, e->identifier.name, weight, -inst_time("ST1"));
+      }
+      return 0;
+
+    case N_NUMBER:
+      return 0;
+
+    case N_UNARY:
+      if (options.register_expr && e->unary.expr->kind == N_IDENTIFIER) {
+        weigh_var(m, e->unary.expr->identifier.name, weight,
+                  inst_time("LDAN") - inst_time("ENNA"));
+        return 0;
+      }
+      return weigh_expr(m, e->unary.expr, weight, 1);
+
+    case N_BINOP:
+      if (options.register_expr && load && regalloc_index_sum(e, &name, &value)) {
+        // ENTA c,i instead of LDA and ADD
+        weigh_var(m, name, weight, inst_time("LDA") + inst_time("ADD") - inst_time("ENTA"));
+        return 0;
+      }
+
+      if (!options.register_expr || !is_operand(e->binop.rhs)) {
+        if (options.register_expr && is_mirrorable(e->binop.op) && is_operand(e->binop.lhs)) {
+          if (weigh_expr(m, e->binop.rhs, weight, 1)) return -1;
+          return weigh_expr(m, e->binop.lhs, weight, 0);
+        }
+        if (weigh_expr(m, e->binop.rhs, weight, 1)) return -1;
+        return weigh_expr(m, e->binop.lhs, weight, 1);
+      }
+
+      if (weigh_expr(m, e->binop.lhs, weight, 1)) return -1;
+      return weigh_expr(m, e->binop.rhs, weight, 0);
+
+    case N_CALL:
+      if (weigh_call(m, e, weight)) return -1;
+      for (const ASTList *l = e->call.args ; l != NULL ; l = l->list) {
+        if (weigh_expr(m, l->node, weight, 1)) return -1;
+      }
+      return 0;
+
+    default:
+      return 0;
+  }
+}
+
+static int weigh_cond(struct RaMethod *m, const ASTNode *cond, long long weight) {
+  if (options.fuse_compare && is_relop(cond)
+      && is_operand(cond->binop.lhs) && is_operand(cond->binop.rhs)) {
+    const ASTNode *var = cond->binop.lhs, *other = cond->binop.rhs;
+    if (var->kind != N_IDENTIFIER) {
+      var = cond->binop.rhs;
+      other = cond->binop.lhs;
+    }
+
+    if (var->kind == N_IDENTIFIER) {
+      if (other->kind == N_NUMBER && other->number.val == 0) {
+        // Ji<cond> instead of LDA and JA<cond>
+        weigh_var(m, var->identifier.name, weight, inst_time("LDA"));
+      } else {
+        // CMPi instead of LDA and CMPA
+        weigh_var(m, var->identifier.name, weight,
+                  inst_time("LDA") + inst_time("CMPA") - inst_time("CMP1"));
+        if (other->kind == N_IDENTIFIER) {
+          weigh_var(m, other->identifier.name, weight, -inst_time("ST1"));
+        }
+      }
+      return 0;
+    }
+  }
+
+  return weigh_expr(m, cond, weight, 1);
+}
+
+static int weigh_assign(struct RaMethod *m, const char *name, const ASTNode *rhs,
+                        long long weight) {
+  const char *src;
+  int value;
+
+  if (rhs->kind == N_NUMBER) {
+    // ENTi c instead of LDA and STA
+    weigh_var(m, name, weight, inst_time("LDA") + inst_time("STA") - inst_time("ENT1"));
+    return 0;
+  }
+
+  if (regalloc_index_sum(rhs, &src, &value) && strcmp(src, name) == 0) {
+    // INCi c instead of LDA, ADD and STA
+    weigh_var(m, name, weight, inst_time("LDA") + inst_time("ADD") + inst_time("STA")
+                               - inst_time("INC1"));
+    weigh_var(m, name, weight, 0);
+    return 0;
+  }
+
+  if (rhs->kind == N_IDENTIFIER) {
+    // LDi or ENTi 0,j instead of LDA and STA
+    weigh_var(m, name, weight, inst_time("LDA") + inst_time("STA") - inst_time("LD1"));
+    weigh_var(m, rhs->identifier.name, weight, inst_time("LD1") - inst_time("ENT1"));
+    return 0;
+  }
+
+  if (regalloc_index_sum(rhs, &src, &value)) {
+    // LDi and INCi, or ENTi c,j, instead of LDA, ADD and STA
+    weigh_var(m, name, weight, inst_time("LDA") + inst_time("ADD") + inst_time("STA")
+                               - inst_time("LD1") - inst_time("INC1"));
+    weigh_var(m, src, weight, inst_time("LD1") + inst_time("INC1") - inst_time("ENT1"));
+    return 0;
+  }
+
+  if (options.register_expr) {
+    // stored to its frame word and loaded to the register
+    weigh_var(m, name, weight, -inst_time("LD1"));
+  } else {
+    // popped with LDi instead of LDA and STA
+    weigh_var(m, name, weight, inst_time("STA"));
+  }
+
+  return weigh_expr(m, rhs, weight, 1);
+}
+
+static int weigh_stmt(struct RaMethod *m, const ASTNode *n, int depth);
+
+static int weigh_list(struct RaMethod *m, const ASTList *l, int depth) {
+  for ( ; l != NULL ; l = l->list) {
+    if (weigh_stmt(m, l->node, depth)) return -1;
+  }
+
+  return 0;
+}
+
+static int weigh_stmt(struct RaMethod *m, const ASTNode *n, int depth) {
+  long long weight = 1;
+
+  if (n == NULL) return 0;
+
+  for (int d = 0 ; d < depth && d < MAX_LOOP_DEPTH ; d++) weight *= LOOP_WEIGHT;
+
+  switch (n->kind) {
+    case N_BODY:
+      if (weigh_list(m, n->body.decls, depth)) return -1;
+      return weigh_list(m, n->body.stmts, depth);
+
+    case N_DECL:
+      return weigh_list(m, n->decl.vars, depth);
+
+    case N_VAR:
+      if (n->var.expr == NULL) return 0;
+      return weigh_assign(m, n->var.name, n->var.expr, weight);
+
+    case N_BLOCK:
+      return weigh_list(m, n->block.stmts, depth);
+
+    case N_ASSIGN:
+      return weigh_assign(m, n->assign.location, n->assign.rhs, weight);
+
+    case N_IF:
+      if (weigh_cond(m, n->branch.cond, weight)) return -1;
+      if (weigh_stmt(m, n->branch.then_branch, depth)) return -1;
+      return weigh_stmt(m, n->branch.else_branch, depth);
+
+    case N_WHILE:
+      if (weigh_cond(m, n->branch.cond, weight * LOOP_WEIGHT)) return -1;
+      return weigh_stmt(m, n->branch.then_branch, depth + 1);
+
+    case N_RETURN:
+      if (is_self_tail_call(m, n)) {
+        // a jump, the arguments are stored over the parameters
+        const ASTList *p = m->node->method.params;
+        for (const ASTList *l = n->ret.expr->call.args ; l != NULL ; l = l->list, p = p->list) {
+          if (weigh_expr(m, l->node, weight, 1)) return -1;
+          weigh_var(m, p->node->param.name, weight,
+                    options.register_expr ? -inst_time("LD1") : inst_time("STA"));
+        }
+        return 0;
+      }
+      return weigh_expr(m, n->ret.expr, weight, 1);
+
+    default:
+      return 0;
+  }
+}
+
+/* liveness */
+
+struct LiveCtx {
+  struct RaMethod *m;
+  const unsigned char *breaks; // live after the innermost loop
+  const unsigned char *entry;  // live at the start of the body
+};
+
+static void live_uses(const struct RaMethod *m, const ASTNode *e, const ASTNode *skip,
+                      unsigned char *live) {
+  int k;
+
+  if (e == NULL || e == skip) return;
+
+  switch (e->kind) {
+    case N_IDENTIFIER:
+      if ((k = var_index(m, e->identifier.name)) >= 0) live[k] = 1;
+      break;
+
+    case N_UNARY:
+      live_uses(m, e->unary.expr, skip, live);
+      break;
+
+    case N_BINOP:
+      live_uses(m, e->binop.lhs, skip, live);
+      live_uses(m, e->binop.rhs, skip, live);
+      break;
+
+    case N_CALL:
+      for (const ASTList *l = e->call.args ; l != NULL ; l = l->list) {
+        live_uses(m, l->node, skip, live);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+static void live_interfere(struct RaMethod *m, int def, const unsigned char *live) {
+  for (size_t k = 0 ; k < m->n_vars ; k++) {
+    if (live[k] && (int)k != def) {
+      m->interfere[def * m->n_vars + k] = 1;
+      m->interfere[k * m->n_vars + def] = 1;
+    }
+  }
+}
+
+/* the variables live after the statement (but the one it assigns) and the
+   ones the statement reads outside of the call are live across each call */
+static void live_calls(struct RaMethod *m, const ASTNode *e, const ASTNode *root,
+                       const unsigned char *after, int def) {
+  struct RaCall *c;
+
+  if (e == NULL) return;
+
+  switch (e->kind) {
+    case N_UNARY:
+      live_calls(m, e->unary.expr, root, after, def);
+      break;
+
+    case N_BINOP:
+      live_calls(m, e->binop.lhs, root, after, def);
+      live_calls(m, e->binop.rhs, root, after, def);
+      break;
+
+    case N_CALL:
+      if ((c = call_find(m, e)) != NULL) {
+        for (size_t k = 0 ; k < m->n_vars ; k++) {
+          if (after[k] && (int)k != def) c->crossing[k] = 1;
+        }
+        live_uses(m, root, e, c->crossing);
+      }
+      for (const ASTList *l = e->call.args ; l != NULL ; l = l->list) {
+        live_calls(m, l->node, root, after, def);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+static int live_stmt(struct LiveCtx *c, const ASTNode *n, unsigned char *live);
+
+/* statements are visited last to first */
+static int live_list(struct LiveCtx *c, const ASTList *l, unsigned char *live) {
+  if (l == NULL) return 0;
+
+  if (live_list(c, l->list, live)) return -1;
+  return live_stmt(c, l->node, live);
+}
+
+static void live_def(struct LiveCtx *c, const char *name, const ASTNode *rhs,
+                     unsigned char *live) {
+  int k = var_index(c->m, name);
+
+  live_calls(c->m, rhs, rhs, live, k);
+  if (k >= 0) {
+    live_interfere(c->m, k, live);
+    live[k] = 0;
+  }
+  live_uses(c->m, rhs, NULL, live);
+}
+
+static int live_while(struct LiveCtx *c, const ASTNode *n, unsigned char *live) {
+  size_t size = c->m->n_vars + 1;
+  const unsigned char *saved_breaks = c->breaks;
+  unsigned char *out = malloc(size), *head = malloc(size), *body = malloc(size);
+  int status = -1;
+
+  if (out == NULL || head == NULL || body == NULL) goto done;
+
+  memcpy(out, live, size);
+  memcpy(head, live, size);
+  live_uses(c->m, n->branch.cond, NULL, head);
+
+  c->breaks = out;
+  for (;;) {
+    int changed = 0;
+
+    memcpy(body, head, size);
+    if (live_stmt(c, n->branch.then_branch, body)) goto done;
+
+    for (size_t k = 0 ; k < c->m->n_vars ; k++) {
+      if (body[k] && !head[k]) {
+        head[k] = 1;
+        changed = 1;
+      }
+    }
+
+    if (!changed) break;
+  }
+
+  // the condition is followed by the body or the exit
+  for (size_t k = 0 ; k < c->m->n_vars ; k++) body[k] |= out[k];
+  live_calls(c->m, n->branch.cond, n->branch.cond, body, -1);
+
+  memcpy(live, head, size);
+  status = 0;
+
+done:
+  c->breaks = saved_breaks;
+  free(out);
+  free(head);
+  free(body);
+  return status;
+}
+
+static int live_stmt(struct LiveCtx *c, const ASTNode *n, unsigned char *live) {
+  struct RaMethod *m = c->m;
+  size_t size = m->n_vars + 1;
+  unsigned char *other = NULL;
+
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_BODY:
+      if (live_list(c, n->body.stmts, live)) return -1;
+      return live_list(c, n->body.decls, live);
+
+    case N_DECL:
+      return live_list(c, n->decl.vars, live);
+
+    case N_VAR:
+      if (n->var.expr != NULL) live_def(c, n->var.name, n->var.expr, live);
+      return 0;
+
+    case N_BLOCK:
+      return live_list(c, n->block.stmts, live);
+
+    case N_ASSIGN:
+      live_def(c, n->assign.location, n->assign.rhs, live);
+      return 0;
+
+    case N_IF:
+      if ((other = malloc(size)) == NULL) return -1;
+      memcpy(other, live, size);
+
+      if (live_stmt(c, n->branch.then_branch, live)
+          || live_stmt(c, n->branch.else_branch, other)) {
+        free(other);
+        return -1;
+      }
+
+      for (size_t k = 0 ; k < m->n_vars ; k++) live[k] |= other[k];
+      free(other);
+
+      live_calls(m, n->branch.cond, n->branch.cond, live, -1);
+      live_uses(m, n->branch.cond, NULL, live);
+      return 0;
+
+    case N_WHILE:
+      return live_while(c, n, live);
+
+    case N_RETURN:
+      memset(live, 0, size);
+
+      if (is_self_tail_call(m, n)) {
+        // the changed parameters are assigned, the others stay live
+        const ASTList *p = m->node->method.params;
+        memcpy(live, c->entry, size);
+
+        for (const ASTList *l = n->ret.expr->call.args ; l != NULL ; l = l->list, p = p->list) {
+          int k = var_index(m, p->node->param.name);
+          int same = l->node->kind == N_IDENTIFIER
+                     && strcmp(l->node->identifier.name, p->node->param.name) == 0;
+
+          if (k >= 0 && !same) {
+            live_interfere(m, k, c->entry);
+            live[k] = 0;
+          }
+        }
+
+        live_calls(m, n->ret.expr, n->ret.expr, live, -1);
+        live_uses(m, n->ret.expr, NULL, live);
+        return 0;
+      }
+
+      live_calls(m, n->ret.expr, n->ret.expr, live, -1);
+      live_uses(m, n->ret.expr, NULL, live);
+      return 0;
+
+    case N_BREAK:
+      if (c->breaks != NULL) memcpy(live, c->breaks, size);
+      return 0;
+
+    default:
+      return 0;
+  }
+}
+
+/* methods with self tail calls loop back to the start of the body,
+   so the analysis is repeated until the live set there is stable */
+static int live_method(struct RaMethod *m) {
+  size_t size = m->n_vars + 1;
+  unsigned char *entry = calloc(size, 1), *live = calloc(size, 1);
+  struct LiveCtx c = {.m = m, .breaks = NULL, .entry = entry};
+  int status = -1;
+
+  if (entry == NULL || live == NULL) goto done;
+
+  for (;;) {
+    memset(live, 0, size);
+    if (live_stmt(&c, m->node->method.body, live)) goto done;
+
+    if (memcmp(live, entry, size) == 0) break;
+    memcpy(entry, live, size);
+  }
+
+  // the parameters are all loaded at the method entry
+  for (size_t k = 0 ; k < m->n_vars ; k++) {
+    for (size_t j = 0 ; j < m->n_vars ; j++) {
+      if (k != j && m->vars[k].param && m->vars[j].param) m->interfere[k * m->n_vars + j] = 1;
+    }
+  }
+
+  status = 0;
+
+done:
+  free(entry);
+  free(live);
+  return status;
+}
+
+/* allocation */
+
+static unsigned int callee_clobber(const struct RaCall *c) {
+  if (c->callee == NULL || !c->callee->done) return ALL_REGS;
+  return c->callee->clobber;
+}
+
+static long long call_saves_cost(const struct RaMethod *m, int var, int reg) {
+  long long cost = 0;
+
+  for (size_t k = 0 ; k < m->n_calls ; k++) {
+    const struct RaCall *c = &m->calls[k];
+    if (c->crossing[var] && (callee_clobber(c) & (1u << reg))) {
+      cost += c->weight * (inst_time("ST1") + inst_time("LD1"));
+    }
+  }
+
+  return cost;
+}
+
+static int var_fits_index(const struct RaVar *v) {
+  return !range_is_empty(v->range) && v->range.lo >= -index_max && v->range.hi <= index_max;
+}
+
+/* variables by decreasing use, each given the register that saves the
+   most cycles among those not held by an interfering variable */
+static int alloc_method(struct RaMethod *m) {
+  size_t *order = malloc((m->n_vars + 1) * sizeof(size_t));
+  if (order == NULL) return -1;
+
+  for (size_t k = 0 ; k < m->n_vars ; k++) {
+    size_t j = k;
+    while (j > 0 && m->vars[order[j - 1]].hot < m->vars[k].hot) {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = k;
+  }
+
+  for (size_t i = 0 ; i < m->n_vars ; i++) {
+    size_t k = order[i];
+    struct RaVar *v = &m->vars[k];
+    long long best = 0;
+
+    if (!m->analyzed || !var_fits_index(v)) continue;
+
+    for (int reg = 1 ; reg <= INDEX_REGS ; reg++) {
+      int taken = 0;
+      for (size_t j = 0 ; j < m->n_vars ; j++) {
+        if (m->interfere[k * m->n_vars + j] && m->vars[j].reg == reg) taken = 1;
+      }
+      if (taken) continue;
+
+      long long benefit = v->benefit - call_saves_cost(m, (int)k, reg);
+      if (benefit > best) {
+        best = benefit;
+        v->reg = reg;
+      }
+    }
+  }
+
+  free(order);
+  return 0;
+}
+
+/* callees are allocated first, so the registers they change are known */
+static int alloc_visit(struct RaMethod *m) {
+  if (m->done || m->visiting) return 0;
+  m->visiting = 1;
+
+  for (size_t k = 0 ; k < m->n_calls ; k++) {
+    if (m->calls[k].callee != NULL && alloc_visit(m->calls[k].callee)) return -1;
+  }
+
+  if (alloc_method(m)) return -1;
+
+  m->clobber = 1u << REG_RA;
+  for (size_t k = 0 ; k < m->n_vars ; k++) {
+    if (m->vars[k].reg) m->clobber |= 1u << m->vars[k].reg;
+  }
+  for (size_t k = 0 ; k < m->n_calls ; k++) {
+    m->clobber |= callee_clobber(&m->calls[k]);
+  }
+
+  m->visiting = 0;
+  m->done = 1;
+  return 0;
+}
+
+/* the assignment is done on the index register alone, leaving the
+   frame word of the variable out of date */
+static int assigns_in_place(const ASTNode *def) {
+  const ASTNode *rhs = def->kind == N_VAR ? def->var.expr : def->assign.rhs;
+  const char *name;
+  int value;
+
+  return rhs->kind == N_IDENTIFIER || rhs->kind == N_NUMBER
+         || regalloc_index_sum(rhs, &name, &value);
+}
+
+static int publish_method(struct RaMethod *m) {
+  for (size_t k = 0 ; k < m->n_vars ; k++) {
+    if (m->vars[k].reg == 0) continue;
+
+    TableEntry *e = ht_find_entry(m->symbols, m->vars[k].name);
+    if (e == NULL) return -1;
+    e->payload.symbol.reg = m->vars[k].reg;
+    e->payload.symbol.reg_home = 1;
+
+    for (size_t i = 0 ; i < m->n_defs ; i++) {
+      if (m->defs[i].var == (int)k && assigns_in_place(m->defs[i].node)) {
+        e->payload.symbol.reg_home = 0;
+      }
+    }
+  }
+
+  for (size_t i = 0 ; i < m->n_calls ; i++) {
+    struct RaCall *c = &m->calls[i];
+    unsigned int clobber = callee_clobber(c);
+
+    for (size_t k = 0 ; k < m->n_vars ; k++) {
+      if (!c->crossing[k] || !m->vars[k].reg || !(clobber & (1u << m->vars[k].reg))) continue;
+
+      const char **s = realloc(c->saves, (c->n_saves + 1) * sizeof(const char *));
+      if (s == NULL) return -1;
+
+      c->saves = s;
+      c->saves[c->n_saves++] = m->vars[k].name;
+    }
+  }
+
+  return 0;
+}
+
+static int add_var(struct RaMethod *m, const char *name, int param) {
+  struct RaVar *v = realloc(m->vars, (m->n_vars + 1) * sizeof(struct RaVar));
+  if (v == NULL) return -1;
+
+  m->vars = v;
+  m->vars[m->n_vars++] = (struct RaVar) {
+    .name = name,
+    .param = param,
+    .range = range_empty(),
+    .hot = 0,
+    .benefit = 0,
+    .reg = 0
+  };
+
+  return 0;
+}
+
+static int init_method(struct RaMethod *m, const ASTNode *method, const HashTable *gt) {
+  const TableEntry *e = ht_find_entry(gt, method->method.name);
+  int position = 1;
+
+  *m = (struct RaMethod) {.node = method};
+  if (e == NULL) return -1;
+  m->symbols = e->payload.method.symbols;
+
+  for (const ASTList *l = method->method.params ; l != NULL ; l = l->list) {
+    if (add_var(m, l->node->param.name, position++)) return -1;
+  }
+
+  for (const ASTList *d = method->method.body->body.decls ; d != NULL ; d = d->list) {
+    for (const ASTList *l = d->node->decl.vars ; l != NULL ; l = l->list) {
+      if (add_var(m, l->node->var.name, 0)) return -1;
+    }
+  }
+
+  m->interfere = calloc(m->n_vars * m->n_vars + 1, 1);
+  m->params = malloc(position * sizeof(Range));
+  m->pending = malloc(position * sizeof(Range));
+  if (m->interfere == NULL || m->params == NULL || m->pending == NULL) return -1;
+
+  for (int i = 0 ; i < position ; i++) m->params[i] = m->pending[i] = range_empty();
+
+  return 0;
+}
+
+int regalloc_ast(const ASTNode *root, HashTable *gt) {
+  word_max = 1;
+  for (int i = 0 ; i < MIX_WORD_BYTES ; i++) word_max *= MIX_BYTE_SIZE;
+  word_max -= 1;
+
+  index_max = 1;
+  for (int i = 0 ; i < MIX_INDEX_BYTES ; i++) index_max *= MIX_BYTE_SIZE;
+  index_max -= 1;
+
+  regalloc_free();
+
+  n_methods = ast_list_size(root->prog.methods);
+  methods = calloc(n_methods + 1, sizeof(struct RaMethod));
+  if (methods == NULL) return -1;
+
+  size_t k = 0;
+  for (const ASTList *l = root->prog.methods ; l != NULL ; l = l->list, k++) {
+    if (init_method(&methods[k], l->node, gt)) return -1;
+  }
+
+  if (range_program()) return -1;
+
+  for (k = 0 ; k < n_methods ; k++) {
+    struct RaMethod *m = &methods[k];
+
+    // the values the method assigns, and those it receives
+    for (size_t i = 0 ; i < m->n_defs ; i++) {
+      struct RaVar *v = &m->vars[m->defs[i].var];
+      v->range = range_join(v->range, m->defs[i].range);
+    }
+    for (size_t i = 0 ; i < m->n_vars ; i++) {
+      struct RaVar *v = &m->vars[i];
+      if (v->param) {
+        v->range = range_join(v->range, m->params[v->param - 1]);
+        v->benefit -= inst_time("LD1"); // loaded at the method entry
+      }
+    }
+
+    if (weigh_stmt(m, m->node->method.body, 0)) return -1;
+    if (live_method(m)) return -1;
+  }
+
+  for (k = 0 ; k < n_methods ; k++) {
+    if (alloc_visit(&methods[k])) return -1;
+  }
+
+  for (k = 0 ; k < n_methods ; k++) {
+    if (publish_method(&methods[k])) return -1;
+  }
+
+  return 0;
+}
+
+const char *const *regalloc_call_saves(const ASTNode *call, size_t *n_saves) {
+  for (size_t k = 0 ; k < n_methods ; k++) {
+    const struct RaCall *c = call_find(&methods[k], call);
+    if (c != NULL) {
+      *n_saves = c->n_saves;
+      return c->saves;
+    }
+  }
+
+  *n_saves = 0;
+  return NULL;
+}
+
+void regalloc_print_report(FILE *f) {
+  char range[64];
+
+  fprintf(f, "%-20s %-20s %-8s %10s %s\n", "method", "variable", "location", "uses", "range");
+  for (size_t k = 0 ; k < n_methods ; k++) {
+    const struct RaMethod *m = &methods[k];
+
+    for (size_t i = 0 ; i < m->n_vars ; i++) {
+      const struct RaVar *v = &m->vars[i];
+      char location[8];
+
+      if (!m->analyzed) {
+        snprintf(range, sizeof(range), "never called");
+      } else if (range_is_empty(v->range)) {
+        snprintf(range, sizeof(range), "never assigned");
+      } else if (var_fits_index(v)) {
+        snprintf(range, sizeof(range), "[%lld, %lld]", v->range.lo, v->range.hi);
+      } else {
+        snprintf(range, sizeof(range), "[%lld, %lld], too large for rI",
+                 v->range.lo, v->range.hi);
+      }
+
+      if (v->reg) {
+        snprintf(location, sizeof(location), "rI%d", v->reg);
+      } else {
+        snprintf(location, sizeof(location), "memory");
+      }
+
+      fprintf(f, "%-20s %-20s %-8s %10lld %s\n",
+              m->node->method.name, v->name, location, v->hot, range);
+    }
+  }
+}
+
+void regalloc_free(void) {
+  for (size_t k = 0 ; k < n_methods ; k++) {
+    struct RaMethod *m = &methods[k];
+
+    for (size_t i = 0 ; i < m->n_calls ; i++) {
+      free(m->calls[i].crossing);
+      free(m->calls[i].saves);
+    }
+
+    free(m->vars);
+    free(m->interfere);
+    free(m->calls);
+    free(m->defs);
+    free(m->params);
+    free(m->pending);
+  }
+
+  free(methods);
+  methods = NULL;
+  n_methods = 0;
+}
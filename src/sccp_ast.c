@@ -0,0 +1,876 @@
+#include "sccp.h"
+#include "fold.h"
+#include "mix.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* the values an SSA name may hold: not known yet (optimistically any),
+   one constant, or more than one */
+enum LatticeKind { LAT_TOP, LAT_CONST, LAT_BOTTOM };
+
+struct Lattice {
+  enum LatticeKind kind;
+  long long c;
+};
+
+enum ValueKind {
+  SSA_PARAM,  // value of a parameter on entry
+  SSA_UNDEF,  // value of a local before its first assignment
+  SSA_DEF,    // value assigned by an N_ASSIGN or an initialized N_VAR
+  SSA_PHI     // value at a join point, one argument per incoming edge
+};
+
+struct PhiArg {
+  size_t value;
+  size_t edge;
+};
+
+/* an SSA name: one per definition of a variable */
+struct Value {
+  enum ValueKind kind;
+  size_t var;
+  size_t block;
+
+  const ASTNode *rhs;   // SSA_DEF
+  long copy_of;         // SSA_DEF of the form x = y: the value of y, -1 otherwise
+
+  struct PhiArg *args;  // SSA_PHI
+  size_t n_args;
+
+  size_t *users;        // values computed from this one
+  size_t n_users;
+  size_t *branches;     // blocks whose condition reads it
+  size_t n_branches;
+
+  struct Lattice lat;
+};
+
+enum TermKind {
+  TERM_NONE,   // return or end of the method
+  TERM_GOTO,   // succ[0]
+  TERM_BRANCH  // succ[0] if cond holds, succ[1] otherwise
+};
+
+struct Block {
+  size_t *values;  // φ-nodes, then definitions in order
+  size_t n_values;
+
+  enum TermKind term;
+  const ASTNode *cond;
+  size_t succ[2];
+
+  int executable;
+};
+
+struct Edge {
+  size_t from;
+  size_t to;
+  int executable;
+};
+
+/* an identifier read and the SSA name it reads */
+struct Use {
+  ASTNode *node;
+  size_t value;
+  size_t block;
+  const char *copy;  // variable holding the same value at this point, or NULL
+};
+
+struct Method {
+  const char **vars;  // parameters, then locals
+  size_t n_vars;
+
+  struct Value *values;
+  size_t n_values;
+
+  struct Block *blocks;
+  size_t n_blocks;
+
+  struct Edge *edges;
+  size_t n_edges;
+
+  struct Use *uses;
+  size_t n_uses;
+};
+
+/* renaming state at one point of the method body */
+struct State {
+  size_t *cur;   // current SSA name of each variable
+  size_t block;
+  int live;      // control may reach this point
+};
+
+struct Break {
+  size_t block;
+  size_t *cur;
+};
+
+/* the innermost while around the statement being renamed */
+struct Loop {
+  struct Break *breaks;
+  size_t n_breaks;
+};
+
+static int add_index(size_t **array, size_t *n, size_t index) {
+  size_t *a = realloc(*array, (*n + 1) * sizeof(size_t));
+  if (a == NULL) return -1;
+
+  *array = a;
+  (*array)[(*n)++] = index;
+  return 0;
+}
+
+static long var_index(const struct Method *m, const char *name) {
+  for (size_t k = 0 ; k < m->n_vars ; k++) {
+    if (strcmp(m->vars[k], name) == 0) return (long)k;
+  }
+
+  return -1;
+}
+
+static int add_var(struct Method *m, const char *name) {
+  const char **vars = realloc(m->vars, (m->n_vars + 1) * sizeof(const char *));
+  if (vars == NULL) return -1;
+
+  m->vars = vars;
+  m->vars[m->n_vars++] = name;
+  return 0;
+}
+
+static long new_block(struct Method *m) {
+  struct Block *blocks = realloc(m->blocks, (m->n_blocks + 1) * sizeof(struct Block));
+  if (blocks == NULL) return -1;
+
+  m->blocks = blocks;
+  memset(&m->blocks[m->n_blocks], 0, sizeof(struct Block));
+  return (long)m->n_blocks++;
+}
+
+static long new_edge(struct Method *m, size_t from, size_t to) {
+  struct Edge *edges = realloc(m->edges, (m->n_edges + 1) * sizeof(struct Edge));
+  if (edges == NULL) return -1;
+
+  m->edges = edges;
+  m->edges[m->n_edges] = (struct Edge) { from, to, 0 };
+  return (long)m->n_edges++;
+}
+
+/* end the block with a jump to `to` */
+static long goto_block(struct Method *m, size_t from, size_t to) {
+  long e = new_edge(m, from, to);
+  if (e < 0) return -1;
+
+  m->blocks[from].term = TERM_GOTO;
+  m->blocks[from].succ[0] = (size_t)e;
+  return e;
+}
+
+static long new_value(struct Method *m, enum ValueKind kind, size_t var, size_t block) {
+  struct Value *values = realloc(m->values, (m->n_values + 1) * sizeof(struct Value));
+  if (values == NULL) return -1;
+
+  m->values = values;
+
+  struct Value *v = &m->values[m->n_values];
+  memset(v, 0, sizeof(struct Value));
+  v->kind = kind;
+  v->var = var;
+  v->block = block;
+  v->copy_of = -1;
+  v->lat.kind = LAT_TOP;
+
+  if (add_index(&m->blocks[block].values, &m->blocks[block].n_values, m->n_values)) {
+    return -1;
+  }
+
+  return (long)m->n_values++;
+}
+
+static int add_phi_arg(struct Method *m, size_t phi, size_t value, size_t edge) {
+  struct Value *v = &m->values[phi];
+  struct PhiArg *args = realloc(v->args, (v->n_args + 1) * sizeof(struct PhiArg));
+  if (args == NULL) return -1;
+
+  v->args = args;
+  v->args[v->n_args++] = (struct PhiArg) { value, edge };
+  return add_index(&m->values[value].users, &m->values[value].n_users, phi);
+}
+
+static size_t *copy_cur(const struct Method *m, const size_t *cur) {
+  size_t *c = malloc((m->n_vars + 1) * sizeof(size_t));
+  if (c != NULL) memcpy(c, cur, m->n_vars * sizeof(size_t));
+
+  return c;
+}
+
+/* the variable that, at the point described by s, still holds the value
+   v was copied from (following chains of copies) */
+static const char *copy_source(const struct Method *m, const struct State *s, size_t v) {
+  const char *name = NULL;
+
+  while (m->values[v].kind == SSA_DEF && m->values[v].copy_of >= 0) {
+    size_t src = (size_t)m->values[v].copy_of;
+    if (s->cur[m->values[src].var] != src) break;
+
+    name = m->vars[m->values[src].var];
+    v = src;
+  }
+
+  return name;
+}
+
+/* record the SSA name read by each identifier in e and who reads it:
+   the value `user` or the condition of block `branch` (-1 for neither) */
+static int rename_expr(struct Method *m, const struct State *s, ASTNode *e,
+                       long user, long branch) {
+  switch (e->kind) {
+    case N_IDENTIFIER: {
+      long var = var_index(m, e->identifier.name);
+      if (var < 0) return 0;
+
+      size_t v = s->cur[var];
+
+      struct Use *uses = realloc(m->uses, (m->n_uses + 1) * sizeof(struct Use));
+      if (uses == NULL) return -1;
+
+      m->uses = uses;
+      m->uses[m->n_uses++] = (struct Use) { e, v, s->block, copy_source(m, s, v) };
+
+      struct Value *val = &m->values[v];
+      if (user >= 0 && add_index(&val->users, &val->n_users, (size_t)user)) return -1;
+      if (branch >= 0 && add_index(&val->branches, &val->n_branches, (size_t)branch)) {
+        return -1;
+      }
+      return 0;
+    }
+
+    case N_UNARY:
+      return rename_expr(m, s, e->unary.expr, user, branch);
+
+    case N_BINOP:
+      if (rename_expr(m, s, e->binop.lhs, user, branch)) return -1;
+      return rename_expr(m, s, e->binop.rhs, user, branch);
+
+    case N_CALL:
+      for (ASTList *l = e->call.args ; l != NULL ; l = l->list) {
+        if (rename_expr(m, s, l->node, user, branch)) return -1;
+      }
+      return 0;
+
+    default:
+      return 0;
+  }
+}
+
+static int rename_def(struct Method *m, struct State *s, const char *name, ASTNode *rhs) {
+  long var = var_index(m, name);
+  if (var < 0) return 0;
+
+  long v = new_value(m, SSA_DEF, (size_t)var, s->block);
+  if (v < 0) return -1;
+
+  m->values[v].rhs = rhs;
+  if (rhs->kind == N_IDENTIFIER) {
+    long src = var_index(m, rhs->identifier.name);
+    if (src >= 0) m->values[v].copy_of = (long)s->cur[src];
+  }
+
+  if (rename_expr(m, s, rhs, v, -1)) return -1;
+
+  s->cur[var] = (size_t)v;
+  return 0;
+}
+
+/* mark the variables assigned anywhere in n */
+static void collect_assigned(const struct Method *m, const ASTNode *n, char *assigned) {
+  if (n == NULL) return;
+
+  switch (n->kind) {
+    case N_BLOCK:
+      for (const ASTList *l = n->block.stmts ; l != NULL ; l = l->list) {
+        collect_assigned(m, l->node, assigned);
+      }
+      return;
+
+    case N_ASSIGN: {
+      long var = var_index(m, n->assign.location);
+      if (var >= 0) assigned[var] = 1;
+      return;
+    }
+
+    case N_IF:
+    case N_WHILE:
+      collect_assigned(m, n->branch.then_branch, assigned);
+      collect_assigned(m, n->branch.else_branch, assigned);
+      return;
+
+    default:
+      return;
+  }
+}
+
+/* continue in block j, reached from each of the n live states through
+   edges[k], with a φ-node for every variable whose SSA name differs
+   between them */
+static int join_into(struct Method *m, struct State *s, const struct State *preds,
+                     const size_t *edges, size_t n, size_t j) {
+  const struct State *live = NULL;
+
+  for (size_t k = 0 ; k < n ; k++) {
+    if (preds[k].live) live = &preds[k];
+  }
+
+  for (size_t var = 0 ; var < m->n_vars ; var++) {
+    size_t first = live->cur[var];
+    int same = 1;
+
+    for (size_t k = 0 ; k < n ; k++) {
+      if (preds[k].live && preds[k].cur[var] != first) same = 0;
+    }
+
+    if (same) {
+      s->cur[var] = first;
+      continue;
+    }
+
+    long phi = new_value(m, SSA_PHI, var, j);
+    if (phi < 0) return -1;
+
+    for (size_t k = 0 ; k < n ; k++) {
+      if (preds[k].live && add_phi_arg(m, (size_t)phi, preds[k].cur[var], edges[k])) {
+        return -1;
+      }
+    }
+    s->cur[var] = (size_t)phi;
+  }
+
+  s->block = j;
+  s->live = 1;
+  return 0;
+}
+
+/* continue after the n states, in a new block if more than one is live */
+static int join(struct Method *m, struct State *s, const struct State *preds, size_t n) {
+  size_t n_live = 0;
+  const struct State *live = NULL;
+
+  for (size_t k = 0 ; k < n ; k++) {
+    if (preds[k].live) {
+      n_live += 1;
+      live = &preds[k];
+    }
+  }
+
+  if (n_live == 0) {
+    s->live = 0;
+    return 0;
+  }
+
+  if (n_live == 1) {
+    memcpy(s->cur, live->cur, m->n_vars * sizeof(size_t));
+    s->block = live->block;
+    s->live = 1;
+    return 0;
+  }
+
+  long j = new_block(m);
+  if (j < 0) return -1;
+
+  size_t *edges = malloc(n * sizeof(size_t));
+  if (edges == NULL) return -1;
+
+  int status = 0;
+  for (size_t k = 0 ; k < n && status == 0 ; k++) {
+    if (!preds[k].live) continue;
+
+    long e = goto_block(m, preds[k].block, (size_t)j);
+    if (e < 0) status = -1;
+    edges[k] = (size_t)e;
+  }
+
+  if (status == 0) status = join_into(m, s, preds, edges, n, (size_t)j);
+
+  free(edges);
+  return status;
+}
+
+static int rename_stmt(struct Method *m, struct State *s, struct Loop *loop, ASTNode *n);
+
+static int rename_if(struct Method *m, struct State *s, struct Loop *loop, ASTNode *n) {
+  if (rename_expr(m, s, n->branch.cond, -1, (long)s->block)) return -1;
+
+  long bt = new_block(m);
+  long bf = new_block(m);
+  if (bt < 0 || bf < 0) return -1;
+
+  long et = new_edge(m, s->block, (size_t)bt);
+  long ef = new_edge(m, s->block, (size_t)bf);
+  if (et < 0 || ef < 0) return -1;
+
+  struct Block *b = &m->blocks[s->block];
+  b->term = TERM_BRANCH;
+  b->cond = n->branch.cond;
+  b->succ[0] = (size_t)et;
+  b->succ[1] = (size_t)ef;
+
+  struct State arms[2] = {
+    { copy_cur(m, s->cur), (size_t)bt, 1 },
+    { copy_cur(m, s->cur), (size_t)bf, 1 }
+  };
+
+  int status = -1;
+  if (arms[0].cur != NULL && arms[1].cur != NULL
+      && rename_stmt(m, &arms[0], loop, n->branch.then_branch) == 0
+      && rename_stmt(m, &arms[1], loop, n->branch.else_branch) == 0) {
+    status = join(m, s, arms, 2);
+  }
+
+  free(arms[0].cur);
+  free(arms[1].cur);
+  return status;
+}
+
+static int rename_while(struct Method *m, struct State *s, ASTNode *n) {
+  char *assigned = calloc(m->n_vars + 1, 1);
+  if (assigned == NULL) return -1;
+
+  collect_assigned(m, n->branch.then_branch, assigned);
+
+  struct Loop loop = { NULL, 0 };
+  struct State body = { NULL, 0, 1 };
+  struct State *exits = NULL;
+  size_t *edges = NULL;
+  size_t *phis = calloc(m->n_vars + 1, sizeof(size_t));
+  int status = -1;
+
+  if (phis == NULL) goto done;
+
+  // header: a φ-node for each variable the body assigns
+  long h = new_block(m);
+  if (h < 0) goto done;
+
+  long entry = goto_block(m, s->block, (size_t)h);
+  if (entry < 0) goto done;
+
+  for (size_t var = 0 ; var < m->n_vars ; var++) {
+    if (!assigned[var]) continue;
+
+    long phi = new_value(m, SSA_PHI, var, (size_t)h);
+    if (phi < 0 || add_phi_arg(m, (size_t)phi, s->cur[var], (size_t)entry)) goto done;
+
+    phis[var] = (size_t)phi;
+    s->cur[var] = (size_t)phi;
+  }
+  s->block = (size_t)h;
+
+  if (rename_expr(m, s, n->branch.cond, -1, h)) goto done;
+
+  long bb = new_block(m);
+  long x = new_block(m);
+  if (bb < 0 || x < 0) goto done;
+
+  long et = new_edge(m, (size_t)h, (size_t)bb);
+  long ef = new_edge(m, (size_t)h, (size_t)x);
+  if (et < 0 || ef < 0) goto done;
+
+  m->blocks[h].term = TERM_BRANCH;
+  m->blocks[h].cond = n->branch.cond;
+  m->blocks[h].succ[0] = (size_t)et;
+  m->blocks[h].succ[1] = (size_t)ef;
+
+  body.cur = copy_cur(m, s->cur);
+  body.block = (size_t)bb;
+  if (body.cur == NULL) goto done;
+
+  if (rename_stmt(m, &body, &loop, n->branch.then_branch)) goto done;
+
+  // back edge: the values at the end of the body flow into the header
+  if (body.live) {
+    long back = goto_block(m, body.block, (size_t)h);
+    if (back < 0) goto done;
+
+    for (size_t var = 0 ; var < m->n_vars ; var++) {
+      if (assigned[var] && add_phi_arg(m, phis[var], body.cur[var], (size_t)back)) {
+        goto done;
+      }
+    }
+  }
+
+  // exit: reached when the condition fails and from every break
+  exits = calloc(loop.n_breaks + 1, sizeof(struct State));
+  edges = malloc((loop.n_breaks + 1) * sizeof(size_t));
+  if (exits == NULL || edges == NULL) goto done;
+
+  exits[0] = (struct State) { copy_cur(m, s->cur), (size_t)h, 1 };
+  edges[0] = (size_t)ef;
+  if (exits[0].cur == NULL) goto done;
+
+  for (size_t k = 0 ; k < loop.n_breaks ; k++) {
+    long e = goto_block(m, loop.breaks[k].block, (size_t)x);
+    if (e < 0) goto done;
+
+    exits[k + 1] = (struct State) { loop.breaks[k].cur, loop.breaks[k].block, 1 };
+    edges[k + 1] = (size_t)e;
+  }
+
+  status = join_into(m, s, exits, edges, loop.n_breaks + 1, (size_t)x);
+
+done:
+  for (size_t k = 0 ; k < loop.n_breaks ; k++) free(loop.breaks[k].cur);
+  free(loop.breaks);
+  if (exits != NULL) free(exits[0].cur);
+  free(exits);
+  free(edges);
+  free(body.cur);
+  free(phis);
+  free(assigned);
+  return status;
+}
+
+static int rename_stmt(struct Method *m, struct State *s, struct Loop *loop, ASTNode *n) {
+  if (n == NULL || !s->live) return 0;
+
+  switch (n->kind) {
+    case N_BLOCK:
+      for (ASTList *l = n->block.stmts ; l != NULL && s->live ; l = l->list) {
+        if (rename_stmt(m, s, loop, l->node)) return -1;
+      }
+      return 0;
+
+    case N_ASSIGN:
+      return rename_def(m, s, n->assign.location, n->assign.rhs);
+
+    case N_IF:
+      return rename_if(m, s, loop, n);
+
+    case N_WHILE:
+      return rename_while(m, s, n);
+
+    case N_RETURN:
+      if (n->ret.expr != NULL && rename_expr(m, s, n->ret.expr, -1, -1)) return -1;
+      s->live = 0;
+      return 0;
+
+    case N_BREAK: {
+      if (loop == NULL) return 0;
+
+      struct Break *breaks = realloc(loop->breaks, (loop->n_breaks + 1) * sizeof(struct Break));
+      if (breaks == NULL) return -1;
+
+      loop->breaks = breaks;
+      loop->breaks[loop->n_breaks].block = s->block;
+      loop->breaks[loop->n_breaks].cur = copy_cur(m, s->cur);
+      if (loop->breaks[loop->n_breaks++].cur == NULL) return -1;
+
+      s->live = 0;
+      return 0;
+    }
+
+    default:
+      return 0;
+  }
+}
+
+static int use_cmp(const void *a, const void *b) {
+  const ASTNode *x = ((const struct Use *)a)->node;
+  const ASTNode *y = ((const struct Use *)b)->node;
+
+  return (x > y) - (x < y);
+}
+
+static const struct Use *find_use(const struct Method *m, const ASTNode *node) {
+  struct Use key = { (ASTNode *)node, 0, 0, NULL };
+
+  return bsearch(&key, m->uses, m->n_uses, sizeof(struct Use), use_cmp);
+}
+
+static struct Lattice lat_meet(struct Lattice a, struct Lattice b) {
+  if (a.kind == LAT_TOP) return b;
+  if (b.kind == LAT_TOP) return a;
+  if (a.kind == LAT_CONST && b.kind == LAT_CONST && a.c == b.c) return a;
+
+  return (struct Lattice) { LAT_BOTTOM, 0 };
+}
+
+/* the value of e given the values currently known for the SSA names it
+   reads; calls are left to run time */
+static struct Lattice lat_expr(const struct Method *m, const ASTNode *e) {
+  const struct Lattice bottom = { LAT_BOTTOM, 0 };
+
+  switch (e->kind) {
+    case N_NUMBER:
+      return (struct Lattice) { LAT_CONST, mix_word_wrap(e->number.val) };
+
+    case N_IDENTIFIER: {
+      const struct Use *u = find_use(m, e);
+      return (u == NULL) ? bottom : m->values[u->value].lat;
+    }
+
+    case N_UNARY: {
+      struct Lattice a = lat_expr(m, e->unary.expr);
+      if (a.kind == LAT_CONST && e->unary.op == OP_ADDOP_SUB) a.c = -a.c;
+      return a;
+    }
+
+    case N_BINOP: {
+      struct Lattice a = lat_expr(m, e->binop.lhs);
+      struct Lattice b = lat_expr(m, e->binop.rhs);
+
+      if (a.kind == LAT_BOTTOM || b.kind == LAT_BOTTOM) return bottom;
+      if (a.kind == LAT_TOP || b.kind == LAT_TOP) return a.kind == LAT_TOP ? a : b;
+
+      long long v;
+      switch (e->binop.op) {
+        case OP_RELOP_LEQ: v = a.c <= b.c; break;
+        case OP_RELOP_LT:  v = a.c < b.c; break;
+        case OP_RELOP_GT:  v = a.c > b.c; break;
+        case OP_RELOP_GEQ: v = a.c >= b.c; break;
+        case OP_RELOP_EQ:  v = a.c == b.c; break;
+        case OP_RELOP_NEQ: v = a.c != b.c; break;
+        case OP_ADDOP_ADD: v = mix_word_wrap(a.c + b.c); break;
+        case OP_ADDOP_SUB: v = mix_word_wrap(a.c - b.c); break;
+        case OP_MULOP_MUL: v = mix_word_wrap(a.c * b.c); break;
+
+        case OP_MULOP_DIV:
+          // left to run time, like fold_ast does
+          if (b.c == 0) return bottom;
+          v = a.c / b.c;
+          break;
+
+        default:
+          return bottom;
+      }
+      return (struct Lattice) { LAT_CONST, v };
+    }
+
+    default:
+      return bottom;
+  }
+}
+
+/* worklists of the propagation: CFG edges found executable and SSA names
+   whose value went down the lattice */
+struct Work {
+  size_t *edges;
+  size_t n_edges;
+  size_t *values;
+  size_t n_values;
+};
+
+static int visit_value(struct Method *m, struct Work *w, size_t v) {
+  struct Value *val = &m->values[v];
+  struct Lattice lat = { LAT_BOTTOM, 0 };
+
+  switch (val->kind) {
+    case SSA_DEF:
+      lat = lat_expr(m, val->rhs);
+      break;
+
+    case SSA_PHI:
+      // only the edges known to be taken contribute
+      lat.kind = LAT_TOP;
+      for (size_t k = 0 ; k < val->n_args ; k++) {
+        if (m->edges[val->args[k].edge].executable) {
+          lat = lat_meet(lat, m->values[val->args[k].value].lat);
+        }
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  lat = lat_meet(val->lat, lat);
+  if (lat.kind == val->lat.kind && lat.c == val->lat.c) return 0;
+
+  val->lat = lat;
+  return add_index(&w->values, &w->n_values, v);
+}
+
+static int visit_branch(struct Method *m, struct Work *w, size_t b) {
+  const struct Block *block = &m->blocks[b];
+
+  switch (block->term) {
+    case TERM_GOTO:
+      return add_index(&w->edges, &w->n_edges, block->succ[0]);
+
+    case TERM_BRANCH: {
+      struct Lattice c = lat_expr(m, block->cond);
+
+      if (c.kind == LAT_TOP) return 0;
+      if (c.kind == LAT_CONST) {
+        return add_index(&w->edges, &w->n_edges, block->succ[c.c ? 0 : 1]);
+      }
+
+      if (add_index(&w->edges, &w->n_edges, block->succ[0])) return -1;
+      return add_index(&w->edges, &w->n_edges, block->succ[1]);
+    }
+
+    default:
+      return 0;
+  }
+}
+
+static int visit_block(struct Method *m, struct Work *w, size_t b) {
+  for (size_t k = 0 ; k < m->blocks[b].n_values ; k++) {
+    if (visit_value(m, w, m->blocks[b].values[k])) return -1;
+  }
+
+  return visit_branch(m, w, b);
+}
+
+/* sparse conditional constant propagation: values start unknown and only
+   the blocks reached through edges found executable are evaluated */
+static int propagate(struct Method *m) {
+  struct Work w = { NULL, 0, NULL, 0 };
+  int status = 0;
+
+  m->blocks[0].executable = 1;
+  status = visit_block(m, &w, 0);
+
+  while (status == 0 && (w.n_edges > 0 || w.n_values > 0)) {
+    if (w.n_edges > 0) {
+      struct Edge *e = &m->edges[w.edges[--w.n_edges]];
+      if (e->executable) continue;
+
+      e->executable = 1;
+      struct Block *to = &m->blocks[e->to];
+
+      if (!to->executable) {
+        to->executable = 1;
+        status = visit_block(m, &w, e->to);
+        continue;
+      }
+
+      // a new incoming edge only changes the φ-nodes
+      for (size_t k = 0 ; k < to->n_values && status == 0 ; k++) {
+        if (m->values[to->values[k]].kind == SSA_PHI) {
+          status = visit_value(m, &w, to->values[k]);
+        }
+      }
+      continue;
+    }
+
+    const struct Value *val = &m->values[w.values[--w.n_values]];
+
+    for (size_t k = 0 ; k < val->n_users && status == 0 ; k++) {
+      size_t u = val->users[k];
+      if (m->blocks[m->values[u].block].executable) status = visit_value(m, &w, u);
+    }
+
+    for (size_t k = 0 ; k < val->n_branches && status == 0 ; k++) {
+      size_t b = val->branches[k];
+      if (m->blocks[b].executable) status = visit_branch(m, &w, b);
+    }
+  }
+
+  free(w.edges);
+  free(w.values);
+  return status;
+}
+
+/* replace the reads of constants by the constant and the reads of copies
+   by the variable copied, wherever control may reach */
+static int rewrite(struct Method *m) {
+  for (size_t k = 0 ; k < m->n_uses ; k++) {
+    const struct Use *u = &m->uses[k];
+    const struct Value *val = &m->values[u->value];
+
+    if (!m->blocks[u->block].executable) continue;
+
+    if (val->lat.kind == LAT_CONST) {
+      free(u->node->identifier.name);
+      u->node->kind = N_NUMBER;
+      u->node->number.val = (int)val->lat.c;
+    } else if (u->copy != NULL) {
+      char *name = strdup(u->copy);
+      if (name == NULL) return -1;
+
+      free(u->node->identifier.name);
+      u->node->identifier.name = name;
+    }
+  }
+
+  return 0;
+}
+
+static void method_free(struct Method *m) {
+  for (size_t k = 0 ; k < m->n_values ; k++) {
+    free(m->values[k].args);
+    free(m->values[k].users);
+    free(m->values[k].branches);
+  }
+  for (size_t k = 0 ; k < m->n_blocks ; k++) free(m->blocks[k].values);
+
+  free(m->vars);
+  free(m->values);
+  free(m->blocks);
+  free(m->edges);
+  free(m->uses);
+}
+
+static int sccp_method(ASTNode *method) {
+  struct Method m = { 0 };
+  struct State s = { NULL, 0, 1 };
+  ASTNode *body = method->method.body;
+  int status = -1;
+
+  for (ASTList *l = method->method.params ; l != NULL ; l = l->list) {
+    if (add_var(&m, l->node->param.name)) goto done;
+  }
+  size_t n_params = m.n_vars;
+
+  for (ASTList *d = body->body.decls ; d != NULL ; d = d->list) {
+    for (ASTList *v = d->node->decl.vars ; v != NULL ; v = v->list) {
+      if (add_var(&m, v->node->var.name)) goto done;
+    }
+  }
+
+  if (new_block(&m) < 0) goto done;
+
+  s.cur = calloc(m.n_vars + 1, sizeof(size_t));
+  if (s.cur == NULL) goto done;
+
+  // entry: the parameters hold the arguments and the locals nothing yet
+  for (size_t var = 0 ; var < m.n_vars ; var++) {
+    long v = new_value(&m, var < n_params ? SSA_PARAM : SSA_UNDEF, var, 0);
+    if (v < 0) goto done;
+
+    s.cur[var] = (size_t)v;
+  }
+
+  for (ASTList *d = body->body.decls ; d != NULL ; d = d->list) {
+    for (ASTList *v = d->node->decl.vars ; v != NULL ; v = v->list) {
+      ASTNode *var = v->node;
+      if (var->var.expr != NULL && rename_def(&m, &s, var->var.name, var->var.expr)) {
+        goto done;
+      }
+    }
+  }
+
+  for (ASTList *l = body->body.stmts ; l != NULL && s.live ; l = l->list) {
+    if (rename_stmt(&m, &s, NULL, l->node)) goto done;
+  }
+
+  // uses is NULL when the method reads no variable
+  if (m.n_uses > 0) qsort(m.uses, m.n_uses, sizeof(struct Use), use_cmp);
+
+  if (propagate(&m) == 0) status = rewrite(&m);
+
+done:
+  free(s.cur);
+  method_free(&m);
+  return status;
+}
+
+int sccp_ast(ASTNode *root) {
+  if (root == NULL || root->kind != N_PROGRAM) return -1;
+
+  for (ASTList *l = root->prog.methods ; l != NULL ; l = l->list) {
+    if (sccp_method(l->node)) return -1;
+  }
+
+  // the conditions now constant select their branch
+  return fold_ast(root);
+}
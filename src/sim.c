@@ -0,0 +1,927 @@
+#include "sim.h"
+#include "sim_prof.h"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define UNIT_CARD_READER 16
+#define UNIT_CARD_PUNCH 17
+#define UNIT_PRINTER 18
+#define UNIT_TTY 19
+
+const char mix_chars[] =
+  " ABCDEFGHI~JKLMNOPQR[#STUVWXYZ0123456789.,()+-*/=$<>@;:'";
+
+// execution time of each operation code and field, from the timing table
+static unsigned char op_time[64][64];
+
+static void init_op_time(void) {
+  for (unsigned int c = 0 ; c < 64 ; c++) {
+    for (unsigned int f = 0 ; f < 64 ; f++) {
+      op_time[c][f] = (unsigned char)mix_opcode_time(mix_opcode_decode(c, f), f);
+    }
+  }
+}
+
+static void sim_fail(MixMachine *m, const char *fmt, ...) {
+  va_list args;
+
+  va_start(args, fmt);
+  vsnprintf(m->error, sizeof(m->error), fmt, args);
+  va_end(args);
+
+  m->status = SIM_ERROR;
+}
+
+/* contents of field (L:R) of word, as a signed word */
+static MixWord field_get(MixWord w, int l, int r) {
+  MixWord sign = 0;
+
+  if (l == 0) {
+    sign = w & WORD_SIGN;
+    l = 1;
+  }
+  if (r < l) return sign;
+
+  MixWord mag = (w & WORD_MAG) >> (6 * (5 - r));
+  mag &= ((MixWord)1 << (6 * (r - l + 1))) - 1;
+
+  return sign | mag;
+}
+
+/* store the rightmost bytes of src into field (L:R) of dst */
+static MixWord field_set(MixWord dst, MixWord src, int l, int r) {
+  if (l == 0) {
+    dst = (dst & ~WORD_SIGN) | (src & WORD_SIGN);
+    l = 1;
+  }
+  if (r < l) return dst;
+
+  int width = 6 * (r - l + 1);
+  int shift = 6 * (5 - r);
+  MixWord mask = (((MixWord)1 << width) - 1) << shift;
+
+  return (dst & ~mask) | (((src & WORD_MAG) << shift) & mask);
+}
+
+static int valid_field(int f) {
+  return f / 8 <= f % 8 && f % 8 <= 5;
+}
+
+static void set_overflow(MixMachine *m) {
+  m->overflow = 1;
+  m->overflows += 1;
+}
+
+/* rA/rX style addition with overflow, returns the new register contents */
+static MixWord word_add(MixMachine *m, MixWord reg, long long v) {
+  long long sum = word_value(reg) + v;
+  int negative = sum < 0;
+  unsigned long long mag = (unsigned long long)(negative ? -sum : sum);
+
+  if (mag > WORD_MAG) set_overflow(m);
+  if (sum == 0) negative = (reg & WORD_SIGN) != 0;
+
+  return word_from(negative, mag);
+}
+
+static MixWord index_set(MixMachine *m, long long v, int negative) {
+  unsigned long long mag = (unsigned long long)(v < 0 ? -v : v);
+
+  if (mag > INDEX_MAG) {
+    sim_fail(m, "index register overflow at %u", m->pc);
+    return 0;
+  }
+  return word_from(v != 0 ? v < 0 : negative, mag);
+}
+
+static void store_word(MixMachine *m, unsigned int address, MixWord w) {
+  const MixProgram *p = m->prog;
+
+  m->mem[address] = w;
+
+  // the word, and a superinstruction that ends with it, are decoded again
+  m->code[address].handler = NULL;
+  if (address > 0) m->code[address - 1].handler = NULL;
+
+  if (p != NULL && address < m->stack_limit && (int)address > m->stack_high_water) {
+    m->stack_high_water = (int)address;
+  }
+}
+
+/* contents of rA (or rX) after ENTA (ENNA is enter(-addr, !negative)) */
+static MixWord enter(long long addr, int negative) {
+  return word_from(addr != 0 ? addr < 0 : negative, (uint64_t)(addr < 0 ? -addr : addr));
+}
+
+static void multiply(MixMachine *m, MixWord v) {
+  int negative = ((m->rA ^ v) & WORD_SIGN) != 0;
+  uint64_t product = (uint64_t)(m->rA & WORD_MAG) * (uint64_t)(v & WORD_MAG);
+
+  m->rA = word_from(negative, product >> 30);
+  m->rX = word_from(negative, product & WORD_MAG);
+}
+
+static void divide(MixMachine *m, MixWord v) {
+  uint64_t divisor = v & WORD_MAG;
+  uint64_t high = m->rA & WORD_MAG;
+  int sign_a = (m->rA & WORD_SIGN) != 0;
+
+  if (divisor == 0 || high >= divisor) {
+    set_overflow(m);
+    return;
+  }
+
+  uint64_t dividend = (high << 30) | (m->rX & WORD_MAG);
+  m->rA = word_from(sign_a != ((v & WORD_SIGN) != 0), dividend / divisor);
+  m->rX = word_from(sign_a, dividend % divisor);
+}
+
+static int compare(MixWord lhs, MixWord rhs, int l, int r) {
+  long long a = word_value(field_get(lhs, l, r));
+  long long b = word_value(field_get(rhs, l, r));
+
+  return (a < b) ? -1 : (a > b) ? 1 : 0;
+}
+
+static void output_block(MixMachine *m, unsigned int address, unsigned int words) {
+  for (unsigned int i = 0 ; i < words ; i++) {
+    MixWord w = m->mem[(address + i) % MIX_MEMORY_SIZE];
+    for (int b = 4 ; b >= 0 ; b--) {
+      unsigned int code = (w >> (6 * b)) & 63;
+      char c = code < sizeof(mix_chars) - 1 ? mix_chars[code] : '?';
+      if (m->output_len < SIM_OUTPUT_LEN - 2) m->output[m->output_len++] = c;
+    }
+  }
+
+  // trailing blanks are not significant on line devices
+  while (m->output_len > 0 && m->output[m->output_len - 1] == ' ') m->output_len--;
+  m->output[m->output_len++] = '\n';
+  m->output[m->output_len] = '\0';
+}
+
+static int jump_condition(MixMachine *m, MixWord reg, int f) {
+  long long v = word_value(reg);
+
+  switch (f) {
+    case 0: return v < 0;   // N
+    case 1: return v == 0;  // Z
+    case 2: return v > 0;   // P
+    case 3: return v >= 0;  // NN
+    case 4: return v != 0;  // NZ
+    case 5: return v <= 0;  // NP
+  }
+
+  sim_fail(m, "invalid jump variant %d at %u", f, m->pc);
+  return 0;
+}
+
+void sim_load(MixMachine *m, const MixProgram *prog) {
+  static pthread_once_t op_time_once = PTHREAD_ONCE_INIT;
+
+  // machines are loaded by the threads of sim_batch too
+  pthread_once(&op_time_once, init_op_time);
+  memset(m, 0, sizeof(*m));
+
+  memcpy(m->mem, prog->mem, sizeof(m->mem));
+  m->prog = prog;
+  m->pc = prog->start;
+  m->status = SIM_HALTED;
+  m->stack_high_water = -1;
+
+  // the region below the lowest loaded word is free for the stack
+  m->stack_limit = MIX_MEMORY_SIZE;
+  for (unsigned int i = 0 ; i < MIX_MEMORY_SIZE ; i++) {
+    if (prog->loaded[i]) {
+      m->stack_limit = i;
+      break;
+    }
+  }
+}
+
+/* execute the instruction at m->pc, 1 when the machine halts or fails */
+static int step(MixMachine *m) {
+  if (m->pc >= MIX_MEMORY_SIZE) {
+    sim_fail(m, "program counter out of range: %u", m->pc);
+    return 1;
+  }
+
+  MixWord inst = m->mem[m->pc];
+  int c = inst & 63;
+  int f = (inst >> 6) & 63;
+  int i = (inst >> 12) & 63;
+  long long a = (inst >> 18) & INDEX_MAG;
+  if (inst & WORD_SIGN) a = -a;
+
+  if (i > 6) {
+    sim_fail(m, "invalid index register %d at %u", i, m->pc);
+    return 1;
+  }
+
+  long long addr = a + (i ? word_value(m->rI[i]) : 0);
+  unsigned int next = m->pc + 1;
+  int l = f / 8, r = f % 8;
+
+  int needs_memory = (c >= 1 && c <= 4) || (c >= 7 && c <= 33)
+                  || c == 36 || c == 37 || c >= 56;
+  if (needs_memory && (addr < 0 || addr >= MIX_MEMORY_SIZE)) {
+    sim_fail(m, "invalid address %lld at %u", addr, m->pc);
+    return 1;
+  }
+  if (((c >= 1 && c <= 4) || (c >= 8 && c <= 33) || c >= 56) && !valid_field(f)) {
+    sim_fail(m, "invalid field (%d:%d) at %u", l, r, m->pc);
+    return 1;
+  }
+
+  MixWord *reg = NULL;
+  unsigned int ticks = op_time[c][f];
+
+  switch (c) {
+    case 0: // NOP
+      break;
+
+    case 1: // ADD
+    case 2: // SUB
+    {
+      long long v = word_value(field_get(m->mem[addr], l, r));
+      m->rA = word_add(m, m->rA, c == 1 ? v : -v);
+      break;
+    }
+
+    case 3: // MUL
+      multiply(m, field_get(m->mem[addr], l, r));
+      break;
+
+    case 4: // DIV
+      divide(m, field_get(m->mem[addr], l, r));
+      break;
+
+    case 5: // NUM, CHAR, HLT
+      if (f == 0) {
+        uint64_t n = 0;
+        for (int b = 4 ; b >= 0 ; b--) n = n * 10 + ((m->rA >> (6 * b)) & 63) % 10;
+        for (int b = 4 ; b >= 0 ; b--) n = n * 10 + ((m->rX >> (6 * b)) & 63) % 10;
+        if (n > WORD_MAG) set_overflow(m);
+        m->rA = (m->rA & WORD_SIGN) | (MixWord)(n & WORD_MAG);
+      } else if (f == 1) {
+        uint64_t n = m->rA & WORD_MAG;
+        MixWord hi = 0, lo = 0;
+        for (int b = 0 ; b < 5 ; b++) {
+          lo |= (MixWord)(30 + n % 10) << (6 * b);
+          n /= 10;
+        }
+        for (int b = 0 ; b < 5 ; b++) {
+          hi |= (MixWord)(30 + n % 10) << (6 * b);
+          n /= 10;
+        }
+        m->rA = (m->rA & WORD_SIGN) | hi;
+        m->rX = (m->rX & WORD_SIGN) | lo;
+      } else if (f == 2) {
+        if (m->profile) sim_profile_step(m->profile, m, next, ticks);
+        m->cycles += ticks;
+        m->instructions += 1;
+        m->pc = next;
+        m->status = SIM_HALTED;
+        return 1;
+      } else {
+        sim_fail(m, "invalid special operation %d at %u", f, m->pc);
+      }
+      break;
+
+    case 6: // shifts
+    {
+      if (addr < 0) {
+        sim_fail(m, "negative shift at %u", m->pc);
+        break;
+      }
+      uint64_t ax = ((uint64_t)(m->rA & WORD_MAG) << 30) | (m->rX & WORD_MAG);
+      uint64_t mask60 = ((uint64_t)1 << 60) - 1;
+      unsigned int bits = (unsigned int)(addr > 10 ? 10 : addr) * 6;
+      switch (f) {
+        case 0: // SLA
+          m->rA = (m->rA & WORD_SIGN) | (bits >= 30 ? 0 : (MixWord)(((uint64_t)(m->rA & WORD_MAG) << bits) & WORD_MAG));
+          break;
+        case 1: // SRA
+          m->rA = (m->rA & WORD_SIGN) | (bits >= 30 ? 0 : ((m->rA & WORD_MAG) >> bits));
+          break;
+        case 2: // SLAX
+        case 3: // SRAX
+          ax = (bits >= 60) ? 0 : (f == 2 ? (ax << bits) & mask60 : ax >> bits);
+          m->rA = (m->rA & WORD_SIGN) | (MixWord)(ax >> 30);
+          m->rX = (m->rX & WORD_SIGN) | (MixWord)(ax & WORD_MAG);
+          break;
+        case 4: // SLC
+        case 5: // SRC
+        {
+          unsigned int rot = (unsigned int)(addr % 10) * 6;
+          if (f == 5) rot = (60 - rot) % 60;
+          if (rot) ax = ((ax << rot) | (ax >> (60 - rot))) & mask60;
+          m->rA = (m->rA & WORD_SIGN) | (MixWord)(ax >> 30);
+          m->rX = (m->rX & WORD_SIGN) | (MixWord)(ax & WORD_MAG);
+          break;
+        }
+        default:
+          sim_fail(m, "invalid shift %d at %u", f, m->pc);
+      }
+      break;
+    }
+
+    case 7: // MOVE
+    {
+      long long dst = word_value(m->rI[1]);
+      for (int k = 0 ; k < f ; k++) {
+        if (addr + k >= MIX_MEMORY_SIZE || dst + k < 0 || dst + k >= MIX_MEMORY_SIZE) {
+          sim_fail(m, "MOVE out of range at %u", m->pc);
+          break;
+        }
+        store_word(m, (unsigned int)(dst + k), m->mem[addr + k]);
+      }
+      m->rI[1] = index_set(m, dst + f, 0);
+      break;
+    }
+
+    case 8: case 15: // LDA, LDX
+    case 16: case 23: // LDAN, LDXN
+      reg = (c == 8 || c == 16) ? &m->rA : &m->rX;
+      *reg = field_get(m->mem[addr], l, r);
+      if (c >= 16) *reg ^= WORD_SIGN;
+      break;
+
+    case 9: case 10: case 11: case 12: case 13: case 14:    // LDi
+    case 17: case 18: case 19: case 20: case 21: case 22:   // LDiN
+    {
+      int k = (c < 16) ? c - 8 : c - 16;
+      MixWord v = field_get(m->mem[addr], l, r);
+      if ((v & WORD_MAG) > INDEX_MAG) {
+        sim_fail(m, "index register overflow at %u", m->pc);
+        break;
+      }
+      m->rI[k] = (c >= 16) ? v ^ WORD_SIGN : v;
+      break;
+    }
+
+    case 24: case 31: // STA, STX
+      store_word(m, (unsigned int)addr, field_set(m->mem[addr], c == 24 ? m->rA : m->rX, l, r));
+      break;
+
+    case 25: case 26: case 27: case 28: case 29: case 30: // STi
+      store_word(m, (unsigned int)addr, field_set(m->mem[addr], m->rI[c - 24], l, r));
+      break;
+
+    case 32: // STJ
+      store_word(m, (unsigned int)addr, field_set(m->mem[addr], m->rJ, l, r));
+      break;
+
+    case 33: // STZ
+      store_word(m, (unsigned int)addr, field_set(m->mem[addr], 0, l, r));
+      break;
+
+    case 34: // JBUS, devices are never busy
+    case 35: // IOC
+      break;
+
+    case 36: // IN, no input devices attached
+      sim_fail(m, "no input on unit %d at %u", f, m->pc);
+      break;
+
+    case 37: // OUT
+      switch (f) {
+        case UNIT_TTY:         output_block(m, (unsigned int)addr, 14); break;
+        case UNIT_PRINTER:     output_block(m, (unsigned int)addr, 24); break;
+        case UNIT_CARD_PUNCH:  output_block(m, (unsigned int)addr, 16); break;
+        default:
+          sim_fail(m, "no output on unit %d at %u", f, m->pc);
+      }
+      break;
+
+    case 38: // JRED, devices are always ready
+      m->rJ = next;
+      next = (unsigned int)addr;
+      break;
+
+    case 39: // JMP family
+    {
+      int jump = 0;
+      switch (f) {
+        case 0: case 1: jump = 1; break;
+        case 2: jump = m->overflow; m->overflow = 0; break;
+        case 3: jump = !m->overflow; m->overflow = 0; break;
+        case 4: jump = m->ci < 0; break;
+        case 5: jump = m->ci == 0; break;
+        case 6: jump = m->ci > 0; break;
+        case 7: jump = m->ci >= 0; break;
+        case 8: jump = m->ci != 0; break;
+        case 9: jump = m->ci <= 0; break;
+        default: sim_fail(m, "invalid jump %d at %u", f, m->pc);
+      }
+      if (jump) {
+        if (f != 1) m->rJ = next;
+        next = (unsigned int)addr;
+      }
+      break;
+    }
+
+    case 40: case 41: case 42: case 43: case 44: case 45: case 46: case 47:
+    {
+      MixWord v = (c == 40) ? m->rA : (c == 47) ? m->rX : m->rI[c - 40];
+      if (jump_condition(m, v, f)) {
+        m->rJ = next;
+        next = (unsigned int)addr;
+      }
+      break;
+    }
+
+    case 48: case 55: // rA, rX immediate
+    {
+      reg = (c == 48) ? &m->rA : &m->rX;
+      switch (f) {
+        case 0: *reg = word_add(m, *reg, addr); break;
+        case 1: *reg = word_add(m, *reg, -addr); break;
+        case 2: *reg = enter(addr, (inst & WORD_SIGN) != 0); break;
+        case 3: *reg = enter(-addr, (inst & WORD_SIGN) == 0); break;
+        default: sim_fail(m, "invalid address transfer %d at %u", f, m->pc);
+      }
+      break;
+    }
+
+    case 49: case 50: case 51: case 52: case 53: case 54: // rIi immediate
+    {
+      int k = c - 48;
+      int inst_negative = (inst & WORD_SIGN) != 0;
+      switch (f) {
+        case 0: m->rI[k] = index_set(m, word_value(m->rI[k]) + addr, (m->rI[k] & WORD_SIGN) != 0); break;
+        case 1: m->rI[k] = index_set(m, word_value(m->rI[k]) - addr, (m->rI[k] & WORD_SIGN) != 0); break;
+        case 2: m->rI[k] = index_set(m, addr, inst_negative); break;
+        case 3: m->rI[k] = index_set(m, -addr, !inst_negative); break;
+        default: sim_fail(m, "invalid address transfer %d at %u", f, m->pc);
+      }
+      break;
+    }
+
+    case 56: case 57: case 58: case 59: case 60: case 61: case 62: case 63: // CMP
+    {
+      MixWord v = (c == 56) ? m->rA : (c == 63) ? m->rX : m->rI[c - 56];
+      m->ci = compare(v, m->mem[addr], l, r);
+      break;
+    }
+
+    default:
+      sim_fail(m, "invalid operation %d at %u", c, m->pc);
+  }
+
+  if (m->status == SIM_ERROR) return 1;
+
+  if (m->profile) sim_profile_step(m->profile, m, next, ticks);
+
+  m->cycles += ticks;
+  m->instructions += 1;
+  m->pc = next;
+
+  return 0;
+}
+
+/* the plain fetch-decode-execute loop, also used by the profiler */
+static enum SimStatus run_reference(MixMachine *m, unsigned long long max_steps) {
+  m->status = SIM_HALTED;
+
+  while (m->instructions < max_steps) {
+    if (step(m)) return m->status;
+  }
+
+  m->status = SIM_STEP_LIMIT;
+  return m->status;
+}
+
+#if defined(__GNUC__)
+
+/* handlers of the threaded interpreter, H_STEP leaves the word to step() */
+enum Handler {
+  H_STEP, H_NOP, H_ADD, H_SUB, H_MUL, H_DIV,
+  H_LD, H_LDN, H_LD_WORD, H_LDI, H_LDIN,
+  H_ST, H_ST_WORD, H_STZ,
+  H_JMP, H_JSJ, H_JCI, H_JREG,
+  H_INC, H_DEC, H_ENT, H_ENN, H_ENT_CONST,
+  H_INCI, H_DECI, H_ENTI, H_ENNI,
+  H_CMP,
+  H_PUSH, H_POP, // INCi k, STA b,i and LDA a,i, DECi k
+  N_HANDLERS
+};
+
+// L, E, G, GE, NE and LE as bits of <, =, > (N, Z, P... for registers)
+static const unsigned char conditions[6] = {1, 2, 4, 6, 5, 3};
+
+static int fits_index(long long v) {
+  return (v < 0 ? -v : v) <= (long long)INDEX_MAG;
+}
+
+/* register of the operation code c, NULL for those without one */
+static MixWord *op_reg(MixMachine *m, int c) {
+  switch (c) {
+    case 8: case 16: case 24: case 40: case 48: case 56: return &m->rA;
+    case 15: case 23: case 31: case 47: case 55: case 63: return &m->rX;
+    case 32: return &m->rJ;
+  }
+
+  if (c >= 9 && c <= 14) return &m->rI[c - 8];
+  if (c >= 17 && c <= 22) return &m->rI[c - 16];
+  if (c >= 25 && c <= 30) return &m->rI[c - 24];
+  if (c >= 41 && c <= 46) return &m->rI[c - 40];
+  if (c >= 49 && c <= 54) return &m->rI[c - 48];
+  if (c >= 57 && c <= 62) return &m->rI[c - 56];
+
+  return NULL;
+}
+
+static enum Handler op_handler(int c, int f, int i) {
+  if (i > 6) return H_STEP;
+  if (((c >= 1 && c <= 4) || (c >= 8 && c <= 33) || c >= 56) && !valid_field(f)) return H_STEP;
+
+  switch (c) {
+    case 0: return H_NOP;
+    case 1: return H_ADD;
+    case 2: return H_SUB;
+    case 3: return H_MUL;
+    case 4: return H_DIV;
+    case 8: case 15: return f == 5 ? H_LD_WORD : H_LD;
+    case 16: case 23: return H_LDN;
+    case 33: return H_STZ;
+    case 39:
+      if (f == 0) return H_JMP;
+      if (f == 1) return H_JSJ;
+      return (f >= 4 && f <= 9) ? H_JCI : H_STEP;
+  }
+
+  if (c >= 9 && c <= 14) return H_LDI;
+  if (c >= 17 && c <= 22) return H_LDIN;
+  if (c >= 24 && c <= 32) return f == 5 ? H_ST_WORD : H_ST;
+  if (c >= 40 && c <= 47) return f <= 5 ? H_JREG : H_STEP;
+  if (c >= 56) return H_CMP;
+
+  if (c == 48 || c == 55 || (c >= 49 && c <= 54)) {
+    int index = c != 48 && c != 55;
+
+    // with no index register, ENT and ENN load a constant
+    if (i == 0 && (f == 2 || f == 3)) return H_ENT_CONST;
+    switch (f) {
+      case 0: return index ? H_INCI : H_INC;
+      case 1: return index ? H_DECI : H_DEC;
+      case 2: return index ? H_ENTI : H_ENT;
+      case 3: return index ? H_ENNI : H_ENN;
+    }
+  }
+
+  return H_STEP;
+}
+
+/* translate the word at pc, or the pair of words at pc and pc + 1 when
+   they push rA (rX) on the stack or pop it from there */
+static void decode(MixMachine *m, unsigned int pc, const void *const *handlers) {
+  SimDecoded *d = &m->code[pc];
+  MixWord inst = m->mem[pc];
+  int c = inst & 63, f = (inst >> 6) & 63, i = (inst >> 12) & 63;
+  int negative = (inst & WORD_SIGN) != 0;
+  int a = (int)((inst >> 18) & INDEX_MAG);
+  enum Handler h = op_handler(c, f, i);
+
+  memset(d, 0, sizeof(*d));
+  d->a = negative ? -a : a;
+  d->i = (unsigned char)i;
+  d->negative = (unsigned char)negative;
+  d->l = (unsigned char)(f / 8);
+  d->r = (unsigned char)(f % 8);
+  d->ticks = op_time[c][f];
+  d->reg = op_reg(m, c);
+
+  if (h == H_JCI) d->cond = conditions[f - 4];
+  if (h == H_JREG) d->cond = conditions[f];
+  if (h == H_ENT_CONST) d->w = (f == 2) ? enter(d->a, negative) : enter(-d->a, !negative);
+
+  if (pc + 1 < MIX_MEMORY_SIZE && (h == H_INCI || h == H_LD_WORD)) {
+    MixWord inst2 = m->mem[pc + 1];
+    int c2 = inst2 & 63, f2 = (inst2 >> 6) & 63, i2 = (inst2 >> 12) & 63;
+    int a2 = (int)((inst2 >> 18) & INDEX_MAG);
+
+    if (inst2 & WORD_SIGN) a2 = -a2;
+
+    if (h == H_INCI && i == 0 && (c2 == 24 || c2 == 31) && f2 == 5 && i2 == c - 48) {
+      h = H_PUSH;
+      d->i = (unsigned char)i2;
+      d->b = a2;
+      d->reg = op_reg(m, c2);
+      d->ticks += op_time[c2][f2];
+    } else if (h == H_LD_WORD && i != 0 && c2 == 48 + i && f2 == 1 && i2 == 0) {
+      h = H_POP;
+      d->b = a2;
+      d->ticks += op_time[c2][f2];
+    }
+  }
+
+  d->handler = handlers[h];
+}
+
+/* direct-threaded interpreter: each word is decoded once into the address
+   of its handler, which runs it and jumps straight to the next handler */
+static enum SimStatus run_threaded(MixMachine *m, unsigned long long max_steps) {
+  static const void *const handlers[N_HANDLERS] = {
+    [H_STEP] = &&op_step, [H_NOP] = &&op_nop,
+    [H_ADD] = &&op_add, [H_SUB] = &&op_sub, [H_MUL] = &&op_mul, [H_DIV] = &&op_div,
+    [H_LD] = &&op_ld, [H_LDN] = &&op_ldn, [H_LD_WORD] = &&op_ld_word,
+    [H_LDI] = &&op_ldi, [H_LDIN] = &&op_ldin,
+    [H_ST] = &&op_st, [H_ST_WORD] = &&op_st_word, [H_STZ] = &&op_stz,
+    [H_JMP] = &&op_jmp, [H_JSJ] = &&op_jsj, [H_JCI] = &&op_jci, [H_JREG] = &&op_jreg,
+    [H_INC] = &&op_inc, [H_DEC] = &&op_dec, [H_ENT] = &&op_ent, [H_ENN] = &&op_enn,
+    [H_ENT_CONST] = &&op_ent_const,
+    [H_INCI] = &&op_inci, [H_DECI] = &&op_deci, [H_ENTI] = &&op_enti, [H_ENNI] = &&op_enni,
+    [H_CMP] = &&op_cmp,
+    [H_PUSH] = &&op_push, [H_POP] = &&op_pop
+  };
+
+  unsigned int pc = m->pc;
+  unsigned long long cycles = m->cycles, count = m->instructions;
+  const SimDecoded *d = NULL;
+  long long addr, v;
+  MixWord w;
+
+  m->status = SIM_HALTED;
+
+#define DISPATCH() do { \
+    if (count >= max_steps) goto limit; \
+    if (pc >= MIX_MEMORY_SIZE) goto op_step; \
+    d = &m->code[pc]; \
+    if (d->handler == NULL) decode(m, pc, handlers); \
+    goto *d->handler; \
+  } while (0)
+
+// account the words run by the handler, then continue at next
+#define NEXT(words, next) do { \
+    cycles += d->ticks; \
+    count += (words); \
+    pc = (next); \
+    DISPATCH(); \
+  } while (0)
+
+#define ADDRESS() (d->a + word_value(m->rI[d->i]))
+
+// addresses out of memory are reported by step()
+#define MEMORY() do { \
+    addr = ADDRESS(); \
+    if (addr < 0 || addr >= MIX_MEMORY_SIZE) goto op_step; \
+  } while (0)
+
+  DISPATCH();
+
+op_step:
+  // the rare operations and every error go through the plain interpreter
+  m->pc = pc;
+  m->cycles = cycles;
+  m->instructions = count;
+  if (step(m)) return m->status;
+  pc = m->pc;
+  cycles = m->cycles;
+  count = m->instructions;
+  DISPATCH();
+
+op_nop:
+  NEXT(1, pc + 1);
+
+op_add:
+  MEMORY();
+  m->rA = word_add(m, m->rA, word_value(field_get(m->mem[addr], d->l, d->r)));
+  NEXT(1, pc + 1);
+
+op_sub:
+  MEMORY();
+  m->rA = word_add(m, m->rA, -word_value(field_get(m->mem[addr], d->l, d->r)));
+  NEXT(1, pc + 1);
+
+op_mul:
+  MEMORY();
+  multiply(m, field_get(m->mem[addr], d->l, d->r));
+  NEXT(1, pc + 1);
+
+op_div:
+  MEMORY();
+  divide(m, field_get(m->mem[addr], d->l, d->r));
+  NEXT(1, pc + 1);
+
+op_ld:
+  MEMORY();
+  *d->reg = field_get(m->mem[addr], d->l, d->r);
+  NEXT(1, pc + 1);
+
+op_ldn:
+  MEMORY();
+  *d->reg = field_get(m->mem[addr], d->l, d->r) ^ WORD_SIGN;
+  NEXT(1, pc + 1);
+
+op_ld_word:
+  MEMORY();
+  *d->reg = m->mem[addr];
+  NEXT(1, pc + 1);
+
+op_ldi:
+  MEMORY();
+  w = field_get(m->mem[addr], d->l, d->r);
+  if ((w & WORD_MAG) > INDEX_MAG) goto op_step;
+  *d->reg = w;
+  NEXT(1, pc + 1);
+
+op_ldin:
+  MEMORY();
+  w = field_get(m->mem[addr], d->l, d->r);
+  if ((w & WORD_MAG) > INDEX_MAG) goto op_step;
+  *d->reg = w ^ WORD_SIGN;
+  NEXT(1, pc + 1);
+
+op_st:
+  MEMORY();
+  store_word(m, (unsigned int)addr, field_set(m->mem[addr], *d->reg, d->l, d->r));
+  NEXT(1, pc + 1);
+
+op_st_word:
+  MEMORY();
+  store_word(m, (unsigned int)addr, *d->reg);
+  NEXT(1, pc + 1);
+
+op_stz:
+  MEMORY();
+  store_word(m, (unsigned int)addr, field_set(m->mem[addr], 0, d->l, d->r));
+  NEXT(1, pc + 1);
+
+op_jmp:
+  m->rJ = pc + 1;
+  NEXT(1, (unsigned int)ADDRESS());
+
+op_jsj:
+  NEXT(1, (unsigned int)ADDRESS());
+
+op_jci:
+  if (d->cond & (1 << (m->ci + 1))) {
+    m->rJ = pc + 1;
+    NEXT(1, (unsigned int)ADDRESS());
+  }
+  NEXT(1, pc + 1);
+
+op_jreg:
+  v = word_value(*d->reg);
+  if (d->cond & (v < 0 ? 1 : v == 0 ? 2 : 4)) {
+    m->rJ = pc + 1;
+    NEXT(1, (unsigned int)ADDRESS());
+  }
+  NEXT(1, pc + 1);
+
+op_inc:
+  *d->reg = word_add(m, *d->reg, ADDRESS());
+  NEXT(1, pc + 1);
+
+op_dec:
+  *d->reg = word_add(m, *d->reg, -ADDRESS());
+  NEXT(1, pc + 1);
+
+op_ent:
+  *d->reg = enter(ADDRESS(), d->negative);
+  NEXT(1, pc + 1);
+
+op_enn:
+  *d->reg = enter(-ADDRESS(), !d->negative);
+  NEXT(1, pc + 1);
+
+op_ent_const:
+  *d->reg = d->w;
+  NEXT(1, pc + 1);
+
+op_inci:
+  v = word_value(*d->reg) + ADDRESS();
+  if (!fits_index(v)) goto op_step;
+  *d->reg = index_set(m, v, (*d->reg & WORD_SIGN) != 0);
+  NEXT(1, pc + 1);
+
+op_deci:
+  v = word_value(*d->reg) - ADDRESS();
+  if (!fits_index(v)) goto op_step;
+  *d->reg = index_set(m, v, (*d->reg & WORD_SIGN) != 0);
+  NEXT(1, pc + 1);
+
+op_enti:
+  v = ADDRESS();
+  if (!fits_index(v)) goto op_step;
+  *d->reg = index_set(m, v, d->negative);
+  NEXT(1, pc + 1);
+
+op_enni:
+  v = -ADDRESS();
+  if (!fits_index(v)) goto op_step;
+  *d->reg = index_set(m, v, !d->negative);
+  NEXT(1, pc + 1);
+
+op_cmp:
+  MEMORY();
+  m->ci = compare(*d->reg, m->mem[addr], d->l, d->r);
+  NEXT(1, pc + 1);
+
+op_push:
+  // unless both words run in full, the first one runs alone
+  if (max_steps - count < 2) goto op_step;
+  v = word_value(m->rI[d->i]) + d->a;
+  addr = d->b + v;
+  if (!fits_index(v) || addr < 0 || addr >= MIX_MEMORY_SIZE) goto op_step;
+  m->rI[d->i] = index_set(m, v, (m->rI[d->i] & WORD_SIGN) != 0);
+  store_word(m, (unsigned int)addr, *d->reg);
+  NEXT(2, pc + 2);
+
+op_pop:
+  if (max_steps - count < 2) goto op_step;
+  MEMORY();
+  v = word_value(m->rI[d->i]) - d->b;
+  if (!fits_index(v)) goto op_step;
+  *d->reg = m->mem[addr];
+  m->rI[d->i] = index_set(m, v, (m->rI[d->i] & WORD_SIGN) != 0);
+  NEXT(2, pc + 2);
+
+limit:
+  m->pc = pc;
+  m->cycles = cycles;
+  m->instructions = count;
+  m->status = SIM_STEP_LIMIT;
+  return m->status;
+
+#undef DISPATCH
+#undef NEXT
+#undef ADDRESS
+#undef MEMORY
+}
+
+#endif
+
+enum SimStatus sim_run(MixMachine *m, unsigned long long max_steps) {
+#if defined(__GNUC__)
+  if (m->profile == NULL && !m->reference) return run_threaded(m, max_steps);
+#endif
+  return run_reference(m, max_steps);
+}
+
+int sim_result(const MixMachine *m, long long *result) {
+  size_t end = m->output_len;
+
+  // the result is the number at the end of the last output line
+  while (end > 0 && (m->output[end - 1] == '\n' || m->output[end - 1] == ' ')) end--;
+
+  size_t begin = end;
+  while (begin > 0 && m->output[begin - 1] >= '0' && m->output[begin - 1] <= '9') begin--;
+
+  if (begin == end) return -1;
+
+  long long v = 0;
+  for (size_t i = begin ; i < end ; i++) v = v * 10 + (m->output[i] - '0');
+
+  if (begin > 0 && m->output[begin - 1] == '-') v = -v;
+
+  *result = v;
+  return 0;
+}
+
+static const char *status_str[] = {
+  [SIM_HALTED] = "halted",
+  [SIM_ERROR] = "error",
+  [SIM_STEP_LIMIT] = "step_limit"
+};
+
+void sim_json_string(FILE *out, const char *s) {
+  fputc('"', out);
+  for ( ; *s ; s++) {
+    switch (*s) {
+      case '"':  fputs("\\\"", out); break;
+      case '\\': fputs("\\\\", out); break;
+      case '\n': fputs("\\n", out); break;
+      default:   fputc(*s, out);
+    }
+  }
+  fputc('"', out);
+}
+
+void sim_report(FILE *out, const char *fname, const MixMachine *m) {
+  long long result;
+
+  fprintf(out, "{\"file\": ");
+  sim_json_string(out, fname);
+  fprintf(out, ", \"status\": \"%s\"", status_str[m->status]);
+  if (m->status == SIM_ERROR) {
+    fprintf(out, ", \"error\": ");
+    sim_json_string(out, m->error);
+  }
+  if (m->status == SIM_HALTED && sim_result(m, &result) == 0) {
+    fprintf(out, ", \"result\": %lld", result);
+  } else {
+    fprintf(out, ", \"result\": null");
+  }
+  fprintf(out, ", \"cycles\": %llu", m->cycles);
+  fprintf(out, ", \"instructions\": %llu", m->instructions);
+  fprintf(out, ", \"stack_high_water\": %d", m->stack_high_water + 1);
+  fprintf(out, ", \"code_size\": %u", m->prog->code_size);
+  fprintf(out, ", \"overflows\": %llu", m->overflows);
+  fprintf(out, ", \"output\": ");
+  sim_json_string(out, m->output);
+  fprintf(out, "}\n");
+}
@@ -0,0 +1,563 @@
+#include "sim.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_LEN 512
+#define SYMBOL_LEN 10
+#define MAX_SYMBOLS 4096
+#define MAX_LOCALS 4096
+#define MAX_LINES 16384
+
+typedef struct {
+  char name[SYMBOL_LEN + 1];
+  long long value;
+} Symbol;
+
+typedef struct {
+  int digit;
+  int line;
+  long long value;
+} LocalSymbol;
+
+struct Assembler {
+  const char *fname;
+  int line;
+  int pass;
+  int errors;
+
+  long long loc;         // location counter
+  long long end_loc;     // location of END, literals follow it
+  unsigned int literals; // literals seen so far in this pass
+
+  int src_line;          // @method:line annotation of the current line
+  int method;
+
+  Symbol symbols[MAX_SYMBOLS];
+  unsigned int n_symbols;
+
+  LocalSymbol locals[MAX_LOCALS];
+  unsigned int n_locals;
+
+  MixProgram *prog;
+};
+
+static void asm_error(struct Assembler *as, const char *msg, const char *detail) {
+  if (as->pass == 1 && strncmp(msg, "undefined", 9) == 0) return;
+  fprintf(stderr, "%s:%d: error: %s%s%s\n", as->fname, as->line, msg,
+          detail ? " " : "", detail ? detail : "");
+  as->errors += 1;
+}
+
+static Symbol *asm_find_symbol(struct Assembler *as, const char *name) {
+  for (unsigned int i = 0 ; i < as->n_symbols ; i++) {
+    if (strcmp(as->symbols[i].name, name) == 0) return &as->symbols[i];
+  }
+  return NULL;
+}
+
+static void asm_define(struct Assembler *as, const char *name, long long value) {
+  // local symbols dH
+  if (isdigit((unsigned char)name[0]) && name[1] == 'H' && name[2] == '\0') {
+    if (as->pass == 1) {
+      if (as->n_locals >= MAX_LOCALS) {
+        asm_error(as, "too many local symbols", NULL);
+        return;
+      }
+      as->locals[as->n_locals++] = (LocalSymbol){ name[0] - '0', as->line, value };
+    }
+    return;
+  }
+
+  Symbol *s = asm_find_symbol(as, name);
+  if (as->pass == 1) {
+    if (s != NULL) {
+      asm_error(as, "symbol defined multiple times:", name);
+      return;
+    }
+    if (as->n_symbols >= MAX_SYMBOLS) {
+      asm_error(as, "too many symbols", NULL);
+      return;
+    }
+    s = &as->symbols[as->n_symbols++];
+    strncpy(s->name, name, SYMBOL_LEN);
+    s->name[SYMBOL_LEN] = '\0';
+  }
+  if (s != NULL) s->value = value;
+}
+
+static int asm_lookup(struct Assembler *as, const char *name, long long *value) {
+  // local symbols dF / dB
+  if (isdigit((unsigned char)name[0]) && (name[1] == 'F' || name[1] == 'B') && name[2] == '\0') {
+    int digit = name[0] - '0';
+    if (name[1] == 'F') {
+      for (unsigned int i = 0 ; i < as->n_locals ; i++) {
+        if (as->locals[i].digit == digit && as->locals[i].line > as->line) {
+          *value = as->locals[i].value;
+          return 0;
+        }
+      }
+    } else {
+      for (unsigned int i = as->n_locals ; i > 0 ; i--) {
+        if (as->locals[i - 1].digit == digit && as->locals[i - 1].line < as->line) {
+          *value = as->locals[i - 1].value;
+          return 0;
+        }
+      }
+    }
+    return -1;
+  }
+
+  Symbol *s = asm_find_symbol(as, name);
+  if (s == NULL) return -1;
+
+  *value = s->value;
+  return 0;
+}
+
+/* atomic expression: number, symbol or '*' */
+static int asm_atom(struct Assembler *as, const char **p, long long *value) {
+  char token[LINE_LEN];
+  size_t len = 0;
+
+  if (**p == '*') {
+    *p += 1;
+    *value = as->loc;
+    return 0;
+  }
+
+  while (isalnum((unsigned char)**p) && len < sizeof(token) - 1) {
+    token[len++] = *(*p)++;
+  }
+  token[len] = '\0';
+
+  if (len == 0) {
+    asm_error(as, "expected expression near", *p);
+    return -1;
+  }
+
+  int numeric = 1;
+  for (size_t i = 0 ; i < len ; i++) {
+    if (!isdigit((unsigned char)token[i])) numeric = 0;
+  }
+
+  if (numeric) {
+    *value = strtoll(token, NULL, 10);
+    return 0;
+  }
+
+  if (asm_lookup(as, token, value)) {
+    asm_error(as, "undefined symbol", token);
+    *value = 0;
+    return as->pass == 1 ? 0 : -1;
+  }
+
+  return 0;
+}
+
+/* expression, evaluated strictly left to right as in MIXAL */
+static int asm_expr(struct Assembler *as, const char **p, long long *value) {
+  long long v = 0;
+  int negate = 0;
+
+  if (**p == '+' || **p == '-') {
+    negate = (**p == '-');
+    *p += 1;
+  }
+
+  if (asm_atom(as, p, &v)) return -1;
+  if (negate) v = -v;
+
+  for (;;) {
+    char op = **p;
+    long long rhs = 0;
+
+    if (op == '/' && (*p)[1] == '/') {
+      *p += 2;
+      if (asm_atom(as, p, &rhs)) return -1;
+      v = (rhs != 0) ? (v * 1073741824LL) / rhs : 0;
+      continue;
+    }
+
+    if (op != '+' && op != '-' && op != '*' && op != '/' && op != ':') break;
+
+    *p += 1;
+    if (asm_atom(as, p, &rhs)) return -1;
+
+    switch (op) {
+      case '+': v = v + rhs; break;
+      case '-': v = v - rhs; break;
+      case '*': v = v * rhs; break;
+      case '/': v = (rhs != 0) ? v / rhs : 0; break;
+      case ':': v = 8 * v + rhs; break;
+    }
+  }
+
+  *value = v;
+  return 0;
+}
+
+/* store the rightmost bytes of value into field (L:R) of word */
+static MixWord asm_set_field(MixWord word, long long value, int field) {
+  int l = field / 8;
+  int r = field % 8;
+  int negative = value < 0;
+  uint64_t mag = (uint64_t)(negative ? -value : value);
+
+  if (l == 0) {
+    word = (word & ~WORD_SIGN) | (negative ? WORD_SIGN : 0);
+    l = 1;
+  }
+
+  for (int i = r ; i >= l ; i--) {
+    int shift = 6 * (5 - i);
+    word = (word & ~((MixWord)63 << shift)) | ((MixWord)(mag & 63) << shift);
+    mag >>= 6;
+  }
+
+  return word;
+}
+
+/* W-value: E, E(F), E(F), ... */
+static int asm_wvalue(struct Assembler *as, const char **p, MixWord *word) {
+  MixWord w = 0;
+
+  for (;;) {
+    long long value, field = 5;
+
+    if (asm_expr(as, p, &value)) return -1;
+
+    if (**p == '(') {
+      *p += 1;
+      if (asm_expr(as, p, &field)) return -1;
+      if (**p != ')') {
+        asm_error(as, "expected ')' in W-value", NULL);
+        return -1;
+      }
+      *p += 1;
+    }
+
+    if (field < 0 || field / 8 > 5 || field % 8 > 5 || field / 8 > field % 8) {
+      asm_error(as, "invalid field in W-value", NULL);
+      return -1;
+    }
+
+    w = asm_set_field(w, value, (int)field);
+
+    if (**p != ',') break;
+    *p += 1;
+  }
+
+  *word = w;
+  return 0;
+}
+
+static void asm_store(struct Assembler *as, long long address, MixWord word) {
+  if (address < 0 || address >= MIX_MEMORY_SIZE) {
+    asm_error(as, "location out of memory range", NULL);
+    return;
+  }
+
+  if (as->pass == 2) {
+    as->prog->mem[address] = word;
+    as->prog->line[address] = as->line;
+    as->prog->src_line[address] = as->src_line;
+    as->prog->method[address] = as->method;
+    if (!as->prog->loaded[address]) as->prog->code_size += 1;
+    as->prog->loaded[address] = 1;
+  }
+}
+
+/* A-part of an instruction, including literal constants =W= */
+static int asm_apart(struct Assembler *as, const char **p, long long *value) {
+  if (**p == '=') {
+    MixWord w = 0;
+    *p += 1;
+    if (asm_wvalue(as, p, &w)) return -1;
+    if (**p != '=') {
+      asm_error(as, "unterminated literal constant", NULL);
+      return -1;
+    }
+    *p += 1;
+
+    long long address = as->end_loc + as->literals;
+    as->literals += 1;
+
+    // the literal word is data, not part of the annotated method
+    int method = as->method;
+    as->method = -1;
+    if (as->pass == 2) asm_store(as, address, w);
+    as->method = method;
+    *value = address;
+    return 0;
+  }
+
+  if (**p == '\0' || **p == ',' || **p == '(') {
+    *value = 0;
+    return 0;
+  }
+
+  return asm_expr(as, p, value);
+}
+
+static int asm_instruction(struct Assembler *as, const MixOpcode *op, const char *operand) {
+  const char *p = operand;
+  long long a = 0, index = 0, field = op->field;
+
+  if (asm_apart(as, &p, &a)) return -1;
+
+  if (*p == ',') {
+    p += 1;
+    if (asm_expr(as, &p, &index)) return -1;
+  }
+
+  if (*p == '(') {
+    p += 1;
+    if (asm_expr(as, &p, &field)) return -1;
+    if (*p != ')') {
+      asm_error(as, "expected ')' after field", NULL);
+      return -1;
+    }
+    p += 1;
+  }
+
+  if (*p != '\0') {
+    asm_error(as, "unexpected characters in operand:", p);
+    return -1;
+  }
+
+  if (a <= -(1 << 12) || a >= (1 << 12)) {
+    asm_error(as, "address out of range:", operand);
+    return -1;
+  }
+  if (index < 0 || index > 6) {
+    asm_error(as, "invalid index register:", operand);
+    return -1;
+  }
+  if (field < 0 || field > 63) {
+    asm_error(as, "invalid field:", operand);
+    return -1;
+  }
+
+  uint64_t mag = (uint64_t)(a < 0 ? -a : a);
+  MixWord w = word_from(a < 0, (mag << 18) | ((uint64_t)index << 12)
+                               | ((uint64_t)field << 6) | op->code);
+
+  asm_store(as, as->loc, w);
+  as->loc += 1;
+
+  return 0;
+}
+
+static int asm_alf(struct Assembler *as, const char *operand) {
+  char text[5];
+  const char *p = operand;
+
+  if (*p == '"') {
+    p += 1;
+  }
+  for (int i = 0 ; i < 5 ; i++) {
+    text[i] = (*p && *p != '"') ? *p++ : ' ';
+  }
+
+  MixWord w = 0;
+  for (int i = 0 ; i < 5 ; i++) {
+    const char *c = strchr(mix_chars, toupper((unsigned char)text[i]));
+    if (c == NULL || text[i] == '\0') {
+      asm_error(as, "invalid character in ALF:", operand);
+      return -1;
+    }
+    w = (w << 6) | (MixWord)(c - mix_chars);
+  }
+
+  asm_store(as, as->loc, w);
+  as->loc += 1;
+  return 0;
+}
+
+/* split a MIXAL line into label, opcode and operand */
+static void asm_split(char *line, char **label, char **opcode, char **operand) {
+  char *p = line;
+
+  *label = *opcode = *operand = NULL;
+
+  if (!isspace((unsigned char)*p)) {
+    *label = p;
+    while (*p && !isspace((unsigned char)*p)) p++;
+    if (*p) *p++ = '\0';
+  }
+
+  while (isspace((unsigned char)*p)) p++;
+  if (!*p) return;
+
+  *opcode = p;
+  while (*p && !isspace((unsigned char)*p)) p++;
+  if (*p) *p++ = '\0';
+
+  while (*p == ' ' || *p == '\t') p++;
+  if (!*p || *p == ';') return;
+
+  *operand = p;
+  if (*p == '"') {
+    p++;
+    while (*p && *p != '"') p++;
+    if (*p) p++;
+  } else {
+    while (*p && !isspace((unsigned char)*p)) p++;
+  }
+  *p = '\0';
+}
+
+/* method index of an annotation, the first annotated word is its entry */
+static int asm_method(struct Assembler *as, const char *name, size_t len) {
+  MixProgram *prog = as->prog;
+
+  if (len > SIM_METHOD_LEN) len = SIM_METHOD_LEN;
+
+  for (unsigned int k = 0 ; k < prog->n_methods ; k++) {
+    if (strncmp(prog->methods[k], name, len) == 0 && prog->methods[k][len] == '\0') return (int)k;
+  }
+
+  if (prog->n_methods >= SIM_METHODS_MAX) {
+    asm_error(as, "too many annotated methods", NULL);
+    return -1;
+  }
+
+  unsigned int k = prog->n_methods++;
+  memcpy(prog->methods[k], name, len);
+  prog->methods[k][len] = '\0';
+  prog->method_entry[k] = (unsigned int)as->loc;
+
+  return (int)k;
+}
+
+/* @method:line at the end of the comment, left by compiler -fprofile */
+static void asm_annotation(struct Assembler *as, const char *line) {
+  const char *at = strrchr(line, '@');
+
+  as->src_line = 0;
+  as->method = -1;
+
+  if (as->pass != 2 || at == NULL || at == line || at[-1] != ' ') return;
+  if (strchr(line, ';') == NULL || strchr(line, ';') > at) return;
+
+  const char *name = at + 1;
+  size_t len = 0;
+  while (isalnum((unsigned char)name[len]) || name[len] == '_') len++;
+  if (len == 0 || name[len] != ':' || !isdigit((unsigned char)name[len + 1])) return;
+
+  char *end;
+  long src_line = strtol(name + len + 1, &end, 10);
+  while (isspace((unsigned char)*end)) end++;
+  if (*end != '\0') return;
+
+  as->src_line = (int)src_line;
+  as->method = asm_method(as, name, len);
+}
+
+static int asm_line(struct Assembler *as, char *line) {
+  char *label, *opcode, *operand;
+
+  line[strcspn(line, "\r\n")] = '\0';
+  if (line[0] == '*' || line[0] == '\0') return 0;
+
+  asm_annotation(as, line);
+
+  asm_split(line, &label, &opcode, &operand);
+  if (opcode == NULL) {
+    if (label) asm_error(as, "missing operation after", label);
+    return 0;
+  }
+
+  const MixOpcode *op = mix_opcode_find(opcode);
+  if (op == NULL) {
+    asm_error(as, "unknown operation", opcode);
+    return 0;
+  }
+
+  if (op->code != MIX_PSEUDO) {
+    if (label) asm_define(as, label, as->loc);
+    return asm_instruction(as, op, operand ? operand : "");
+  }
+
+  const char *p = operand ? operand : "";
+  long long value = 0;
+  MixWord w = 0;
+
+  if (strcmp(opcode, "EQU") == 0) {
+    if (asm_wvalue(as, &p, &w)) return -1;
+    if (label) asm_define(as, label, word_value(w));
+
+  } else if (strcmp(opcode, "ORIG") == 0) {
+    if (label) asm_define(as, label, as->loc);
+    if (asm_wvalue(as, &p, &w)) return -1;
+    as->loc = word_value(w);
+
+  } else if (strcmp(opcode, "CON") == 0) {
+    if (label) asm_define(as, label, as->loc);
+    if (asm_wvalue(as, &p, &w)) return -1;
+    asm_store(as, as->loc, w);
+    as->loc += 1;
+
+  } else if (strcmp(opcode, "ALF") == 0) {
+    if (label) asm_define(as, label, as->loc);
+    return asm_alf(as, p);
+
+  } else if (strcmp(opcode, "END") == 0) {
+    if (label) asm_define(as, label, as->loc);
+    if (as->pass == 2) {
+      if (asm_expr(as, &p, &value)) return -1;
+      as->prog->start = (unsigned int)value;
+    }
+    return 1;
+  }
+
+  return 0;
+}
+
+static int asm_pass(struct Assembler *as, FILE *f) {
+  char line[LINE_LEN];
+
+  as->line = 0;
+  as->loc = 0;
+  as->literals = 0;
+
+  rewind(f);
+  while (fgets(line, sizeof(line), f)) {
+    as->line += 1;
+
+    int status = asm_line(as, line);
+    if (status > 0) {
+      if (as->pass == 1) as->end_loc = as->loc;
+      return 0;
+    }
+  }
+
+  asm_error(as, "missing END", NULL);
+  return -1;
+}
+
+int sim_assemble(FILE *f, const char *fname, MixProgram *prog) {
+  struct Assembler *as = calloc(1, sizeof(struct Assembler));
+  if (as == NULL) return -1;
+
+  memset(prog, 0, sizeof(*prog));
+  for (unsigned int i = 0 ; i < MIX_MEMORY_SIZE ; i++) prog->method[i] = -1;
+
+  as->fname = fname;
+  as->prog = prog;
+
+  as->pass = 1;
+  asm_pass(as, f);
+
+  if (as->errors == 0) {
+    as->pass = 2;
+    asm_pass(as, f);
+  }
+
+  int errors = as->errors;
+  free(as);
+
+  return errors ? -1 : 0;
+}
@@ -0,0 +1,247 @@
+#include "sim_batch.h"
+#include "sim.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct Run {
+  char *file;
+  unsigned long long max_steps;
+  char *report; // JSON line, written by the worker that ran it
+  size_t report_len;
+  int halted;
+};
+
+struct Pool;
+
+/* the runs of a worker not taken yet, [lo, hi): the worker takes them
+   from the top, the others steal them from the bottom */
+struct Worker {
+  pthread_t thread;
+  pthread_mutex_t lock;
+  size_t lo, hi;
+  unsigned int index;
+  struct Pool *pool;
+};
+
+struct Pool {
+  struct Run *runs;
+  size_t n_runs;
+  struct Worker *workers;
+  unsigned int n_workers;
+  int reference;
+};
+
+static int take(struct Worker *w, int own, size_t *run) {
+  int found = 0;
+
+  pthread_mutex_lock(&w->lock);
+  if (w->lo < w->hi) {
+    *run = own ? --w->hi : w->lo++;
+    found = 1;
+  }
+  pthread_mutex_unlock(&w->lock);
+
+  return found;
+}
+
+/* the next run of worker w, stolen from the others once it has none left;
+   no run is ever added, so the batch is over when every worker is empty */
+static int next_run(struct Worker *w, size_t *run) {
+  struct Pool *p = w->pool;
+
+  if (take(w, 1, run)) return 1;
+
+  for (unsigned int k = 1 ; k < p->n_workers ; k++) {
+    if (take(&p->workers[(w->index + k) % p->n_workers], 0, run)) return 1;
+  }
+
+  return 0;
+}
+
+static void report_error(FILE *out, const char *file, const char *error) {
+  fprintf(out, "{\"file\": ");
+  sim_json_string(out, file);
+  fprintf(out, ", \"status\": \"error\", \"error\": ");
+  sim_json_string(out, error);
+  fprintf(out, ", \"result\": null}\n");
+}
+
+/* assemble and run a program on a machine of its own */
+static void execute(struct Run *r, int reference) {
+  FILE *out = open_memstream(&r->report, &r->report_len);
+  MixProgram *prog = NULL;
+  MixMachine *m = NULL;
+  FILE *f = NULL;
+
+  if (out == NULL) return;
+
+  if ((f = fopen(r->file, "r")) == NULL) {
+    report_error(out, r->file, "cannot open file");
+    goto done;
+  }
+
+  prog = malloc(sizeof(MixProgram));
+  m = malloc(sizeof(MixMachine));
+  if (prog == NULL || m == NULL) {
+    report_error(out, r->file, "out of memory");
+    goto done;
+  }
+
+  // the assembler reports its errors on stderr
+  if (sim_assemble(f, r->file, prog)) {
+    report_error(out, r->file, "cannot assemble");
+    goto done;
+  }
+
+  sim_load(m, prog);
+  m->reference = reference;
+  sim_run(m, r->max_steps);
+
+  sim_report(out, r->file, m);
+  r->halted = (m->status == SIM_HALTED);
+
+done:
+  if (f != NULL) fclose(f);
+  free(m);
+  free(prog);
+  if (fclose(out)) {
+    free(r->report);
+    r->report = NULL;
+  }
+}
+
+static void *work(void *arg) {
+  struct Worker *w = arg;
+  size_t run;
+
+  while (next_run(w, &run)) execute(&w->pool->runs[run], w->pool->reference);
+
+  return NULL;
+}
+
+static void manifest_error(const char *name, int line, const char *msg, const char *detail) {
+  fprintf(stderr, "%s:%d: error: %s%s%s\n", name, line, msg,
+          detail ? " " : "", detail ? detail : "");
+}
+
+/* one run per line: file [max_steps], blank lines and # comments are skipped */
+static int read_manifest(FILE *f, const char *name, unsigned long long max_steps, struct Pool *p) {
+  char *line = NULL;
+  size_t cap = 0;
+  int lineno = 0, status = 0;
+
+  while (getline(&line, &cap, f) != -1) {
+    const char *delim = " \t\r\n";
+    char *file = line + strspn(line, delim);
+    char *steps = file + strcspn(file, delim);
+    char *end = NULL;
+    unsigned long long limit = max_steps;
+
+    lineno++;
+    if (*file == '\0' || *file == '#') continue;
+
+    if (*steps != '\0') *steps++ = '\0';
+    steps += strspn(steps, delim);
+
+    if (*steps != '\0') {
+      char *after = steps + strcspn(steps, delim);
+      if (*after != '\0') *after++ = '\0';
+
+      limit = strtoull(steps, &end, 10);
+      if (*steps == '-' || end == steps || *end != '\0') {
+        manifest_error(name, lineno, "invalid step limit:", steps);
+        status = -1;
+        break;
+      }
+      after += strspn(after, delim);
+      if (*after != '\0') {
+        after[strcspn(after, delim)] = '\0';
+        manifest_error(name, lineno, "unexpected text after the step limit:", after);
+        status = -1;
+        break;
+      }
+    }
+
+    struct Run *runs = realloc(p->runs, (p->n_runs + 1) * sizeof(struct Run));
+    if (runs != NULL) p->runs = runs;
+    if (runs == NULL || (file = strdup(file)) == NULL) {
+      fprintf(stderr, "internal error: out of memory\n");
+      status = -1;
+      break;
+    }
+
+    p->runs[p->n_runs++] = (struct Run) {.file = file, .max_steps = limit};
+  }
+
+  free(line);
+  return status;
+}
+
+int sim_batch(FILE *manifest, const char *name, FILE *out, unsigned int threads,
+              unsigned long long max_steps, int reference) {
+  struct Pool p = {.reference = reference};
+  int status = -1;
+
+  if (read_manifest(manifest, name, max_steps, &p)) goto done;
+
+  if (threads > p.n_runs) threads = (unsigned int)p.n_runs;
+  if (threads == 0) threads = 1;
+
+  p.workers = calloc(threads, sizeof(struct Worker));
+  if (p.workers == NULL) {
+    fprintf(stderr, "internal error: out of memory\n");
+    goto done;
+  }
+  p.n_workers = threads;
+
+  // each worker starts with a slice of the manifest
+  for (unsigned int k = 0 ; k < threads ; k++) {
+    struct Worker *w = &p.workers[k];
+    w->lo = p.n_runs * k / threads;
+    w->hi = p.n_runs * (k + 1) / threads;
+    w->index = k;
+    w->pool = &p;
+    pthread_mutex_init(&w->lock, NULL);
+  }
+
+  // the calling thread is worker 0, and steals the runs of those not started
+  unsigned char *started = calloc(threads, 1);
+  if (started == NULL) {
+    fprintf(stderr, "internal error: out of memory\n");
+    goto destroy;
+  }
+
+  for (unsigned int k = 1 ; k < threads ; k++) {
+    started[k] = pthread_create(&p.workers[k].thread, NULL, work, &p.workers[k]) == 0;
+  }
+  work(&p.workers[0]);
+  for (unsigned int k = 1 ; k < threads ; k++) {
+    if (started[k]) pthread_join(p.workers[k].thread, NULL);
+  }
+  free(started);
+
+  status = 0;
+  for (size_t k = 0 ; k < p.n_runs ; k++) {
+    struct Run *r = &p.runs[k];
+
+    if (r->report != NULL) fwrite(r->report, 1, r->report_len, out);
+    else report_error(out, r->file, "out of memory");
+
+    if (!r->halted) status = 1;
+  }
+
+destroy:
+  for (unsigned int k = 0 ; k < threads ; k++) pthread_mutex_destroy(&p.workers[k].lock);
+
+done:
+  for (size_t k = 0 ; k < p.n_runs ; k++) {
+    free(p.runs[k].file);
+    free(p.runs[k].report);
+  }
+  free(p.runs);
+  free(p.workers);
+
+  return status;
+}
@@ -0,0 +1,146 @@
+#include "sim.h"
+#include "sim_batch.h"
+#include "sim_prof.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEFAULT_MAX_STEPS 100000000ULL
+
+static void usage(const char *argv0) {
+  fprintf(stderr, "usage: %s [-n max_steps] [-p profile.txt] [-f folded.txt] [-s source.c] [-R] file.mixal\n"
+                  "       %s [-n max_steps] [-j threads] [-R] -b manifest.txt\n",
+          argv0, argv0);
+}
+
+/* run the programs of a manifest, on one thread per core unless given */
+static int batch(const char *manifest_name, long threads, unsigned long long max_steps, int reference) {
+  FILE *f = fopen(manifest_name, "r");
+  if (f == NULL) {
+    fprintf(stderr, "error: cannot open file '%s'\n", manifest_name);
+    return 2;
+  }
+
+  if (threads <= 0) threads = sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads <= 0) threads = 1;
+
+  int status = sim_batch(f, manifest_name, stdout, (unsigned int)threads, max_steps, reference);
+  fclose(f);
+
+  return status < 0 ? 2 : status;
+}
+
+/* write the profile with write to the file fname */
+static int write_profile(const char *fname, const SimProfile *p,
+                         int (*write)(const SimProfile *, FILE *, const char *, const char *),
+                         const char *mixal, const char *source) {
+  FILE *f = fopen(fname, "w");
+  if (f == NULL) {
+    fprintf(stderr, "error: cannot open file '%s'\n", fname);
+    return -1;
+  }
+
+  int status = write(p, f, mixal, source);
+  if (fclose(f)) status = -1;
+
+  return status;
+}
+
+static int write_folded(const SimProfile *p, FILE *f, const char *mixal, const char *source) {
+  (void)mixal;
+  (void)source;
+  return sim_profile_folded(p, f);
+}
+
+int main(int argc, char **argv) {
+  const char *fname = NULL;
+  const char *profile_name = NULL, *folded_name = NULL, *source_name = NULL;
+  const char *manifest_name = NULL;
+  unsigned long long max_steps = DEFAULT_MAX_STEPS;
+  long threads = 0;
+  int reference = 0;
+
+  for (int i = 1 ; i < argc ; i++) {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      max_steps = strtoull(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+      profile_name = argv[++i];
+    } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+      folded_name = argv[++i];
+    } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      source_name = argv[++i];
+    } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+      manifest_name = argv[++i];
+    } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+      threads = strtol(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-R") == 0) {
+      reference = 1;
+    } else if (argv[i][0] == '-') {
+      usage(argv[0]);
+      return 2;
+    } else {
+      fname = argv[i];
+    }
+  }
+
+  if (manifest_name != NULL) {
+    // profiles are of a single run
+    if (fname != NULL || profile_name != NULL || folded_name != NULL) {
+      usage(argv[0]);
+      return 2;
+    }
+    return batch(manifest_name, threads, max_steps, reference);
+  }
+
+  if (fname == NULL) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  FILE *f = fopen(fname, "r");
+  if (f == NULL) {
+    fprintf(stderr, "error: cannot open file '%s'\n", fname);
+    return 2;
+  }
+
+  MixProgram *prog = malloc(sizeof(MixProgram));
+  MixMachine *m = malloc(sizeof(MixMachine));
+  if (prog == NULL || m == NULL) {
+    fprintf(stderr, "internal error: out of memory\n");
+    return 2;
+  }
+
+  int status = sim_assemble(f, fname, prog);
+  fclose(f);
+  if (status) return 2;
+
+  sim_load(m, prog);
+  m->reference = reference;
+
+  if (profile_name != NULL || folded_name != NULL) {
+    m->profile = sim_profile_new(prog);
+    if (m->profile == NULL) {
+      fprintf(stderr, "internal error: out of memory\n");
+      return 2;
+    }
+  }
+
+  sim_run(m, max_steps);
+
+  sim_report(stdout, fname, m);
+
+  status = (m->status == SIM_HALTED) ? 0 : 1;
+
+  if (profile_name != NULL &&
+      write_profile(profile_name, m->profile, sim_profile_report, fname, source_name)) status = 2;
+  if (folded_name != NULL &&
+      write_profile(folded_name, m->profile, write_folded, fname, source_name)) status = 2;
+
+  sim_profile_free(m->profile);
+  free(m);
+  free(prog);
+
+  return status;
+}
@@ -0,0 +1,380 @@
+#include "sim_prof.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define REG_FP 5 // frame pointer of the compiled code, restored by the return
+#define ROOT_PATH 0
+#define ROOT_NAME "(program)"
+
+/* a node of the call tree: the methods called from main down to it */
+typedef struct {
+  int method;                // -1 for the code outside methods
+  size_t parent;
+  size_t child;              // first method called from it, 0 for none
+  size_t sibling;            // next method called from the parent, 0 for none
+  unsigned long long calls;
+  unsigned long long cycles; // spent in the method itself
+} CallPath;
+
+typedef struct {
+  size_t caller;    // call path to return to
+  unsigned int ret; // return address of the call
+  MixWord fp;       // FP of the caller
+} CallFrame;
+
+struct SimProfile {
+  const MixProgram *prog;
+
+  unsigned long long count[MIX_MEMORY_SIZE];
+  unsigned long long cycles[MIX_MEMORY_SIZE];
+  unsigned long long now; // cycles so far
+
+  CallPath *paths;
+  size_t n_paths, paths_cap;
+  size_t current; // call path being executed
+
+  CallFrame *frames;
+  size_t depth, frames_cap;
+  int truncated; // a call could not be recorded
+
+  // inclusive time counts a recursive method once, from its outermost call
+  unsigned int active[SIM_METHODS_MAX];
+  unsigned long long entered[SIM_METHODS_MAX];
+  unsigned long long inclusive[SIM_METHODS_MAX];
+};
+
+SimProfile *sim_profile_new(const MixProgram *prog) {
+  SimProfile *p = calloc(1, sizeof(SimProfile));
+  if (p == NULL) return NULL;
+
+  p->prog = prog;
+  p->paths_cap = 64;
+  p->paths = calloc(p->paths_cap, sizeof(CallPath));
+  if (p->paths == NULL) {
+    free(p);
+    return NULL;
+  }
+
+  p->paths[ROOT_PATH].method = -1;
+  p->n_paths = 1;
+  p->current = ROOT_PATH;
+
+  return p;
+}
+
+void sim_profile_free(SimProfile *p) {
+  if (p == NULL) return;
+
+  free(p->paths);
+  free(p->frames);
+  free(p);
+}
+
+static long path_child(SimProfile *p, size_t parent, int method) {
+  size_t i;
+
+  for (i = p->paths[parent].child ; i != 0 ; i = p->paths[i].sibling) {
+    if (p->paths[i].method == method) return (long)i;
+  }
+
+  if (p->n_paths == p->paths_cap) {
+    CallPath *paths = realloc(p->paths, 2 * p->paths_cap * sizeof(CallPath));
+    if (paths == NULL) return -1;
+    p->paths = paths;
+    p->paths_cap *= 2;
+  }
+
+  i = p->n_paths++;
+  p->paths[i] = (CallPath){ method, parent, 0, p->paths[parent].child, 0, 0 };
+  p->paths[parent].child = i;
+
+  return (long)i;
+}
+
+static void call_enter(SimProfile *p, int method, unsigned int ret, MixWord fp) {
+  if (p->depth == p->frames_cap) {
+    size_t cap = p->frames_cap ? 2 * p->frames_cap : 64;
+    CallFrame *frames = realloc(p->frames, cap * sizeof(CallFrame));
+    if (frames == NULL) {
+      p->truncated = 1;
+      return;
+    }
+    p->frames = frames;
+    p->frames_cap = cap;
+  }
+
+  long path = path_child(p, p->current, method);
+  if (path < 0) {
+    p->truncated = 1;
+    return;
+  }
+
+  p->frames[p->depth++] = (CallFrame){ p->current, ret, fp };
+  p->current = (size_t)path;
+  p->paths[path].calls += 1;
+
+  if (p->active[method]++ == 0) p->entered[method] = p->now;
+}
+
+static void call_leave(SimProfile *p) {
+  int method = p->paths[p->current].method;
+
+  if (--p->active[method] == 0) p->inclusive[method] += p->now - p->entered[method];
+
+  p->current = p->frames[--p->depth].caller;
+}
+
+void sim_profile_step(SimProfile *p, const MixMachine *m, unsigned int next, unsigned int ticks) {
+  const MixProgram *prog = p->prog;
+
+  p->count[m->pc] += 1;
+  p->cycles[m->pc] += ticks;
+  p->paths[p->current].cycles += ticks;
+  p->now += ticks;
+
+  // calls and returns are jumps (HLT is followed by the first method)
+  if (next == m->pc + 1 || next >= MIX_MEMORY_SIZE) return;
+
+  // only calls jump to the first word of a method
+  int method = prog->method[next];
+  if (method >= 0 && prog->method_entry[method] == next) {
+    call_enter(p, method, m->pc + 1, m->rI[REG_FP]);
+    return;
+  }
+
+  // the method exit restores FP before it jumps back
+  if (p->depth > 0) {
+    const CallFrame *top = &p->frames[p->depth - 1];
+    if (next == top->ret && m->rI[REG_FP] == top->fp) call_leave(p);
+  }
+}
+
+/* lines of a text file, NULL if it cannot be read */
+static char **read_lines(const char *fname, size_t *n_lines) {
+  FILE *f = fopen(fname, "r");
+  if (f == NULL) return NULL;
+
+  size_t cap = 256, n = 0;
+  char **lines = malloc(cap * sizeof(char *));
+  char buf[512];
+
+  while (lines != NULL && fgets(buf, sizeof(buf), f)) {
+    buf[strcspn(buf, "\r\n")] = '\0';
+
+    if (n == cap) {
+      char **l = realloc(lines, 2 * cap * sizeof(char *));
+      if (l == NULL) break;
+      lines = l;
+      cap *= 2;
+    }
+
+    lines[n] = strdup(buf);
+    if (lines[n] == NULL) break;
+    n++;
+  }
+
+  fclose(f);
+  *n_lines = n;
+  return lines;
+}
+
+static void free_lines(char **lines, size_t n) {
+  if (lines == NULL) return;
+
+  for (size_t i = 0 ; i < n ; i++) free(lines[i]);
+  free(lines);
+}
+
+/* text of line (1-based) without the comment, or without indentation */
+static void print_line(FILE *out, char **lines, size_t n, int line, int code) {
+  if (lines == NULL || line < 1 || (size_t)line > n) {
+    fputc('\n', out);
+    return;
+  }
+
+  const char *text = lines[line - 1];
+  size_t len = strlen(text);
+
+  if (code) {
+    const char *comment = strstr(text, " ; ");
+    if (comment != NULL) len = (size_t)(comment - text);
+  } else {
+    while (*text == ' ' || *text == '\t') {
+      text++;
+      len--;
+    }
+  }
+
+  while (len > 0 && (text[len - 1] == ' ' || text[len - 1] == '\t')) len--;
+  fprintf(out, "%.*s\n", (int)len, text);
+}
+
+typedef struct {
+  int id;
+  unsigned long long calls, count, cycles, inclusive;
+} ProfRow;
+
+static int row_cmp(const void *a, const void *b) {
+  const ProfRow *x = a, *y = b;
+
+  if (x->inclusive != y->inclusive) return x->inclusive < y->inclusive ? 1 : -1;
+  if (x->cycles != y->cycles) return x->cycles < y->cycles ? 1 : -1;
+  return x->id - y->id;
+}
+
+static double percent(unsigned long long part, unsigned long long total) {
+  return total ? 100.0 * (double)part / (double)total : 0.0;
+}
+
+static const char *method_name(const MixProgram *prog, int method) {
+  return method >= 0 ? prog->methods[method] : ROOT_NAME;
+}
+
+static void report_methods(const SimProfile *p, FILE *out) {
+  const MixProgram *prog = p->prog;
+  ProfRow rows[SIM_METHODS_MAX + 1];
+  unsigned int n = prog->n_methods;
+
+  for (unsigned int k = 0 ; k <= n ; k++) {
+    rows[k] = (ProfRow){ (int)k - 1, 0, 0, 0, 0 };
+  }
+
+  // the code outside methods runs the whole program
+  rows[0].inclusive = p->now;
+
+  for (size_t i = 0 ; i < p->n_paths ; i++) {
+    ProfRow *r = &rows[p->paths[i].method + 1];
+    r->calls += p->paths[i].calls;
+    r->cycles += p->paths[i].cycles;
+  }
+
+  for (unsigned int k = 0 ; k < n ; k++) {
+    // methods still running when the program stopped
+    rows[k + 1].inclusive = p->inclusive[k];
+    if (p->active[k]) rows[k + 1].inclusive += p->now - p->entered[k];
+  }
+
+  qsort(rows, n + 1, sizeof(ProfRow), row_cmp);
+
+  fprintf(out, "Methods\n");
+  fprintf(out, "%10s %12s %7s %12s %7s  %s\n",
+          "calls", "inclusive", "%", "exclusive", "%", "method");
+
+  for (unsigned int k = 0 ; k <= n ; k++) {
+    const ProfRow *r = &rows[k];
+    if (r->id >= 0 && r->calls == 0) continue;
+
+    fprintf(out, "%10llu %12llu %6.2f%% %12llu %6.2f%%  %s\n",
+            r->calls, r->inclusive, percent(r->inclusive, p->now),
+            r->cycles, percent(r->cycles, p->now), method_name(prog, r->id));
+  }
+}
+
+static int report_lines(const SimProfile *p, FILE *out, char **source, size_t n_source) {
+  const MixProgram *prog = p->prog;
+  int max_line = 0;
+
+  for (unsigned int a = 0 ; a < MIX_MEMORY_SIZE ; a++) {
+    if (prog->src_line[a] > max_line) max_line = prog->src_line[a];
+  }
+
+  ProfRow *rows = calloc((size_t)max_line + 1, sizeof(ProfRow));
+  if (rows == NULL) return -1;
+
+  for (int l = 0 ; l <= max_line ; l++) rows[l].id = l;
+
+  for (unsigned int a = 0 ; a < MIX_MEMORY_SIZE ; a++) {
+    if (p->count[a] == 0 || prog->src_line[a] <= 0) continue;
+    rows[prog->src_line[a]].count += p->count[a];
+    rows[prog->src_line[a]].cycles += p->cycles[a];
+  }
+
+  qsort(rows + 1, (size_t)max_line, sizeof(ProfRow), row_cmp);
+
+  fprintf(out, "\nSource lines\n");
+  fprintf(out, "%10s %12s %12s %7s  %s\n", "line", "executed", "cycles", "%", "source");
+
+  for (int l = 1 ; l <= max_line ; l++) {
+    const ProfRow *r = &rows[l];
+    if (r->count == 0) continue;
+
+    fprintf(out, "%10d %12llu %12llu %6.2f%%  ",
+            r->id, r->count, r->cycles, percent(r->cycles, p->now));
+    print_line(out, source, n_source, r->id, 0);
+  }
+
+  free(rows);
+  return 0;
+}
+
+static void report_instructions(const SimProfile *p, FILE *out, char **mixal, size_t n_mixal) {
+  const MixProgram *prog = p->prog;
+
+  fprintf(out, "\nInstructions\n");
+  fprintf(out, "%10s %12s %12s %7s %6s  %-16s %s\n",
+          "address", "executed", "cycles", "%", "line", "method", "MIXAL");
+
+  for (unsigned int a = 0 ; a < MIX_MEMORY_SIZE ; a++) {
+    if (p->count[a] == 0) continue;
+
+    fprintf(out, "%10u %12llu %12llu %6.2f%% ", a, p->count[a], p->cycles[a],
+            percent(p->cycles[a], p->now));
+    if (prog->src_line[a] > 0) fprintf(out, "%6d", prog->src_line[a]);
+    else fprintf(out, "%6s", "-");
+    fprintf(out, "  %-16s ", method_name(prog, prog->method[a]));
+    print_line(out, mixal, n_mixal, prog->line[a], 1);
+  }
+}
+
+int sim_profile_report(const SimProfile *p, FILE *out, const char *mixal, const char *source) {
+  size_t n_mixal = 0, n_source = 0;
+  char **mixal_lines = read_lines(mixal, &n_mixal);
+  char **source_lines = NULL;
+
+  if (source != NULL) {
+    source_lines = read_lines(source, &n_source);
+    if (source_lines == NULL) {
+      fprintf(stderr, "error: cannot open file '%s'\n", source);
+      free_lines(mixal_lines, n_mixal);
+      return -1;
+    }
+  }
+
+  fprintf(out, "Profile of %s: %llu cycles\n", mixal, p->now);
+  if (p->prog->n_methods == 0) {
+    fprintf(out, "no @method:line annotations, compile with -fprofile\n");
+  }
+  if (p->truncated) {
+    fprintf(out, "out of memory, some calls are missing\n");
+  }
+  fprintf(out, "\n");
+
+  report_methods(p, out);
+  int status = report_lines(p, out, source_lines, n_source);
+  if (status == 0) report_instructions(p, out, mixal_lines, n_mixal);
+
+  free_lines(mixal_lines, n_mixal);
+  free_lines(source_lines, n_source);
+
+  return status;
+}
+
+static void print_path(const SimProfile *p, FILE *out, size_t path) {
+  if (path != ROOT_PATH) {
+    print_path(p, out, p->paths[path].parent);
+    fputc(';', out);
+  }
+  fputs(method_name(p->prog, p->paths[path].method), out);
+}
+
+int sim_profile_folded(const SimProfile *p, FILE *out) {
+  for (size_t i = 0 ; i < p->n_paths ; i++) {
+    if (p->paths[i].cycles == 0) continue;
+
+    print_path(p, out, i);
+    fprintf(out, " %llu\n", p->paths[i].cycles);
+  }
+
+  return ferror(out) ? -1 : 0;
+}
@@ -0,0 +1,435 @@
+#include "tail.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* neither can appear in an identifier of the source language */
+#define ACC_NAME ".acc"
+#define ACC_METHOD_SUFFIX ".acc"
+
+struct TailMethod {
+  char *name;
+  int accumulator;
+  enum OpKind op;
+  unsigned int tail_calls;
+};
+
+// methods converted to loops, in program order
+static struct TailMethod *converted = NULL;
+static size_t n_converted = 0;
+
+static int record_method(const char *name, int accumulator, enum OpKind op,
+                         unsigned int tail_calls) {
+  struct TailMethod *c = realloc(converted, (n_converted + 1) * sizeof(struct TailMethod));
+  if (c == NULL) return -1;
+
+  converted = c;
+  converted[n_converted] = (struct TailMethod) {
+    .name = strdup(name),
+    .accumulator = accumulator,
+    .op = op,
+    .tail_calls = tail_calls
+  };
+  if (converted[n_converted].name == NULL) return -1;
+
+  n_converted++;
+  return 0;
+}
+
+static int is_call_to(const ASTNode *n, const char *method_name) {
+  return n != NULL && n->kind == N_CALL && strcmp(n->call.fname, method_name) == 0;
+}
+
+/* number of calls to the method in an expression */
+static unsigned int calls_to(const ASTNode *n, const char *method_name) {
+  unsigned int count = 0;
+
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_BINOP:
+      return calls_to(n->binop.lhs, method_name) + calls_to(n->binop.rhs, method_name);
+
+    case N_UNARY:
+      return calls_to(n->unary.expr, method_name);
+
+    case N_CALL:
+      count = is_call_to(n, method_name);
+      for (const ASTList *l = n->call.args ; l != NULL ; l = l->list) {
+        count += calls_to(l->node, method_name);
+      }
+      return count;
+
+    default:
+      return 0;
+  }
+}
+
+static unsigned int args_calls_to(const ASTNode *call, const char *method_name) {
+  unsigned int count = 0;
+
+  for (const ASTList *l = call->call.args ; l != NULL ; l = l->list) {
+    count += calls_to(l->node, method_name);
+  }
+
+  return count;
+}
+
+int tail_is_self_call(const ASTNode *ret, const char *method_name) {
+  return ret != NULL && ret->kind == N_RETURN && is_call_to(ret->ret.expr, method_name);
+}
+
+static unsigned int _tail_count(const ASTNode *n, const char *method_name);
+
+static unsigned int _tail_count_list(const ASTList *l, const char *method_name) {
+  unsigned int count = 0;
+
+  for ( ; l != NULL ; l = l->list) {
+    count += _tail_count(l->node, method_name);
+  }
+
+  return count;
+}
+
+/* number of self tail calls in a statement */
+static unsigned int _tail_count(const ASTNode *n, const char *method_name) {
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_BODY:
+      return _tail_count_list(n->body.stmts, method_name);
+
+    case N_BLOCK:
+      return _tail_count_list(n->block.stmts, method_name);
+
+    case N_IF:
+    case N_WHILE:
+      return _tail_count(n->branch.then_branch, method_name)
+           + _tail_count(n->branch.else_branch, method_name);
+
+    case N_RETURN:
+      return tail_is_self_call(n, method_name);
+
+    default:
+      return 0;
+  }
+}
+
+int tail_has_self_call(const ASTNode *method) {
+  return _tail_count(method->method.body, method->method.name) > 0;
+}
+
+/* recursive call inside x op f(...), NULL if the return is not of that form */
+static ASTNode **accumulated_call(const ASTNode *ret, const char *method_name) {
+  ASTNode *e = ret->ret.expr;
+
+  if (e == NULL || e->kind != N_BINOP) return NULL;
+  if (e->binop.op != OP_ADDOP_ADD && e->binop.op != OP_MULOP_MUL) return NULL;
+
+  if (is_call_to(e->binop.rhs, method_name) && calls_to(e->binop.lhs, method_name) == 0) {
+    return &e->binop.rhs;
+  }
+  if (is_call_to(e->binop.lhs, method_name) && calls_to(e->binop.rhs, method_name) == 0) {
+    return &e->binop.lhs;
+  }
+
+  return NULL;
+}
+
+struct AccumulatorScan {
+  const char *method_name;
+  int op_set;
+  enum OpKind op;
+  unsigned int accumulated;
+};
+
+static int _tail_scan(const ASTNode *n, struct AccumulatorScan *s);
+
+static int _tail_scan_list(const ASTList *l, struct AccumulatorScan *s) {
+  for ( ; l != NULL ; l = l->list) {
+    if (_tail_scan(l->node, s)) return -1;
+  }
+
+  return 0;
+}
+
+/* check that every recursive call is a tail call or the operand of an
+   accumulated return, all accumulated returns using the same operator */
+static int _tail_scan(const ASTNode *n, struct AccumulatorScan *s) {
+  ASTNode **call = NULL;
+
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_BODY:
+      if (_tail_scan_list(n->body.decls, s)) return -1;
+      return _tail_scan_list(n->body.stmts, s);
+
+    case N_DECL:
+      return _tail_scan_list(n->decl.vars, s);
+
+    case N_VAR:
+      return calls_to(n->var.expr, s->method_name) ? -1 : 0;
+
+    case N_BLOCK:
+      return _tail_scan_list(n->block.stmts, s);
+
+    case N_ASSIGN:
+      return calls_to(n->assign.rhs, s->method_name) ? -1 : 0;
+
+    case N_IF:
+    case N_WHILE:
+      if (calls_to(n->branch.cond, s->method_name)) return -1;
+      if (_tail_scan(n->branch.then_branch, s)) return -1;
+      return _tail_scan(n->branch.else_branch, s);
+
+    case N_RETURN:
+      if (tail_is_self_call(n, s->method_name)) {
+        return args_calls_to(n->ret.expr, s->method_name) ? -1 : 0;
+      }
+
+      call = accumulated_call(n, s->method_name);
+      if (call == NULL) {
+        return calls_to(n->ret.expr, s->method_name) ? -1 : 0;
+      }
+
+      if (args_calls_to(*call, s->method_name)) return -1;
+      if (s->op_set && s->op != n->ret.expr->binop.op) return -1;
+
+      s->op_set = 1;
+      s->op = n->ret.expr->binop.op;
+      s->accumulated += 1;
+      return 0;
+
+    case N_BREAK:
+      return 0;
+
+    default:
+      return -1;
+  }
+}
+
+static ASTNode *new_acc(YYLTYPE loc) {
+  char *name = strdup(ACC_NAME);
+  if (name == NULL) return NULL;
+
+  return ast_new_identifier(name, loc);
+}
+
+static int append_arg(ASTNode *call, ASTNode *arg) {
+  ASTList **tail = &call->call.args;
+  while (*tail != NULL) tail = &(*tail)->list;
+
+  *tail = ast_list_prepend(NULL, arg);
+  return (*tail == NULL) ? -1 : 0;
+}
+
+/* turn a call to the method into a call to its accumulator version */
+static int redirect_call(ASTNode *call, const char *acc_method, ASTNode *acc_arg) {
+  char *fname = strdup(acc_method);
+  if (fname == NULL) return -1;
+
+  free(call->call.fname);
+  call->call.fname = fname;
+
+  return append_arg(call, acc_arg);
+}
+
+struct AccumulatorRewrite {
+  const char *method_name;
+  const char *acc_method;
+  enum OpKind op;
+};
+
+static int _tail_rewrite(ASTNode *n, const struct AccumulatorRewrite *r);
+
+static int _tail_rewrite_list(ASTList *l, const struct AccumulatorRewrite *r) {
+  for ( ; l != NULL ; l = l->list) {
+    if (_tail_rewrite(l->node, r)) return -1;
+  }
+
+  return 0;
+}
+
+/* rewrite the returns of the method body for the accumulator version:
+     return f(a)       -> return f.acc(a, acc)
+     return x op f(a)  -> return f.acc(a, acc op x)
+     return e          -> return acc op e */
+static int _tail_rewrite(ASTNode *n, const struct AccumulatorRewrite *r) {
+  ASTNode **call = NULL;
+  ASTNode *acc = NULL;
+
+  if (n == NULL) return 0;
+
+  switch (n->kind) {
+    case N_BODY:
+      return _tail_rewrite_list(n->body.stmts, r);
+
+    case N_BLOCK:
+      return _tail_rewrite_list(n->block.stmts, r);
+
+    case N_IF:
+    case N_WHILE:
+      if (_tail_rewrite(n->branch.then_branch, r)) return -1;
+      return _tail_rewrite(n->branch.else_branch, r);
+
+    case N_RETURN:
+      if ((acc = new_acc(n->loc)) == NULL) return -1;
+
+      if (tail_is_self_call(n, r->method_name)) {
+        return redirect_call(n->ret.expr, r->acc_method, acc);
+      }
+
+      call = accumulated_call(n, r->method_name);
+      if (call != NULL) {
+        ASTNode *e = n->ret.expr;
+        ASTNode *c = *call;
+        ASTNode **operand = (call == &e->binop.lhs) ? &e->binop.rhs : &e->binop.lhs;
+
+        ASTNode *step = ast_new_binop(r->op, acc, *operand, e->loc);
+        if (step == NULL) return -1;
+
+        // the binop now only holds what was moved out of it
+        *call = NULL;
+        *operand = NULL;
+        ast_free(e);
+
+        n->ret.expr = c;
+        return redirect_call(c, r->acc_method, step);
+      }
+
+      // the identity of the operator leaves the accumulator unchanged
+      ASTNode *e = n->ret.expr;
+      int identity = (r->op == OP_MULOP_MUL) ? 1 : 0;
+
+      if (e == NULL) {
+        ast_free(acc);
+      } else if (e->kind == N_NUMBER && e->number.val == identity) {
+        ast_free(e);
+        n->ret.expr = acc;
+      } else {
+        n->ret.expr = ast_new_binop(r->op, acc, e, n->loc);
+        if (n->ret.expr == NULL) return -1;
+      }
+
+      return 0;
+
+    default:
+      return 0;
+  }
+}
+
+/* split method f into f, which calls f.acc with the identity of the
+   operator, and f.acc, which carries the accumulator as a last parameter.
+   f.acc is defined first so that f can refer to it */
+static int accumulate_method(ASTList *cell, enum OpKind op) {
+  ASTNode *m = cell->node;
+  YYLTYPE loc = m->loc;
+
+  size_t len = strlen(m->method.name) + strlen(ACC_METHOD_SUFFIX) + 1;
+  char *acc_method = malloc(len);
+  if (acc_method == NULL) return -1;
+  snprintf(acc_method, len, "%s%s", m->method.name, ACC_METHOD_SUFFIX);
+
+  struct AccumulatorRewrite r = {
+    .method_name = m->method.name,
+    .acc_method = acc_method,
+    .op = op,
+  };
+
+  if (_tail_rewrite(m->method.body, &r)) return -1;
+
+  // f.acc takes over the parameters and the body of f
+  char *acc_param = strdup(ACC_NAME);
+  if (acc_param == NULL) return -1;
+
+  ASTList *params = m->method.params;
+  ASTList *params_copy = NULL;
+  ASTList *args = NULL;
+
+  for (const ASTList *l = params ; l != NULL ; l = l->list) {
+    char *param_name = strdup(l->node->param.name);
+    char *arg_name = strdup(l->node->param.name);
+    if (param_name == NULL || arg_name == NULL) return -1;
+
+    params_copy = ast_list_prepend(params_copy,
+                                   ast_new_param(l->node->param.type, param_name, l->node->loc));
+    args = ast_list_prepend(args, ast_new_identifier(arg_name, loc));
+  }
+
+  args = ast_list_prepend(args, ast_new_number((op == OP_MULOP_MUL) ? 1 : 0, loc));
+
+  ASTNode *acc_param_node = ast_new_param(TYPE_INT, acc_param, loc);
+  ASTList **tail = &params;
+  while (*tail != NULL) tail = &(*tail)->list;
+  *tail = ast_list_prepend(NULL, acc_param_node);
+
+  ASTNode *acc = ast_new_method(m->method.type, acc_method, params, m->method.body, loc);
+
+  // f only starts the accumulation
+  char *call_name = strdup(acc_method);
+  if (call_name == NULL) return -1;
+
+  ASTNode *call = ast_new_call(call_name, ast_list_reverse(args), loc);
+  ASTNode *ret = ast_new_return(call, loc);
+
+  m->method.params = ast_list_reverse(params_copy);
+  m->method.body = ast_new_body(NULL, ast_list_prepend(NULL, ret), loc);
+
+  cell->list = ast_list_prepend(cell->list, m);
+  cell->node = acc;
+
+  return 0;
+}
+
+int tail_ast(ASTNode *root) {
+  if (root == NULL || root->kind != N_PROGRAM) return -1;
+
+  for (ASTList *l = root->prog.methods ; l != NULL ; l = l->list) {
+    ASTNode *m = l->node;
+
+    struct AccumulatorScan s = {
+      .method_name = m->method.name,
+      .op_set = 0,
+      .accumulated = 0,
+    };
+
+    if (_tail_scan(m->method.body, &s) == 0 && s.accumulated > 0) {
+      if (accumulate_method(l, s.op)) return -1;
+
+      // l now holds f.acc, followed by f
+      if (record_method(m->method.name, 1, s.op, _tail_count(l->node->method.body,
+                                                             l->node->method.name))) return -1;
+      l = l->list;
+      continue;
+    }
+
+    unsigned int tail_calls = _tail_count(m->method.body, m->method.name);
+    if (tail_calls > 0) {
+      if (record_method(m->method.name, 0, OP_ADDOP_ADD, tail_calls)) return -1;
+    }
+  }
+
+  return 0;
+}
+
+void tail_print_report(FILE *f) {
+  fprintf(f, "%-20s %s\n", "method", "converted to a loop");
+  for (size_t k = 0 ; k < n_converted ; k++) {
+    if (converted[k].accumulator) {
+      fprintf(f, "%-20s %u tail call(s), accumulator (%s) in %s%s\n",
+              converted[k].name, converted[k].tail_calls, op_kind_str[converted[k].op],
+              converted[k].name, ACC_METHOD_SUFFIX);
+    } else {
+      fprintf(f, "%-20s %u tail call(s)\n", converted[k].name, converted[k].tail_calls);
+    }
+  }
+}
+
+void tail_free(void) {
+  for (size_t k = 0 ; k < n_converted ; k++) free(converted[k].name);
+  free(converted);
+  converted = NULL;
+  n_converted = 0;
+}